@@ -15,11 +15,15 @@ PhysicsComponent::PhysicsComponent( float mass,
                                     forceAccumulator(0.f),
                                     torqueAccumulator(0.f),
                                     angularAcc(0.f),
-                                    angularVel(0.f)
+                                    angularVel(0.f),
+                                    isBullet(false)
 {
       assert(mass != 0.f);
       this->inverseMass = 1/mass;
-      this->invInertiaTensor = glm::inverse(inertiaTensor);
+      this->invInertiaTensorLocal = glm::inverse(inertiaTensor);
+      // world space tensor, BodyState::Store keeps it in sync with the orientation
+      glm::mat3 rotation = glm::mat3_cast(orientation);
+      this->invInertiaTensor = rotation * this->invInertiaTensorLocal * glm::transpose(rotation);
 }
 
 PhysicsComponent::~PhysicsComponent()
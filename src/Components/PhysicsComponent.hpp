@@ -45,4 +45,6 @@ class PhysicsComponent : public Component
         std::vector<std::shared_ptr<Collider>> colliders;
 
         DynamicType dynamicType;
+        // bullets are swept against the static geometry every step so they can not tunnel through it
+        bool        isBullet;
 };
\ No newline at end of file
@@ -17,7 +17,9 @@
 #include "Components/RenderingComponent.hpp"
 #include "Components/TransformComponent.hpp"
 #include "Systems/Physics/ColliderBuilder.hpp"
+#include "Systems/Rendering/DebugDrawer.hpp"
 
+#include "Log.hpp"
 #include "util.hpp"
 
 
@@ -29,47 +31,31 @@ void APIENTRY openglCallbackFunction(GLenum source,
                                            const GLchar* message,
                                            const void* userParam)
 {
-    using namespace std;
-    cout << "---------------------opengl-callback-start------------" << endl;
-    cout << "message: "<< message << endl;
-    cout << "type: ";
+    const char* typeName = "OTHER";
     switch (type) {
     case GL_DEBUG_TYPE_ERROR:
-        cout << "ERROR";
+        typeName = "ERROR";
         break;
     case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
-        cout << "DEPRECATED_BEHAVIOR";
+        typeName = "DEPRECATED_BEHAVIOR";
         break;
     case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
-        cout << "UNDEFINED_BEHAVIOR";
+        typeName = "UNDEFINED_BEHAVIOR";
         break;
     case GL_DEBUG_TYPE_PORTABILITY:
-        cout << "PORTABILITY";
+        typeName = "PORTABILITY";
         break;
     case GL_DEBUG_TYPE_PERFORMANCE:
-        cout << "PERFORMANCE";
-        break;
-    case GL_DEBUG_TYPE_OTHER:
-        cout << "OTHER";
-        break;
-    }
-    cout << endl;
- 
-    cout << "id: " << id << endl;
-    cout << "severity: ";
-    switch (severity){
-    case GL_DEBUG_SEVERITY_LOW:
-        cout << "LOW";
-        break;
-    case GL_DEBUG_SEVERITY_MEDIUM:
-        cout << "MEDIUM";
-        break;
-    case GL_DEBUG_SEVERITY_HIGH:
-        cout << "HIGH";
+        typeName = "PERFORMANCE";
         break;
     }
-    cout << endl;
-    cout << "---------------------opengl-callback-end--------------" << endl;
+
+    if (severity == GL_DEBUG_SEVERITY_HIGH)
+        LOG_ERROR(Rendering, "opengl %s id %u: %s", typeName, id, message);
+    else if (severity == GL_DEBUG_SEVERITY_MEDIUM)
+        LOG_WARNING(Rendering, "opengl %s id %u: %s", typeName, id, message);
+    else
+        LOG_DEBUG(Rendering, "opengl %s id %u: %s", typeName, id, message);
 }
 
 Game::Game(int width, int height) : width(width), 
@@ -77,6 +63,7 @@ Game::Game(int width, int height) : width(width),
                                     physicsSystem(70.f, 5.f),
                                     renderingSystem(),
                                     currentID(1),
+                                    debugKeyDown(false),
                                     messageToSystem(MessageType::MessageTypeEnd),
                                     systemToMessage(System::SystemEnd)
 {
@@ -87,6 +74,8 @@ Game::Game(int width, int height) : width(width),
                                                                 "./src/Systems/Rendering/fragment.glsl"}, 
                                     std::vector<std::string>{   "./src/Systems/Rendering/vertexShadow.glsl", 
                                                                 "./src/Systems/Rendering/fragmentShadow.glsl"});
+    this->renderingSystem.AddDebugShader("./src/Systems/Rendering/vertexDebug.glsl", "./src/Systems/Rendering/fragmentDebug.glsl");
+    this->ConnectDebugDraw();
 }
 
 void Game::Init()
@@ -148,16 +137,23 @@ void Game::InitScene(std::string filename, std::vector<std::unique_ptr<Entity>>&
     // parse geometries
     // one object - > many colliders
     std::unordered_map<std::string, std::vector<std::shared_ptr<Collider>> > objectToColliders;
+    // terrain hitboxes become heightfields instead of a convex hull
+    std::unordered_map<std::string, std::shared_ptr<Heightfield>> objectToHeightfield;
+    // <object>_hitbox_mesh geometries are kept as concave triangle meshes
+    std::unordered_map<std::string, std::shared_ptr<TriangleMesh>> objectToMesh;
     std::unordered_map<std::string, std::shared_ptr<Geometry>> geometry;
     tinyxml2::XMLElement* libraryGeometries = collada->FirstChildElement("library_geometries");
     geometry = Loader::ParseGeometry(libraryGeometries);
+    // hulls of an unchanged level are read back instead of rebuilt
+    HullCache hullCache(filename + ".hulls");
+    hullCache.Load();
     // first iteration to get hitboxes
     for (std::unordered_map<std::string, std::shared_ptr<Geometry>>::iterator it = geometry.begin(); it != geometry.end(); it++)
     {
         // Three scenarios
         // is hitbox
         // is not hitbox
-        // is terrain
+        // is terrain (regular grid hitbox, loaded as a heightfield)
         bool isHitbox = it->first.find("_hitbox") != it->first.npos;
         if (isHitbox)
         {
@@ -173,13 +169,51 @@ void Game::InitScene(std::string filename, std::vector<std::unique_ptr<Entity>>&
                 glm::vec3 point = glm::vec3(x,y,z);
                 points.push_back(point);
             }
+            if (it->first.substr(hitboxIndex) == "_hitbox_mesh")
+            {
+                std::shared_ptr<TriangleMesh> mesh = ColliderBuilder::BuildTriangleMesh(0, it->second->vertices, it->second->indices, it->second->stride);
+                if (mesh != nullptr)
+                    objectToMesh[objectName] = mesh;
+                continue;
+            }
+            if (objectName == "terrain")
+            {
+                std::shared_ptr<Heightfield> heightfield = ColliderBuilder::BuildHeightfield(0, points);
+                if (heightfield != nullptr)
+                {
+                    objectToHeightfield[objectName] = heightfield;
+                    continue;
+                }
+            }
             DynamicType type = DynamicType::Static;
             if (objectName == "player")
                 type = DynamicType::Dynamic;
-            std::shared_ptr<Collider> collider = ColliderBuilder::Build(0, type, points);
+            std::shared_ptr<Collider> collider = ColliderBuilder::Build(0, type, points, hullCache);
+            // collision layers come from the object name, decorative props only collide with the player
+            if (objectName == "player")
+                collider->layer = CollisionLayer::Player;
+            else if (objectName.find("_prop") != objectName.npos)
+            {
+                collider->layer = CollisionLayer::Prop;
+                collider->mask = CollisionLayer::Player;
+            }
+            // gameplay volumes, they only send overlap messages
+            if (objectName.find("_trigger") != objectName.npos)
+                collider->isSensor = true;
             objectToColliders[objectName].push_back(collider);
         }
     }
+    hullCache.Save();
+    // objects made of several hulls enter the grid as a single compound
+    for (std::unordered_map<std::string, std::vector<std::shared_ptr<Collider>>>::iterator it = objectToColliders.begin(); it != objectToColliders.end(); it++)
+    {
+        if (it->second.size() < 2)
+            continue;
+        std::shared_ptr<Collider> compound = ColliderBuilder::BuildCompound(0, it->second[0]->dynamicType, it->second);
+        compound->layer = it->second[0]->layer;
+        compound->mask = it->second[0]->mask;
+        it->second = std::vector<std::shared_ptr<Collider>>{compound};
+    }
     std::vector<float> bufferData;
     glm::mat4 worldTransform;
     // second iteration to create game entities
@@ -213,15 +247,46 @@ void Game::InitScene(std::string filename, std::vector<std::unique_ptr<Entity>>&
             type = DynamicType::Dynamic;
         else
             mass = 1000.f;
-        printVector(translation, "INIT TRANSLATION");
-        std::unique_ptr<PhysicsComponent> physicsComponent = std::make_unique<PhysicsComponent>(1.f, translation, rotation, glm::mat3(1.f), type);
+        LOG_DEBUG(Scene, "%s at %f %f %f", it->first.c_str(), translation.x, translation.y, translation.z);
+        // inertia of the hitbox volumes scaled to the body mass, the colliders are still in world axes here.
+        // The body turns about translation, the object origin, so the tensor is moved there from the center of mass.
+        glm::mat3 inertiaTensor(1.f);
+        std::vector<std::shared_ptr<Collider>>& colliders = objectToColliders[it->first];
+        if (type != DynamicType::Static && !colliders.empty())
+        {
+            MassProperties massProperties = ColliderBuilder::ComputeMassProperties(colliders);
+            if (massProperties.mass > 0.f)
+            {
+                glm::mat3 aboutOrigin = ColliderBuilder::ShiftInertia(massProperties.inertiaTensor, massProperties.mass, translation - massProperties.centerOfMass);
+                glm::mat3 bodyRotation = glm::mat3_cast(rotation);
+                inertiaTensor = glm::transpose(bodyRotation) * aboutOrigin * bodyRotation * (mass / massProperties.mass);
+            }
+        }
+        std::unique_ptr<PhysicsComponent> physicsComponent = std::make_unique<PhysicsComponent>(mass, translation, rotation, inertiaTensor, type);
+        if (type == DynamicType::Static)
+        {
+            physicsComponent->inverseMass = 0.f;
+            physicsComponent->invInertiaTensor = glm::mat3(0.f);
+            physicsComponent->invInertiaTensorLocal = glm::mat3(0.f);
+        }
         // assign colliders to component and insert into grid
-        physicsComponent->colliders = objectToColliders[it->first];
+        physicsComponent->colliders = colliders;
         for (int k = 0;k < physicsComponent->colliders.size(); k++)
         {
             physicsComponent->colliders[k]->entityID = entity->id;
+            physicsComponent->colliders[k]->Attach(translation, rotation);
         }
         this->physicsSystem.Insert(physicsComponent->colliders);
+        if (objectToHeightfield.find(it->first) != objectToHeightfield.end())
+        {
+            objectToHeightfield[it->first]->GetCollider()->entityID = entity->id;
+            this->physicsSystem.Insert(objectToHeightfield[it->first]);
+        }
+        if (objectToMesh.find(it->first) != objectToMesh.end())
+        {
+            objectToMesh[it->first]->GetCollider()->entityID = entity->id;
+            this->physicsSystem.Insert(objectToMesh[it->first]);
+        }
         std::unique_ptr<TransformComponent> transformComponent = std::make_unique<TransformComponent>(translation, rotation);
         
         // Entity
@@ -239,17 +304,38 @@ void Game::InitScene(std::string filename, std::vector<std::unique_ptr<Entity>>&
     // Push back an entity
 }
 
+void Game::ConnectDebugDraw()
+{
+    // the physics only builds its debug lines while the drawer is on
+    PhysicsDebugDraw debugDraw;
+    if (DebugDrawer::IsEnabled())
+    {
+        debugDraw.line = [](glm::vec3 from, glm::vec3 to, glm::vec3 color) { DebugDrawer::Line(from, to, color); };
+        debugDraw.point = [](glm::vec3 point, glm::vec3 color) { DebugDrawer::Point(point, color); };
+    }
+    this->physicsSystem.SetDebugDraw(debugDraw);
+}
     
 void Game::Update(float deltaTime)
 {
     // FIXME : this should not be here
     if (glfwGetKey(this->window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(this->window, true);
+    // F1 toggles the debug lines
+    bool debugKeyDown = glfwGetKey(this->window, GLFW_KEY_F1) == GLFW_PRESS;
+    if (debugKeyDown && !this->debugKeyDown)
+    {
+        DebugDrawer::SetEnabled(!DebugDrawer::IsEnabled());
+        this->ConnectDebugDraw();
+    }
+    this->debugKeyDown = debugKeyDown;
     // dispatch here
     this->Dispatch();
     // System Update
     this->inputSystem.Update(this->window, this->entities, this->systemToMessage[System::InputSys], this->globalQueue);
     this->physicsSystem.Update(deltaTime, this->entities, this->systemToMessage[System::PhysicsSys], this->globalQueue);
+    if (this->recorder.IsOpen())
+        this->recorder.WriteTick(deltaTime, this->systemToMessage[System::PhysicsSys], this->entities);
     this->animationSystem.Update(deltaTime, this->entities, this->systemToMessage[System::AnimationSys], this->globalQueue);
     this->renderingSystem.Update(this->entities, this->playerID, this->systemToMessage[System::RenderingSys], this->globalQueue);
 }
@@ -264,12 +350,21 @@ void Game::Run()
         glfwSwapBuffers(window);
         unsigned int error = glGetError();
         if (error != 0)
-            std::cout << error << std::endl;
+            LOG_ERROR(Rendering, "GL error %u", error);
     }
 
+    this->recorder.Close();
     glfwTerminate();
 }
 
+void Game::StartRecording(std::string filename)
+{
+    if (this->recorder.Open(filename, this->entities, this->physicsSystem))
+        LOG_INFO(General, "recording physics to %s", filename.c_str());
+    else
+        LOG_ERROR(General, "cannot record physics to %s", filename.c_str());
+}
+
 int Game::CreateEntityID()
 {
     return this->currentID++;
@@ -6,6 +6,7 @@
 
 #include "Systems/Messaging/Message.hpp"
 #include "Systems/Physics/PhysicsSystem.hpp"
+#include "Systems/Physics/PhysicsRecording.hpp"
 #include "Systems/Animation/AnimationSystem.hpp"
 #include "Systems/Input/InputSystem.hpp"
 #include "Systems/Rendering/RenderingSystem.hpp"
@@ -39,6 +40,16 @@ class Game
         void Run();
         void Update(float deltaTime);
 
+        /**
+        Records the physics scene and every physics tick to filename, has to be called before Run.
+        */
+        void StartRecording(std::string filename);
+
+        /**
+        Points the physics debug draw callbacks at the DebugDrawer while it is enabled, clears them otherwise.
+        */
+        void ConnectDebugDraw();
+
         int CreateEntityID();
         void Subscribe(MessageType message, System system);
         void Unsubscribe(MessageType message, System system);
@@ -58,6 +69,9 @@ class Game
         // Player
         int                         playerID;
 
+        // debug draw toggle key state of the last frame
+        bool                        debugKeyDown;
+
         // messaging
         std::vector<Message>                globalQueue;
         std::vector<std::vector<System>>    messageToSystem;
@@ -68,4 +82,6 @@ class Game
         PhysicsSystem               physicsSystem;
         AnimationSystem             animationSystem;
         RenderingSystem             renderingSystem;
+
+        PhysicsRecorder             recorder;
 };
\ No newline at end of file
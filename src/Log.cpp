@@ -0,0 +1,162 @@
+#include "Log.hpp"
+
+#include <chrono>
+#include <cstdarg>
+#include <functional>
+
+const int Log::capacity;
+
+static std::uint64_t Now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Log::Log() : writePosition(0), readPosition(0), dropped(0), level(LOG_LEVEL), running(false), draining(false), output(stdout)
+{
+    for (int i = 0; i < capacity; i++)
+    {
+        this->slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    this->startTime = Now();
+}
+
+Log& Log::Get()
+{
+    static Log log;
+    return log;
+}
+
+void Log::Write(LogLevel level, LogCategory::Type category, const char* format, ...)
+{
+    Log& log = Log::Get();
+    if (level < log.level.load(std::memory_order_relaxed))
+        return;
+
+    // claim a slot, the sequence of a free slot equals the write position that owns it
+    std::uint64_t position = log.writePosition.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true)
+    {
+        slot = &log.slots[position & (capacity - 1)];
+        std::uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        std::int64_t difference = (std::int64_t)sequence - (std::int64_t)position;
+        if (difference == 0)
+        {
+            if (log.writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+        {
+            // full, never block the caller
+            log.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            position = log.writePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    LogRecord& record = slot->record;
+    record.time = Now() - log.startTime;
+    record.thread = (std::uint32_t)std::hash<std::thread::id>()(std::this_thread::get_id());
+    record.level = level;
+    record.category = category;
+    va_list arguments;
+    va_start(arguments, format);
+    std::vsnprintf(record.message, sizeof(record.message), format, arguments);
+    va_end(arguments);
+    slot->sequence.store(position + 1, std::memory_order_release);
+}
+
+bool Log::Pop(LogRecord& record)
+{
+    Slot& slot = this->slots[this->readPosition & (capacity - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != this->readPosition + 1)
+        return false;
+    record = slot.record;
+    slot.sequence.store(this->readPosition + capacity, std::memory_order_release);
+    this->readPosition++;
+    return true;
+}
+
+int Log::Flush()
+{
+    Log& log = Log::Get();
+    // only one consumer at a time, the worker or a caller of Flush
+    bool expected = false;
+    while (!log.draining.compare_exchange_weak(expected, true, std::memory_order_acquire))
+    {
+        expected = false;
+        std::this_thread::yield();
+    }
+
+    int count = 0;
+    LogRecord record;
+    while (log.Pop(record))
+    {
+        std::fprintf(log.output, "%10.6f %-7s %-9s [%08x] %s\n",
+                     record.time / 1000000.0,
+                     Log::GetLevelName(record.level),
+                     Log::GetCategoryName(record.category),
+                     record.thread,
+                     record.message);
+        count++;
+    }
+    if (count > 0)
+        std::fflush(log.output);
+
+    log.draining.store(false, std::memory_order_release);
+    return count;
+}
+
+void Log::Run()
+{
+    while (this->running.load(std::memory_order_acquire))
+    {
+        if (Log::Flush() == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    Log::Flush();
+}
+
+void Log::Start(std::FILE* output)
+{
+    Log& log = Log::Get();
+    if (log.running.exchange(true))
+        return;
+    log.output = output;
+    log.worker = std::thread(&Log::Run, &log);
+}
+
+void Log::Stop()
+{
+    Log& log = Log::Get();
+    if (!log.running.exchange(false))
+        return;
+    log.worker.join();
+    // the caller owns the output, it may be closed after Stop
+    log.output = stdout;
+}
+
+void Log::SetLevel(LogLevel level)
+{
+    Log::Get().level.store(level, std::memory_order_relaxed);
+}
+
+std::uint64_t Log::GetDropped()
+{
+    return Log::Get().dropped.load(std::memory_order_relaxed);
+}
+
+const char* Log::GetLevelName(LogLevel level)
+{
+    static const char* names[] = {"TRACE", "DEBUG", "INFO", "WARNING", "ERROR"};
+    return names[level];
+}
+
+const char* Log::GetCategoryName(LogCategory::Type category)
+{
+    static const char* names[] = {"general", "physics", "rendering", "animation", "input", "scene"};
+    return names[category];
+}
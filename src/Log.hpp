@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <cstdio>
+#include <cstdint>
+
+/*
+Logging - records are formatted by the caller into a slot of a lock-free ring buffer and written out by a
+background thread, so a log call never flushes or takes a lock. If the ring is full the record is dropped
+and counted.
+
+Filtering happens at compile time first:
+    LOG_LEVEL       lowest level compiled in (0 trace ... 4 error), debug by default, warning with NDEBUG
+    LOG_CATEGORIES  bitmask of the categories compiled in, all by default
+Calls below the level or in a masked out category compile to nothing, their arguments are not evaluated.
+
+    LOG_DEBUG(Physics, "velocity %f %f %f", v.x, v.y, v.z);
+*/
+
+#ifndef LOG_LEVEL
+#ifdef NDEBUG
+#define LOG_LEVEL 3
+#else
+#define LOG_LEVEL 1
+#endif
+#endif
+
+#ifndef LOG_CATEGORIES
+#define LOG_CATEGORIES 0xffffffffu
+#endif
+
+enum LogLevel
+{
+    LogTrace,
+    LogDebug,
+    LogInfo,
+    LogWarning,
+    LogError
+};
+
+namespace LogCategory
+{
+    enum Type
+    {
+        General,
+        Physics,
+        Rendering,
+        Animation,
+        Input,
+        Scene,
+        Count
+    };
+}
+
+/**
+LogEnabled - compile time filter, a constant the compiler removes the log call with.
+*/
+template <int level, int category>
+struct LogEnabled
+{
+    static const bool value = level >= LOG_LEVEL && ((LOG_CATEGORIES >> category) & 1u);
+};
+
+#define LOG(level, category, ...) \
+    do { if (LogEnabled<level, LogCategory::category>::value) Log::Write(level, LogCategory::category, __VA_ARGS__); } while (0)
+
+#define LOG_TRACE(category, ...)   LOG(LogTrace, category, __VA_ARGS__)
+#define LOG_DEBUG(category, ...)   LOG(LogDebug, category, __VA_ARGS__)
+#define LOG_INFO(category, ...)    LOG(LogInfo, category, __VA_ARGS__)
+#define LOG_WARNING(category, ...) LOG(LogWarning, category, __VA_ARGS__)
+#define LOG_ERROR(category, ...)   LOG(LogError, category, __VA_ARGS__)
+
+/**
+LogRecord - one log line. Time is in microseconds since the log was created.
+*/
+struct LogRecord
+{
+    std::uint64_t       time;
+    std::uint32_t       thread;
+    LogLevel            level;
+    LogCategory::Type   category;
+    char                message[200];
+};
+
+class Log
+{
+    public:
+        /**
+        Write formats the message printf style into the ring buffer. Safe to call from any thread.
+        */
+        static void Write(LogLevel level, LogCategory::Type category, const char* format, ...)
+#ifdef __GNUC__
+            __attribute__((format(printf, 3, 4)))
+#endif
+            ;
+
+        /**
+        Start runs the background thread writing the records to output. Records written before
+        Start wait in the ring buffer. Stop drains what is left and joins the thread.
+        */
+        static void Start(std::FILE* output = stdout);
+        static void Stop();
+
+        /**
+        Runtime level threshold on top of LOG_LEVEL.
+        */
+        static void SetLevel(LogLevel level);
+
+        /**
+        Flush writes the pending records from the calling thread, returns how many were written.
+        */
+        static int Flush();
+
+        /** records dropped because the ring was full */
+        static std::uint64_t GetDropped();
+
+        static const char* GetLevelName(LogLevel level);
+        static const char* GetCategoryName(LogCategory::Type category);
+
+        static const int capacity = 1024;
+
+    private:
+        struct Slot
+        {
+            std::atomic<std::uint64_t>  sequence;
+            LogRecord                   record;
+        };
+
+        Log();
+        static Log& Get();
+
+        /**
+        Pop takes the oldest record out of the ring, single consumer. Returns false if it is empty.
+        */
+        bool Pop(LogRecord& record);
+        void Run();
+
+        Slot                        slots[capacity];
+        std::atomic<std::uint64_t>  writePosition;
+        std::uint64_t               readPosition;
+        std::atomic<std::uint64_t>  dropped;
+        std::atomic<int>            level;
+        std::atomic<bool>           running;
+        std::atomic<bool>           draining;
+        std::FILE*                  output;
+        std::thread                 worker;
+        std::uint64_t               startTime;
+};
@@ -2,6 +2,8 @@
 #include "../../Entity.hpp"
 #include "../../Components/Animation/AnimationComponent.hpp"
 #include "../../Components/InputComponent.hpp"
+#include "../../Components/TransformComponent.hpp"
+#include "../Rendering/DebugDrawer.hpp"
 
 AnimationSystem::AnimationSystem()
 {
@@ -42,6 +44,24 @@ void AnimationSystem::Update(float deltaTime, std::vector<std::unique_ptr<Entity
                 Bone& parent = component->GetBone(bone.parentIndex);
                 bone.animationTransform = parent.animationTransform * bone.localAnimationTransform;
             }
+            if (DebugDrawer::IsEnabled() && entities[i]->HasComponent(ComponentType::Transform))
+            {
+                TransformComponent* transform = entities[i]->GetComponent<TransformComponent>(ComponentType::Transform);
+                this->DebugDrawSkeleton(component, transform->GetWorldTransform());
+            }
         }
     }
+}
+
+void AnimationSystem::DebugDrawSkeleton(AnimationComponent* component, const glm::mat4& worldTransform)
+{
+    // a line from every joint to its parent joint
+    for (int j = 1; j < component->bones.size(); j++)
+    {
+        Bone& bone = component->GetBone(j);
+        Bone& parent = component->GetBone(bone.parentIndex);
+        glm::vec3 joint = glm::vec3(worldTransform * bone.animationTransform[3]);
+        glm::vec3 parentJoint = glm::vec3(worldTransform * parent.animationTransform[3]);
+        DebugDrawer::Line(parentJoint, joint, glm::vec3(1.f, 1.f, 0.f));
+    }
 }
\ No newline at end of file
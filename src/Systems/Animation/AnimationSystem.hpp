@@ -2,10 +2,12 @@
 
 #include <vector>
 #include <memory>
+#include <glm/glm.hpp>
 #include "../../Components/Component.hpp"
 #include "../Messaging/Message.hpp"
 
 class Entity;
+class AnimationComponent;
 class AnimationSystem
 {
     public:
@@ -17,6 +19,11 @@ class AnimationSystem
         			std::vector<Message>& events,
         			std::vector<Message>& globalQueue);
 
+        /**
+        Adds the bones of the current pose to the DebugDrawer.
+        */
+        void DebugDrawSkeleton(AnimationComponent* component, const glm::mat4& worldTransform);
+
     private:
         std::uint32_t primaryBitset;
 };
\ No newline at end of file
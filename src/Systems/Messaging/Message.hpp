@@ -8,6 +8,8 @@ enum MessageType
 {
 	Move = 0,
 	MouseMove,
+	OverlapBegin,
+	OverlapEnd,
 	MessageTypeEnd
 };
 
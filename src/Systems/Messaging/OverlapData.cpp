@@ -0,0 +1,9 @@
+#include "OverlapData.hpp"
+
+OverlapData::OverlapData(int sensorID, int otherID) : 
+					Data(),
+					sensorID(sensorID), 
+					otherID(otherID)
+{
+	
+}
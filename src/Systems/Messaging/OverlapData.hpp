@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Data.hpp"
+
+/**
+OverlapData - payload of the OverlapBegin / OverlapEnd messages sent for sensor colliders.
+*/
+class OverlapData : public Data
+{
+	public:
+
+		OverlapData(int sensorID, int otherID);
+
+		// entity owning the sensor and the entity that entered / left it
+		int sensorID;
+		int otherID;
+};
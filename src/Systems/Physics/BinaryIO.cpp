@@ -0,0 +1,76 @@
+#include "BinaryIO.hpp"
+
+void BinaryIO::WriteHull(std::vector<char>& buffer, const Hull& hull)
+{
+    Write(buffer, (std::uint32_t)hull.points.size());
+    for (int k = 0; k < hull.points.size(); k++)
+        Write(buffer, hull.points[k]);
+
+    Write(buffer, (std::uint32_t)hull.faces.size());
+    for (int k = 0; k < hull.faces.size(); k++)
+    {
+        Write(buffer, hull.faces[k].normal);
+        Write(buffer, (std::uint32_t)hull.faces[k].points.size());
+        for (int p = 0; p < hull.faces[k].points.size(); p++)
+            Write(buffer, (std::int32_t)hull.faces[k].points[p]);
+    }
+
+    Write(buffer, (std::uint32_t)hull.edges.size());
+    for (int k = 0; k < hull.edges.size(); k++)
+    {
+        std::pair<int, int> edgeFaces = k < hull.edgeFaces.size() ? hull.edgeFaces[k] : std::make_pair(-1, -1);
+        Write(buffer, (std::int32_t)hull.edges[k].first);
+        Write(buffer, (std::int32_t)hull.edges[k].second);
+        Write(buffer, (std::int32_t)edgeFaces.first);
+        Write(buffer, (std::int32_t)edgeFaces.second);
+    }
+
+    Write(buffer, hull.radius);
+    Write(buffer, hull.aabbCenter);
+    Write(buffer, hull.aabbHalfExtents);
+
+    Write(buffer, (std::uint32_t)hull.isBox);
+    Write(buffer, hull.boxCenter);
+    Write(buffer, hull.boxHalfExtents);
+    for (int k = 0; k < 3; k++)
+        Write(buffer, hull.boxAxes[k]);
+}
+
+std::shared_ptr<Hull> BinaryIO::ReadHull(Reader& reader)
+{
+    std::shared_ptr<Hull> hull = std::make_shared<Hull>();
+
+    hull->points.resize(reader.ReadCount(sizeof(glm::vec3)));
+    for (int k = 0; k < hull->points.size(); k++)
+        hull->points[k] = reader.Read<glm::vec3>();
+
+    hull->faces.resize(reader.ReadCount(sizeof(glm::vec3) + sizeof(std::uint32_t)));
+    for (int k = 0; k < hull->faces.size(); k++)
+    {
+        hull->faces[k].normal = reader.Read<glm::vec3>();
+        hull->faces[k].points.resize(reader.ReadCount(sizeof(std::int32_t)));
+        for (int p = 0; p < hull->faces[k].points.size(); p++)
+            hull->faces[k].points[p] = reader.Read<std::int32_t>();
+    }
+
+    hull->edges.resize(reader.ReadCount(4 * sizeof(std::int32_t)));
+    hull->edgeFaces.resize(hull->edges.size());
+    for (int k = 0; k < hull->edges.size(); k++)
+    {
+        hull->edges[k].first = reader.Read<std::int32_t>();
+        hull->edges[k].second = reader.Read<std::int32_t>();
+        hull->edgeFaces[k].first = reader.Read<std::int32_t>();
+        hull->edgeFaces[k].second = reader.Read<std::int32_t>();
+    }
+
+    hull->radius = reader.Read<float>();
+    hull->aabbCenter = reader.Read<glm::vec3>();
+    hull->aabbHalfExtents = reader.Read<glm::vec3>();
+
+    hull->isBox = reader.Read<std::uint32_t>() != 0;
+    hull->boxCenter = reader.Read<glm::vec3>();
+    hull->boxHalfExtents = reader.Read<glm::vec3>();
+    for (int k = 0; k < 3; k++)
+        hull->boxAxes[k] = reader.Read<glm::vec3>();
+    return hull;
+}
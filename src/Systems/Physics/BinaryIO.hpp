@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "Collider.hpp"
+
+/**
+Helpers shared by the binary physics files (hull cache, recordings). Values are written in the native
+byte order, the files are not meant to move between machines with a different one.
+*/
+namespace BinaryIO
+{
+    inline std::uint64_t Fnv1a(const char* data, std::size_t size, std::uint64_t hash = 14695981039346656037ull)
+    {
+        for (std::size_t i = 0; i < size; i++)
+        {
+            hash ^= (unsigned char)data[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    void Write(std::vector<char>& buffer, const T& value)
+    {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    /**
+    Bounds checked reader over a loaded file, any read past the end marks the whole payload as invalid.
+    */
+    class Reader
+    {
+        public:
+            Reader(const char* data, std::size_t size) : data(data), size(size), offset(0), isValid(true) {}
+
+            template <typename T>
+            T Read()
+            {
+                T value;
+                if (this->offset + sizeof(T) > this->size)
+                {
+                    this->isValid = false;
+                    std::memset(&value, 0, sizeof(T));
+                    return value;
+                }
+                std::memcpy(&value, this->data + this->offset, sizeof(T));
+                this->offset += sizeof(T);
+                return value;
+            }
+
+            // element counts are checked against the remaining bytes so a bad count cannot allocate gigabytes
+            std::uint32_t ReadCount(std::size_t elementSize)
+            {
+                std::uint32_t count = this->Read<std::uint32_t>();
+                if (count * elementSize > this->size - this->offset)
+                {
+                    this->isValid = false;
+                    return 0;
+                }
+                return count;
+            }
+
+            bool AtEnd()
+            {
+                return this->offset == this->size;
+            }
+
+            const char*     data;
+            std::size_t     size;
+            std::size_t     offset;
+            bool            isValid;
+    };
+
+    void WriteHull(std::vector<char>& buffer, const Hull& hull);
+    std::shared_ptr<Hull> ReadHull(Reader& reader);
+}
@@ -0,0 +1,269 @@
+#include "BodyState.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define BODYSTATE_SSE
+#endif
+
+BodyState::BodyState() : count(0), paddedCount(0)
+{
+
+}
+
+void BodyState::Resize(int count)
+{
+    this->count = count;
+    this->paddedCount = (count + 3) & ~3;
+    for (int i = 0; i < FieldCount; i++)
+    {
+        this->fields[i].resize(this->paddedCount);
+        std::fill(this->fields[i].begin() + count, this->fields[i].end(), 0.f);
+    }
+}
+
+int BodyState::Size()
+{
+    return this->count;
+}
+
+float* BodyState::Get(Field field)
+{
+    return this->fields[field].data();
+}
+
+void BodyState::Load(int index, const PhysicsComponent& component)
+{
+    for (int k = 0; k < 3; k++)
+    {
+        this->fields[PositionX + k][index] = component.position[k];
+        this->fields[VelocityX + k][index] = component.velocity[k];
+        this->fields[AccelerationX + k][index] = component.acceleration[k];
+        this->fields[ForceX + k][index] = component.forceAccumulator[k];
+        this->fields[AngularVelX + k][index] = component.angularVel[k];
+        this->fields[AngularAccX + k][index] = component.angularAcc[k];
+        this->fields[TorqueX + k][index] = component.torqueAccumulator[k];
+        for (int j = 0; j < 3; j++)
+        {
+            this->fields[InvInertia00 + 3 * k + j][index] = component.invInertiaTensor[k][j];
+            this->fields[InvInertiaLocal00 + 3 * k + j][index] = component.invInertiaTensorLocal[k][j];
+        }
+    }
+    this->fields[InverseMass][index] = component.inverseMass;
+    this->fields[OrientationX][index] = component.orientation.x;
+    this->fields[OrientationY][index] = component.orientation.y;
+    this->fields[OrientationZ][index] = component.orientation.z;
+    this->fields[OrientationW][index] = component.orientation.w;
+}
+
+void BodyState::LoadInputs(int index, const PhysicsComponent& component)
+{
+    for (int k = 0; k < 3; k++)
+    {
+        this->fields[PositionX + k][index] = component.position[k];
+        this->fields[VelocityX + k][index] = component.velocity[k];
+        this->fields[ForceX + k][index] = component.forceAccumulator[k];
+        this->fields[AngularVelX + k][index] = component.angularVel[k];
+        this->fields[TorqueX + k][index] = component.torqueAccumulator[k];
+    }
+    this->fields[OrientationX][index] = component.orientation.x;
+    this->fields[OrientationY][index] = component.orientation.y;
+    this->fields[OrientationZ][index] = component.orientation.z;
+    this->fields[OrientationW][index] = component.orientation.w;
+}
+
+void BodyState::Store(int index, PhysicsComponent& component)
+{
+    for (int k = 0; k < 3; k++)
+    {
+        component.position[k] = this->fields[PositionX + k][index];
+        component.velocity[k] = this->fields[VelocityX + k][index];
+        component.acceleration[k] = this->fields[AccelerationX + k][index];
+        component.angularVel[k] = this->fields[AngularVelX + k][index];
+        component.angularAcc[k] = this->fields[AngularAccX + k][index];
+        for (int j = 0; j < 3; j++)
+            component.invInertiaTensor[k][j] = this->fields[InvInertia00 + 3 * k + j][index];
+    }
+    component.orientation.x = this->fields[OrientationX][index];
+    component.orientation.y = this->fields[OrientationY][index];
+    component.orientation.z = this->fields[OrientationZ][index];
+    component.orientation.w = this->fields[OrientationW][index];
+    component.forceAccumulator = glm::vec3(0.f, 0.f, 0.f);
+    component.torqueAccumulator = glm::vec3(0.f, 0.f, 0.f);
+}
+
+void BodyState::IntegrateScalar(float dt, int begin, int end)
+{
+    float* f[FieldCount];
+    for (int i = 0; i < FieldCount; i++)
+        f[i] = this->fields[i].data();
+
+    float halfStep = 0.5f * dt;
+    for (int i = begin; i < end; i++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            f[AccelerationX + k][i] += f[ForceX + k][i] * f[InverseMass][i];
+            // torque * invInertiaTensor, row vector times matrix like glm
+            f[AngularAccX + k][i] += f[TorqueX][i] * f[InvInertia00 + 3 * k][i] +
+                                     f[TorqueY][i] * f[InvInertia00 + 3 * k + 1][i] +
+                                     f[TorqueZ][i] * f[InvInertia00 + 3 * k + 2][i];
+        }
+        for (int k = 0; k < 3; k++)
+        {
+            f[VelocityX + k][i] += f[AccelerationX + k][i] * dt;
+            f[AngularVelX + k][i] += f[AngularAccX + k][i] * dt;
+            f[PositionX + k][i] += f[VelocityX + k][i] * dt;
+        }
+
+        // dq/dt = 0.5 * (0, w) * q with the world angular velocity, then renormalized so the rotation does not drift
+        float wx = f[AngularVelX][i];
+        float wy = f[AngularVelY][i];
+        float wz = f[AngularVelZ][i];
+        float qx = f[OrientationX][i];
+        float qy = f[OrientationY][i];
+        float qz = f[OrientationZ][i];
+        float qw = f[OrientationW][i];
+        float x = qx + halfStep * (qw * wx + (wy * qz - wz * qy));
+        float y = qy + halfStep * (qw * wy + (wz * qx - wx * qz));
+        float z = qz + halfStep * (qw * wz + (wx * qy - wy * qx));
+        float w = qw - halfStep * (wx * qx + wy * qy + wz * qz);
+        // the padding bodies have a zero quaternion and keep it
+        float length = std::sqrt(std::max(x * x + y * y + z * z + w * w, 1e-30f));
+        x = x / length;
+        y = y / length;
+        z = z / length;
+        w = w / length;
+        f[OrientationX][i] = x;
+        f[OrientationY][i] = y;
+        f[OrientationZ][i] = z;
+        f[OrientationW][i] = w;
+
+        // world inverse inertia R * local * R^T, rotation[row][column] like glm::mat3_cast
+        float rotation[3][3] = {
+            {1.f - 2.f * (y * y + z * z), 2.f * (x * y - w * z), 2.f * (x * z + w * y)},
+            {2.f * (x * y + w * z), 1.f - 2.f * (x * x + z * z), 2.f * (y * z - w * x)},
+            {2.f * (x * z - w * y), 2.f * (y * z + w * x), 1.f - 2.f * (x * x + y * y)}};
+        float product[3][3];
+        for (int row = 0; row < 3; row++)
+        {
+            for (int column = 0; column < 3; column++)
+            {
+                // the fields are column major, local(row, column) is InvInertiaLocal[column][row]
+                product[row][column] = rotation[row][0] * f[InvInertiaLocal00 + 3 * column][i] +
+                                       rotation[row][1] * f[InvInertiaLocal00 + 3 * column + 1][i] +
+                                       rotation[row][2] * f[InvInertiaLocal00 + 3 * column + 2][i];
+            }
+        }
+        for (int row = 0; row < 3; row++)
+        {
+            for (int column = 0; column < 3; column++)
+            {
+                f[InvInertia00 + 3 * column + row][i] = product[row][0] * rotation[column][0] +
+                                                        product[row][1] * rotation[column][1] +
+                                                        product[row][2] * rotation[column][2];
+            }
+        }
+    }
+}
+
+void BodyState::Integrate(float dt)
+{
+#ifdef BODYSTATE_SSE
+    float* f[FieldCount];
+    for (int i = 0; i < FieldCount; i++)
+        f[i] = this->fields[i].data();
+
+    const __m128 step = _mm_set1_ps(dt);
+    const __m128 halfStep = _mm_set1_ps(0.5f * dt);
+    const __m128 minLength = _mm_set1_ps(1e-30f);
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 two = _mm_set1_ps(2.f);
+    for (int i = 0; i < this->paddedCount; i += 4)
+    {
+        __m128 inverseMass = _mm_loadu_ps(f[InverseMass] + i);
+        __m128 torqueX = _mm_loadu_ps(f[TorqueX] + i);
+        __m128 torqueY = _mm_loadu_ps(f[TorqueY] + i);
+        __m128 torqueZ = _mm_loadu_ps(f[TorqueZ] + i);
+        for (int k = 0; k < 3; k++)
+        {
+            __m128 acceleration = _mm_loadu_ps(f[AccelerationX + k] + i);
+            acceleration = _mm_add_ps(acceleration, _mm_mul_ps(_mm_loadu_ps(f[ForceX + k] + i), inverseMass));
+
+            __m128 angularAcc = _mm_loadu_ps(f[AngularAccX + k] + i);
+            __m128 torque = _mm_add_ps(_mm_add_ps(_mm_mul_ps(torqueX, _mm_loadu_ps(f[InvInertia00 + 3 * k] + i)),
+                                                  _mm_mul_ps(torqueY, _mm_loadu_ps(f[InvInertia00 + 3 * k + 1] + i))),
+                                                  _mm_mul_ps(torqueZ, _mm_loadu_ps(f[InvInertia00 + 3 * k + 2] + i)));
+            angularAcc = _mm_add_ps(angularAcc, torque);
+
+            __m128 velocity = _mm_add_ps(_mm_loadu_ps(f[VelocityX + k] + i), _mm_mul_ps(acceleration, step));
+            __m128 angularVel = _mm_add_ps(_mm_loadu_ps(f[AngularVelX + k] + i), _mm_mul_ps(angularAcc, step));
+            __m128 position = _mm_add_ps(_mm_loadu_ps(f[PositionX + k] + i), _mm_mul_ps(velocity, step));
+
+            _mm_storeu_ps(f[AccelerationX + k] + i, acceleration);
+            _mm_storeu_ps(f[AngularAccX + k] + i, angularAcc);
+            _mm_storeu_ps(f[VelocityX + k] + i, velocity);
+            _mm_storeu_ps(f[AngularVelX + k] + i, angularVel);
+            _mm_storeu_ps(f[PositionX + k] + i, position);
+        }
+
+        // quaternion derivative and normalization, same operation order as IntegrateScalar
+        __m128 wx = _mm_loadu_ps(f[AngularVelX] + i);
+        __m128 wy = _mm_loadu_ps(f[AngularVelY] + i);
+        __m128 wz = _mm_loadu_ps(f[AngularVelZ] + i);
+        __m128 qx = _mm_loadu_ps(f[OrientationX] + i);
+        __m128 qy = _mm_loadu_ps(f[OrientationY] + i);
+        __m128 qz = _mm_loadu_ps(f[OrientationZ] + i);
+        __m128 qw = _mm_loadu_ps(f[OrientationW] + i);
+        __m128 x = _mm_add_ps(qx, _mm_mul_ps(halfStep, _mm_add_ps(_mm_mul_ps(qw, wx), _mm_sub_ps(_mm_mul_ps(wy, qz), _mm_mul_ps(wz, qy)))));
+        __m128 y = _mm_add_ps(qy, _mm_mul_ps(halfStep, _mm_add_ps(_mm_mul_ps(qw, wy), _mm_sub_ps(_mm_mul_ps(wz, qx), _mm_mul_ps(wx, qz)))));
+        __m128 z = _mm_add_ps(qz, _mm_mul_ps(halfStep, _mm_add_ps(_mm_mul_ps(qw, wz), _mm_sub_ps(_mm_mul_ps(wx, qy), _mm_mul_ps(wy, qx)))));
+        __m128 w = _mm_sub_ps(qw, _mm_mul_ps(halfStep, _mm_add_ps(_mm_add_ps(_mm_mul_ps(wx, qx), _mm_mul_ps(wy, qy)), _mm_mul_ps(wz, qz))));
+        __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)), _mm_mul_ps(w, w));
+        __m128 length = _mm_sqrt_ps(_mm_max_ps(lengthSquared, minLength));
+        x = _mm_div_ps(x, length);
+        y = _mm_div_ps(y, length);
+        z = _mm_div_ps(z, length);
+        w = _mm_div_ps(w, length);
+        _mm_storeu_ps(f[OrientationX] + i, x);
+        _mm_storeu_ps(f[OrientationY] + i, y);
+        _mm_storeu_ps(f[OrientationZ] + i, z);
+        _mm_storeu_ps(f[OrientationW] + i, w);
+
+        // world inverse inertia, same operation order as IntegrateScalar
+        __m128 rotation[3][3];
+        rotation[0][0] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(_mm_mul_ps(y, y), _mm_mul_ps(z, z))));
+        rotation[0][1] = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(x, y), _mm_mul_ps(w, z)));
+        rotation[0][2] = _mm_mul_ps(two, _mm_add_ps(_mm_mul_ps(x, z), _mm_mul_ps(w, y)));
+        rotation[1][0] = _mm_mul_ps(two, _mm_add_ps(_mm_mul_ps(x, y), _mm_mul_ps(w, z)));
+        rotation[1][1] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(z, z))));
+        rotation[1][2] = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(y, z), _mm_mul_ps(w, x)));
+        rotation[2][0] = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(x, z), _mm_mul_ps(w, y)));
+        rotation[2][1] = _mm_mul_ps(two, _mm_add_ps(_mm_mul_ps(y, z), _mm_mul_ps(w, x)));
+        rotation[2][2] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y))));
+        __m128 product[3][3];
+        for (int row = 0; row < 3; row++)
+        {
+            for (int column = 0; column < 3; column++)
+            {
+                product[row][column] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rotation[row][0], _mm_loadu_ps(f[InvInertiaLocal00 + 3 * column] + i)),
+                                                             _mm_mul_ps(rotation[row][1], _mm_loadu_ps(f[InvInertiaLocal00 + 3 * column + 1] + i))),
+                                                             _mm_mul_ps(rotation[row][2], _mm_loadu_ps(f[InvInertiaLocal00 + 3 * column + 2] + i)));
+            }
+        }
+        for (int row = 0; row < 3; row++)
+        {
+            for (int column = 0; column < 3; column++)
+            {
+                __m128 world = _mm_add_ps(_mm_add_ps(_mm_mul_ps(product[row][0], rotation[column][0]),
+                                                     _mm_mul_ps(product[row][1], rotation[column][1])),
+                                                     _mm_mul_ps(product[row][2], rotation[column][2]));
+                _mm_storeu_ps(f[InvInertia00 + 3 * column + row] + i, world);
+            }
+        }
+    }
+#else
+    this->IntegrateScalar(dt, 0, this->paddedCount);
+#endif
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "../../Components/PhysicsComponent.hpp"
+
+/**
+BodyState - linear and angular state of the dynamic bodies as a structure of arrays, one float array per
+component. Integrate runs over 4 bodies per SSE instruction, the arrays are padded to a multiple of 4
+with bodies that have no mass and no forces. The state persists between steps, a body keeps its slot
+until the set of bodies changes.
+*/
+class BodyState
+{
+    public:
+        enum Field
+        {
+            PositionX, PositionY, PositionZ,
+            VelocityX, VelocityY, VelocityZ,
+            AccelerationX, AccelerationY, AccelerationZ,
+            ForceX, ForceY, ForceZ,
+            InverseMass,
+            OrientationX, OrientationY, OrientationZ, OrientationW,
+            AngularVelX, AngularVelY, AngularVelZ,
+            AngularAccX, AngularAccY, AngularAccZ,
+            TorqueX, TorqueY, TorqueZ,
+            // inverse inertia tensor, column major like glm
+            InvInertia00, InvInertia01, InvInertia02,
+            InvInertia10, InvInertia11, InvInertia12,
+            InvInertia20, InvInertia21, InvInertia22,
+            // body space inverse inertia tensor, the world one is refreshed from it after every step
+            InvInertiaLocal00, InvInertiaLocal01, InvInertiaLocal02,
+            InvInertiaLocal10, InvInertiaLocal11, InvInertiaLocal12,
+            InvInertiaLocal20, InvInertiaLocal21, InvInertiaLocal22,
+            FieldCount
+        };
+
+        BodyState();
+
+        /**
+        Sets the number of bodies. The padding bodies are zeroed.
+        */
+        void Resize(int count);
+        int  Size();
+
+        /**
+        Load copies the whole state of a component into slot index, done when the body gets its slot.
+        LoadInputs only copies what gameplay and the solver change between steps: position, orientation,
+        velocities and the accumulators.
+        Store writes back what a step changes, including the world inverse inertia, and clears the accumulators.
+        */
+        void Load(int index, const PhysicsComponent& component);
+        void LoadInputs(int index, const PhysicsComponent& component);
+        void Store(int index, PhysicsComponent& component);
+
+        /**
+        Integrate advances every body by dt (semi implicit Euler). Orientations are integrated with the
+        quaternion derivative and normalized, then the world inverse inertia follows the new orientation.
+        */
+        void Integrate(float dt);
+
+        /**
+        IntegrateScalar - the same step one body at a time, used without SSE and as the reference in tests.
+        */
+        void IntegrateScalar(float dt, int begin, int end);
+
+        float* Get(Field field);
+
+    private:
+        int                 count;
+        int                 paddedCount;
+        std::vector<float>  fields[FieldCount];
+};
@@ -1,54 +1,102 @@
 #include "Collider.hpp"
+#include <atomic>
 #include "../../Components/PhysicsComponent.hpp"
 #include "../../util.hpp"
 
+// colliders are created from several threads by PhysicsWorldBatch users
+static std::atomic<std::uint32_t> nextColliderID(1);
+
 Collider::Collider( int entityID,
                     glm::vec3 center,
-                    std::vector<glm::vec3> points,
-                    std::vector<std::pair<int, int>> edges,
-                    std::vector<ColliderFace> faces,
+                    std::shared_ptr<const Hull> hull,
                     DynamicType  dynamicType) : \
+                    id(nextColliderID.fetch_add(1, std::memory_order_relaxed)),
                     row(0),
                     col(0),
+                    level(0),
                     center(center),
-                    faces(faces),
-                    edges(edges),
-                    points(points),
+                    orientation(1.f, 0.f, 0.f, 0.f),
+                    hull(hull),
+                    bodyOffset(0.f),
+                    bodyOrientation(1.f, 0.f, 0.f, 0.f),
+                    radius(hull->radius),
                     entityID(entityID),
-                    dynamicType(dynamicType)
+                    dynamicType(dynamicType),
+                    layer(CollisionLayer::Default),
+                    mask(CollisionLayer::All),
+                    isSensor(false),
+                    isCompound(false)
 {
-
+    this->UpdateBounds();
 }
 
 Collider::~Collider()
 {
-    
+
+}
+
+void Collider::Attach(glm::vec3 bodyPosition, glm::quat bodyOrientation)
+{
+    glm::quat inverseBody = glm::conjugate(glm::normalize(bodyOrientation));
+    this->bodyOffset = inverseBody * (this->center - bodyPosition);
+    this->bodyOrientation = inverseBody * this->orientation;
+}
+
+void Collider::Update(glm::vec3 bodyPosition, glm::quat bodyOrientation)
+{
+    glm::quat body = glm::normalize(bodyOrientation);
+    this->orientation = body * this->bodyOrientation;
+    this->center = bodyPosition + body * this->bodyOffset;
+    this->UpdateBounds();
+}
+
+void Collider::UpdateBounds()
+{
+    // rotated box extents - project the local half extents on the world axes.
+    glm::mat3 rotation = glm::mat3_cast(this->orientation);
+    glm::vec3 halfExtents = this->hull->aabbHalfExtents;
+    glm::vec3 worldHalfExtents = glm::abs(rotation[0]) * halfExtents.x + 
+                                 glm::abs(rotation[1]) * halfExtents.y + 
+                                 glm::abs(rotation[2]) * halfExtents.z;
+    glm::vec3 worldCenter = this->center + rotation * this->hull->aabbCenter;
+    this->aabbMin = worldCenter - worldHalfExtents;
+    this->aabbMax = worldCenter + worldHalfExtents;
+}
+
+glm::vec3 Collider::ToWorld(glm::vec3 localPoint)
+{
+    return this->center + this->orientation * localPoint;
 }
 
-void Collider::Update(glm::vec3 translation)
+glm::vec3 Collider::ToLocal(glm::vec3 worldPoint)
 {
-    this->center += translation;
-    for (int i = 0; i < this->points.size(); i++)
-    {
-        this->points[i] += translation;
-    }
-    printVector(this->center, "Collider center");
+    return glm::conjugate(this->orientation) * (worldPoint - this->center);
 }
 
 const std::vector<glm::vec3>& Collider::GetPoints()
 {
-    assert(this->points.size() > 0);
-    return this->points;
+    assert(this->hull->points.size() > 0);
+    return this->hull->points;
 }
 
 const std::vector<ColliderFace>& Collider::GetFaces()
 {
-    assert(this->faces.size() > 0);
-    return this->faces;
+    assert(this->hull->faces.size() > 0);
+    return this->hull->faces;
 }
 
 const std::vector<std::pair<int, int>>& Collider::GetEdges()
 {
-    assert(this->edges.size() > 0);
-    return this->edges;
-}
\ No newline at end of file
+    assert(this->hull->edges.size() > 0);
+    return this->hull->edges;
+}
+
+const std::vector<std::pair<int, int>>& Collider::GetEdgeFaces()
+{
+    return this->hull->edgeFaces;
+}
+
+std::shared_ptr<const Hull> Collider::GetHull()
+{
+    return this->hull;
+}
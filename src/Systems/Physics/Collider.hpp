@@ -1,8 +1,10 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <memory>
 #include <vector>
+#include <cstdint>
 #include "../../Components/PhysicsComponent.hpp"
 
 
@@ -12,44 +14,128 @@ struct ColliderFace
     std::vector<int> points;
 };
 
+/**
+Hull - the immutable geometry of a convex collider.
+Points are stored in local space (relative to the centroid) so the same hull can be
+shared by any number of colliders.
+*/
+struct Hull
+{
+    std::vector<glm::vec3>              points;
+    std::vector<ColliderFace>           faces;
+    std::vector<std::pair<int, int>>    edges;
+    // the two faces adjacent to each edge, used to prune edge/edge SAT tests. -1 if unknown.
+    std::vector<std::pair<int, int>>    edgeFaces;
+
+    // local bounds, used for the broad early-out before SAT
+    float                               radius;
+    glm::vec3                           aabbCenter;
+    glm::vec3                           aabbHalfExtents;
+
+    // set when the hull is an oriented box, box pairs then skip the generic SAT.
+    // boxAxes holds the box axes as columns.
+    bool                                isBox = false;
+    glm::vec3                           boxCenter;
+    glm::vec3                           boxHalfExtents;
+    glm::mat3                           boxAxes;
+};
+
+/**
+CollisionLayer - bits for Collider::layer and Collider::mask.
+A pair is only tested when each collider's layer is in the other's mask.
+*/
+namespace CollisionLayer
+{
+    const std::uint32_t Default     = 1u << 0;
+    const std::uint32_t Player      = 1u << 1;
+    const std::uint32_t Projectile  = 1u << 2;
+    const std::uint32_t Prop        = 1u << 3;
+    const std::uint32_t All         = 0xffffffffu;
+}
+
 /**
 Collider - currently represents either a box or plane. Both use the same interface.
+The geometry lives in a shared local-space Hull, the collider only holds the world transform.
 */
 class Collider
 {
     public:
         /**
         entityID     - the ID of the entity that owns the collider.
-        center       - the center point of the collider
+        center       - the world position of the hull centroid
+        hull         - local space geometry, can be shared between colliders
         colliderType - runtime type info.
         dynamic      - enum indicating how we should treat the collider during collisions
         */
         Collider( int entityID,
                   glm::vec3 center,
-                  std::vector<glm::vec3> points,
-                  std::vector<std::pair<int, int>> edges,
-                  std::vector<ColliderFace> faces,
+                  std::shared_ptr<const Hull> hull,
                   DynamicType  dynamicType);
 
-        ~Collider();
+        virtual ~Collider();
         // virtual void ComputeDerivedData() = 0;
-        void Update(glm::vec3 translation);
+
+        /**
+        Attach records where the collider sits relative to the body that owns it.
+        Has to be called once with the initial body transform, before any Update.
+        */
+        virtual void Attach(glm::vec3 bodyPosition, glm::quat bodyOrientation);
+
+        /**
+        Update moves the collider with its body. Only the transform is written, the hull is untouched.
+        */
+        virtual void Update(glm::vec3 bodyPosition, glm::quat bodyOrientation);
+
+        /**
+        Recomputes the world AABB from the local one. Constant time, called on every Update.
+        */
+        void UpdateBounds();
+
+        /**
+        CanCollide is the layer/mask filter, checked before any narrowphase work.
+        */
+        bool CanCollide(const Collider& other) const
+        {
+            return (this->layer & other.mask) != 0 && (other.layer & this->mask) != 0;
+        }
+
+        glm::vec3 ToWorld(glm::vec3 localPoint);
+        glm::vec3 ToLocal(glm::vec3 worldPoint);
 
         // ACCESSORS
 
         const std::vector<glm::vec3>&           GetPoints();
         const std::vector<ColliderFace>&        GetFaces();
         const std::vector<std::pair<int, int>>& GetEdges();
+        const std::vector<std::pair<int, int>>& GetEdgeFaces();
+        std::shared_ptr<const Hull>             GetHull();
 
+        // unique for the life of the process, keys the broadphase pairs
+        std::uint32_t               id;
+        // cell and level of the grid the collider is stored in
         int                         row;
         int                         col;
+        int                         level;
         glm::vec3                   center;
+        glm::quat                   orientation;
+        // world bounds, the bounding sphere is centered at center.
+        glm::vec3                   aabbMin;
+        glm::vec3                   aabbMax;
+        float                       radius;
         int                         entityID;
         DynamicType                 dynamicType;
+        // the layer bits of the collider and the layers it collides with
+        std::uint32_t               layer;
+        std::uint32_t               mask;
+        // sensors only report overlaps, they never generate contacts
+        bool                        isSensor;
+        // set by CompoundCollider, the hull is then only the bounds of the children
+        bool                        isCompound;
 
     protected:
 
-        std::vector<glm::vec3>              points;
-        std::vector<ColliderFace>           faces;
-        std::vector<std::pair<int, int>>    edges;
-};
\ No newline at end of file
+        std::shared_ptr<const Hull>         hull;
+        // transform relative to the owning body
+        glm::vec3                           bodyOffset;
+        glm::quat                           bodyOrientation;
+};
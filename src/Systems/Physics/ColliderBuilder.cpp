@@ -1,25 +1,807 @@
 #include <glm/gtc/epsilon.hpp>
+#include <cmath>
+#include <cfloat>
 #include <iostream>
 #include <unordered_set>
+#include <unordered_map>
+#include <algorithm>
 #include "ColliderBuilder.hpp"
 #include "../../util.hpp"
 
 const float epsilon = 0.005f;
+const float weldEpsilon = 0.0001f;
 
 std::shared_ptr<Collider> ColliderBuilder::Build(int id, DynamicType colliderType, std::vector<glm::vec3> points)
 {
-	/**
-	TODO : Good as a starting point, but this is very slow. Optimize! 
-	*/
+	// the hull is stored relative to its centroid, the centroid becomes the collider position.
+	glm::vec3 center = ColliderBuilder::GetCenter(points);
+	for (int i = 0; i < points.size(); i++)
+	{
+		points[i] -= center;
+	}
+	std::shared_ptr<const Hull> hull = ColliderBuilder::BuildHull(points);
+	return std::make_shared<Collider>(id, center, hull, colliderType);
+}
+
+std::shared_ptr<Collider> ColliderBuilder::Build(int id, DynamicType colliderType, std::vector<glm::vec3> points, HullCache& cache)
+{
+	std::uint64_t key = HullCache::Hash(points);
+	glm::vec3 center = ColliderBuilder::GetCenter(points);
+	std::shared_ptr<const Hull> hull = cache.Find(key);
+	if (hull == nullptr)
+	{
+		for (int i = 0; i < points.size(); i++)
+		{
+			points[i] -= center;
+		}
+		hull = ColliderBuilder::BuildHull(points);
+		cache.Insert(key, hull);
+	}
+	return std::make_shared<Collider>(id, center, hull, colliderType);
+}
+
+std::shared_ptr<Collider> ColliderBuilder::BuildBox(int id, DynamicType colliderType, glm::vec3 min, glm::vec3 max)
+{
+	std::vector<glm::vec3> corners;
+	for (int k = 0; k < 3; k++)
+	{
+		if (max[k] - min[k] < epsilon)
+			min[k] = max[k] - 1.f;
+	}
+	for (int i = 0; i < 8; i++)
+	{
+		corners.push_back(glm::vec3(i & 1 ? max.x : min.x,
+									i & 2 ? max.y : min.y,
+									i & 4 ? max.z : min.z));
+	}
+	return ColliderBuilder::Build(id, colliderType, corners);
+}
+
+std::shared_ptr<CompoundCollider> ColliderBuilder::BuildCompound(int id, DynamicType colliderType, std::vector<std::shared_ptr<Collider>> children)
+{
+	if (children.empty())
+		return nullptr;
+	glm::vec3 min = children[0]->aabbMin;
+	glm::vec3 max = children[0]->aabbMax;
+	for (int i = 1; i < children.size(); i++)
+	{
+		min = glm::min(min, children[i]->aabbMin);
+		max = glm::max(max, children[i]->aabbMax);
+	}
+	std::shared_ptr<Collider> bounds = ColliderBuilder::BuildBox(id, colliderType, min, max);
+	return std::make_shared<CompoundCollider>(id, bounds->center, bounds->GetHull(), colliderType, children);
+}
+
+MassProperties ColliderBuilder::ComputeMassProperties(const Hull& hull, float density)
+{
+	// covariance of the unit tetrahedron (0, e1, e2, e3), every tetrahedron is a linear map of it
+	const glm::mat3 canonical = glm::mat3(2.f, 1.f, 1.f, 1.f, 2.f, 1.f, 1.f, 1.f, 2.f) * (1.f / 120.f);
+	glm::vec3 origin = ColliderBuilder::GetCenter(hull.points);
+	float volume = 0.f;
+	glm::vec3 moment(0.f, 0.f, 0.f);
+	glm::mat3 covariance(0.f);
+	for (int i = 0; i < hull.faces.size(); i++)
+	{
+		const std::vector<int>& points = hull.faces[i].points;
+		glm::vec3 a = hull.points[points[0]] - origin;
+		for (int k = 1; k + 1 < points.size(); k++)
+		{
+			glm::vec3 b = hull.points[points[k]] - origin;
+			glm::vec3 c = hull.points[points[k + 1]] - origin;
+			glm::mat3 tetrahedron(a, b, c);
+			// the origin is inside the hull, only the winding of the face changes the sign
+			float determinant = std::abs(glm::determinant(tetrahedron));
+			volume += determinant / 6.f;
+			moment += (determinant / 24.f) * (a + b + c);
+			covariance = covariance + determinant * tetrahedron * canonical * glm::transpose(tetrahedron);
+		}
+	}
+
+	MassProperties properties;
+	properties.volume = volume;
+	properties.mass = density * volume;
+	properties.centerOfMass = glm::vec3(0.f, 0.f, 0.f);
+	properties.inertiaTensor = glm::mat3(0.f);
+	if (volume <= 0.f)
+		return properties;
+	glm::vec3 offset = moment / volume;
+	properties.centerOfMass = origin + offset;
+	// covariance about the center of mass, then I = trace(C) * identity - C
+	covariance = density * covariance - properties.mass * glm::outerProduct(offset, offset);
+	float trace = covariance[0][0] + covariance[1][1] + covariance[2][2];
+	properties.inertiaTensor = glm::mat3(trace) - covariance;
+	return properties;
+}
+
+MassProperties ColliderBuilder::ComputeMassProperties(std::shared_ptr<Collider> collider, float density)
+{
+	return ColliderBuilder::ComputeMassProperties(std::vector<std::shared_ptr<Collider>>{collider}, density);
+}
+
+MassProperties ColliderBuilder::ComputeMassProperties(const std::vector<std::shared_ptr<Collider>>& colliders, float density)
+{
+	std::vector<std::shared_ptr<Collider>> parts;
+	for (int i = 0; i < colliders.size(); i++)
+	{
+		if (colliders[i]->isCompound)
+		{
+			const std::vector<std::shared_ptr<Collider>>& children = static_cast<CompoundCollider&>(*colliders[i]).GetChildren();
+			parts.insert(parts.end(), children.begin(), children.end());
+		}
+		else
+			parts.push_back(colliders[i]);
+	}
+
+	std::vector<MassProperties> partProperties(parts.size());
+	MassProperties properties;
+	properties.mass = 0.f;
+	properties.volume = 0.f;
+	properties.centerOfMass = glm::vec3(0.f, 0.f, 0.f);
+	properties.inertiaTensor = glm::mat3(0.f);
+	for (int i = 0; i < parts.size(); i++)
+	{
+		// to world space
+		partProperties[i] = ColliderBuilder::ComputeMassProperties(*parts[i]->GetHull(), density);
+		glm::mat3 rotation = glm::mat3_cast(parts[i]->orientation);
+		partProperties[i].centerOfMass = parts[i]->ToWorld(partProperties[i].centerOfMass);
+		partProperties[i].inertiaTensor = rotation * partProperties[i].inertiaTensor * glm::transpose(rotation);
+		properties.mass += partProperties[i].mass;
+		properties.volume += partProperties[i].volume;
+		properties.centerOfMass += partProperties[i].mass * partProperties[i].centerOfMass;
+	}
+	if (properties.mass <= 0.f)
+		return properties;
+	properties.centerOfMass = properties.centerOfMass / properties.mass;
+	for (int i = 0; i < parts.size(); i++)
+	{
+		glm::vec3 offset = properties.centerOfMass - partProperties[i].centerOfMass;
+		properties.inertiaTensor = properties.inertiaTensor + ColliderBuilder::ShiftInertia(partProperties[i].inertiaTensor, partProperties[i].mass, offset);
+	}
+	return properties;
+}
+
+glm::mat3 ColliderBuilder::ShiftInertia(const glm::mat3& inertiaTensor, float mass, glm::vec3 offset)
+{
+	// parallel axis theorem, I + m * (|d|^2 * identity - d * d^T)
+	return inertiaTensor + mass * (glm::mat3(glm::dot(offset, offset)) - glm::outerProduct(offset, offset));
+}
+
+std::shared_ptr<TriangleMesh> ColliderBuilder::BuildTriangleMesh(int id, const std::vector<float>& vertices, const std::vector<int>& indices, int stride)
+{
+	std::vector<glm::vec3> points;
+	points.reserve(vertices.size() / 3);
+	for (int i = 0; i + 2 < vertices.size(); i += 3)
+	{
+		points.push_back(glm::vec3(vertices[i], vertices[i + 1], vertices[i + 2]));
+	}
+	std::vector<int> triangles;
+	triangles.reserve(indices.size() / stride);
+	for (int i = 0; i < indices.size(); i += stride)
+	{
+		triangles.push_back(indices[i]);
+	}
+	if (triangles.size() < 3)
+		return nullptr;
+	triangles.resize(triangles.size() - triangles.size() % 3);
+	return std::make_shared<TriangleMesh>(id, points, triangles);
+}
+
+std::shared_ptr<Heightfield> ColliderBuilder::BuildHeightfield(int id, const std::vector<glm::vec3>& points)
+{
+	if (points.empty())
+		return nullptr;
+	// the number of distinct x and z coordinates gives the grid size
+	std::vector<float> xs, zs;
+	xs.reserve(points.size());
+	zs.reserve(points.size());
+	for (int i = 0; i < points.size(); i++)
+	{
+		xs.push_back(points[i].x);
+		zs.push_back(points[i].z);
+	}
+	std::sort(xs.begin(), xs.end());
+	std::sort(zs.begin(), zs.end());
+	int cols = 1;
+	int rows = 1;
+	for (int i = 1; i < xs.size(); i++)
+	{
+		if (xs[i] - xs[i - 1] > epsilon)
+			cols++;
+		if (zs[i] - zs[i - 1] > epsilon)
+			rows++;
+	}
+	if (rows < 2 || cols < 2)
+		return nullptr;
+	float spacing = (xs.back() - xs.front()) / (cols - 1);
+	if (std::abs((zs.back() - zs.front()) / (rows - 1) - spacing) > epsilon)
+		return nullptr;
+
+	// every sample has to sit on a grid node and every node needs a sample
+	glm::vec3 origin(xs.front(), 0.f, zs.front());
+	std::vector<float> heights(rows * cols, 0.f);
+	std::vector<bool> isSet(rows * cols, false);
+	for (int i = 0; i < points.size(); i++)
+	{
+		int col = (int)std::round((points[i].x - origin.x) / spacing);
+		int row = (int)std::round((points[i].z - origin.z) / spacing);
+		if (std::abs(origin.x + col * spacing - points[i].x) > epsilon || std::abs(origin.z + row * spacing - points[i].z) > epsilon)
+			return nullptr;
+		heights[row * cols + col] = points[i].y;
+		isSet[row * cols + col] = true;
+	}
+	if (std::find(isSet.begin(), isSet.end(), false) != isSet.end())
+		return nullptr;
+	return std::make_shared<Heightfield>(id, origin, rows, cols, spacing, heights);
+}
+
+std::shared_ptr<Hull> ColliderBuilder::BuildHull(std::vector<glm::vec3> points)
+{
+	std::vector<HullTriangle> triangles;
+	std::vector<int> candidates = ColliderBuilder::WeldPoints(points);
+	if (!ColliderBuilder::QuickHull(points, candidates, triangles))
+		return ColliderBuilder::BuildHullBruteForce(points);
+
+	std::shared_ptr<Hull> hull = std::make_shared<Hull>();
+	ColliderBuilder::MergeTriangles(triangles, points, *hull);
+	ColliderBuilder::ComputeEdgeFaces(*hull);
+	ColliderBuilder::ComputeBounds(*hull);
+	ColliderBuilder::DetectBox(*hull);
+	return hull;
+}
+
+std::shared_ptr<Hull> ColliderBuilder::BuildHullBruteForce(std::vector<glm::vec3> points)
+{
 	glm::vec3 							center;
-	std::vector<ColliderFace> 			finalFaces;
-	std::vector<std::pair<int, int>> 	finalEdges;
+	std::shared_ptr<Hull> 				hull = std::make_shared<Hull>();
 	std::vector<std::unique_ptr<cFace>> faces;
 	
 	center = ColliderBuilder::GetCenter(points);
 	ColliderBuilder::FindExtremeFaces(faces, points, center);
-	ColliderBuilder::MergeFaces(faces, finalFaces, finalEdges, points);
-	return std::make_shared<Collider>(id, center, points, finalEdges, finalFaces, colliderType);
+	ColliderBuilder::MergeFaces(faces, hull->faces, hull->edges, points);
+	hull->points = points;
+	ColliderBuilder::ComputeEdgeFaces(*hull);
+	ColliderBuilder::ComputeBounds(*hull);
+	ColliderBuilder::DetectBox(*hull);
+	return hull;
+}
+
+std::vector<int> ColliderBuilder::WeldPoints(const std::vector<glm::vec3>& points)
+{
+	// hash the points on a grid of weld sized cells, duplicates can only be in the same or a neighbouring cell.
+	std::vector<int> unique;
+	std::unordered_map<long long, std::vector<int>> cells;
+	float cellSize = 2.f * weldEpsilon;
+	for (int i = 0; i < points.size(); i++)
+	{
+		glm::vec3 cell = glm::floor(points[i] / cellSize);
+		bool isDuplicate = false;
+		for (int x = -1; x <= 1 && !isDuplicate; x++)
+		{
+			for (int y = -1; y <= 1 && !isDuplicate; y++)
+			{
+				for (int z = -1; z <= 1 && !isDuplicate; z++)
+				{
+					long long key = ((long long)(cell.x + x) * 73856093) ^ ((long long)(cell.y + y) * 19349663) ^ ((long long)(cell.z + z) * 83492791);
+					std::unordered_map<long long, std::vector<int>>::iterator it = cells.find(key);
+					if (it == cells.end())
+						continue;
+					for (int k = 0; k < it->second.size(); k++)
+					{
+						glm::vec3 diff = points[it->second[k]] - points[i];
+						if (glm::dot(diff, diff) < weldEpsilon * weldEpsilon)
+						{
+							isDuplicate = true;
+							break;
+						}
+					}
+				}
+			}
+		}
+		if (isDuplicate)
+			continue;
+		long long key = ((long long)cell.x * 73856093) ^ ((long long)cell.y * 19349663) ^ ((long long)cell.z * 83492791);
+		cells[key].push_back(i);
+		unique.push_back(i);
+	}
+	return unique;
+}
+
+namespace
+{
+	long long EdgeKey(int a, int b)
+	{
+		return ((long long)a << 32) | (unsigned int)b;
+	}
+
+	void AddTriangle(	std::vector<HullTriangle>& triangles,
+						std::unordered_map<long long, int>& edgeToTriangle,
+						const std::vector<glm::vec3>& points,
+						int a, int b, int c)
+	{
+		HullTriangle triangle;
+		triangle.points[0] = a;
+		triangle.points[1] = b;
+		triangle.points[2] = c;
+		triangle.normal = glm::normalize(glm::cross(points[b] - points[a], points[c] - points[a]));
+		triangle.offset = glm::dot(triangle.normal, points[a]);
+		triangle.removed = false;
+		int index = triangles.size();
+		edgeToTriangle[EdgeKey(a, b)] = index;
+		edgeToTriangle[EdgeKey(b, c)] = index;
+		edgeToTriangle[EdgeKey(c, a)] = index;
+		triangles.push_back(triangle);
+	}
+
+	float Distance(const HullTriangle& triangle, const glm::vec3& point)
+	{
+		return glm::dot(triangle.normal, point) - triangle.offset;
+	}
+
+	void AssignOutside(	std::vector<HullTriangle>& triangles,
+						const std::vector<int>& newTriangles,
+						const std::vector<glm::vec3>& points,
+						int point,
+						float tolerance)
+	{
+		// the point goes to the face it is farthest from, points inside the hull are dropped.
+		int best = -1;
+		float bestDistance = tolerance;
+		for (int i = 0; i < newTriangles.size(); i++)
+		{
+			float distance = Distance(triangles[newTriangles[i]], points[point]);
+			if (distance > bestDistance)
+			{
+				bestDistance = distance;
+				best = newTriangles[i];
+			}
+		}
+		if (best != -1)
+			triangles[best].outside.push_back(point);
+	}
+
+	/**
+	Rotates and orients a face loop the way the brute force builder emits it - starting from the first
+	boundary edge of the lowest indexed triangle - so both builders give identical clipping input.
+	*/
+	void CanonicalOrder(std::vector<int>& loop)
+	{
+		int count = loop.size();
+		std::vector<int> sorted = loop;
+		std::sort(sorted.begin(), sorted.end());
+		for (int i = 0; i < count; i++)
+		{
+			for (int j = i + 1; j < count; j++)
+			{
+				for (int k = j + 1; k < count; k++)
+				{
+					std::pair<int, int> edges[3] = {{sorted[i], sorted[j]}, {sorted[j], sorted[k]}, {sorted[k], sorted[i]}};
+					for (int e = 0; e < 3; e++)
+					{
+						int position = std::find(loop.begin(), loop.end(), edges[e].first) - loop.begin();
+						bool forward = loop[(position + 1) % count] == edges[e].second;
+						bool backward = loop[(position + count - 1) % count] == edges[e].second;
+						if (!forward && !backward)
+							continue;
+						if (backward)
+						{
+							std::reverse(loop.begin(), loop.end());
+							position = count - 1 - position;
+						}
+						std::rotate(loop.begin(), loop.begin() + position, loop.end());
+						return;
+					}
+				}
+			}
+		}
+	}
+}
+
+bool ColliderBuilder::QuickHull(const std::vector<glm::vec3>& points,
+								const std::vector<int>& candidates,
+								std::vector<HullTriangle>& triangles)
+{
+	if (candidates.size() < 4)
+		return false;
+
+	// tolerance scaled with the size of the input
+	glm::vec3 maxAbs = glm::vec3(0.f, 0.f, 0.f);
+	for (int i = 0; i < candidates.size(); i++)
+	{
+		maxAbs = glm::max(maxAbs, glm::abs(points[candidates[i]]));
+	}
+	float tolerance = 30.f * FLT_EPSILON * (maxAbs.x + maxAbs.y + maxAbs.z);
+
+	// initial tetrahedron - the two most distant extreme points, the farthest point from their line
+	// and the farthest point from the resulting plane.
+	int extremes[6] = {candidates[0], candidates[0], candidates[0], candidates[0], candidates[0], candidates[0]};
+	for (int i = 0; i < candidates.size(); i++)
+	{
+		const glm::vec3& point = points[candidates[i]];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (point[axis] < points[extremes[2 * axis]][axis])
+				extremes[2 * axis] = candidates[i];
+			if (point[axis] > points[extremes[2 * axis + 1]][axis])
+				extremes[2 * axis + 1] = candidates[i];
+		}
+	}
+	int v0 = extremes[0];
+	int v1 = extremes[1];
+	float maxDistance = -1.f;
+	for (int i = 0; i < 6; i++)
+	{
+		for (int j = i + 1; j < 6; j++)
+		{
+			glm::vec3 diff = points[extremes[i]] - points[extremes[j]];
+			if (glm::dot(diff, diff) > maxDistance)
+			{
+				maxDistance = glm::dot(diff, diff);
+				v0 = extremes[i];
+				v1 = extremes[j];
+			}
+		}
+	}
+
+	int v2 = -1;
+	maxDistance = tolerance;
+	glm::vec3 line = glm::normalize(points[v1] - points[v0]);
+	for (int i = 0; i < candidates.size(); i++)
+	{
+		glm::vec3 diff = points[candidates[i]] - points[v0];
+		float distance = glm::length(diff - glm::dot(diff, line) * line);
+		if (distance > maxDistance)
+		{
+			maxDistance = distance;
+			v2 = candidates[i];
+		}
+	}
+	if (v2 == -1)
+		return false;
+
+	int v3 = -1;
+	maxDistance = tolerance;
+	glm::vec3 planeNormal = glm::normalize(glm::cross(points[v1] - points[v0], points[v2] - points[v0]));
+	for (int i = 0; i < candidates.size(); i++)
+	{
+		float distance = std::abs(glm::dot(points[candidates[i]] - points[v0], planeNormal));
+		if (distance > maxDistance)
+		{
+			maxDistance = distance;
+			v3 = candidates[i];
+		}
+	}
+	if (v3 == -1)
+		return false;
+
+	// make v0 v1 v2 counter clockwise when seen from outside (v3 behind it)
+	if (glm::dot(points[v3] - points[v0], planeNormal) > 0.f)
+		std::swap(v1, v2);
+
+	std::unordered_map<long long, int> edgeToTriangle;
+	AddTriangle(triangles, edgeToTriangle, points, v0, v1, v2);
+	AddTriangle(triangles, edgeToTriangle, points, v0, v3, v1);
+	AddTriangle(triangles, edgeToTriangle, points, v1, v3, v2);
+	AddTriangle(triangles, edgeToTriangle, points, v2, v3, v0);
+
+	std::vector<int> initial{0, 1, 2, 3};
+	for (int i = 0; i < candidates.size(); i++)
+	{
+		int point = candidates[i];
+		if (point == v0 || point == v1 || point == v2 || point == v3)
+			continue;
+		AssignOutside(triangles, initial, points, point, tolerance);
+	}
+
+	std::vector<int> 					stack;
+	std::vector<int> 					visible;
+	std::vector<std::pair<int, int>> 	horizon;
+	std::vector<int> 					orphans;
+	std::vector<int> 					newTriangles;
+	std::unordered_set<int> 			visited;
+	for (int current = 0; current < triangles.size(); current++)
+	{
+		if (triangles[current].removed || triangles[current].outside.size() == 0)
+			continue;
+
+		// the farthest outside point is guaranteed to be on the hull
+		int eye = triangles[current].outside[0];
+		for (int i = 1; i < triangles[current].outside.size(); i++)
+		{
+			int point = triangles[current].outside[i];
+			if (Distance(triangles[current], points[point]) > Distance(triangles[current], points[eye]))
+				eye = point;
+		}
+
+		// flood fill the faces visible from the eye and collect the horizon
+		stack.assign(1, current);
+		visible.clear();
+		horizon.clear();
+		visited.clear();
+		visited.insert(current);
+		while (stack.size() > 0)
+		{
+			int index = stack.back();
+			stack.pop_back();
+			visible.push_back(index);
+			for (int k = 0; k < 3; k++)
+			{
+				int a = triangles[index].points[k];
+				int b = triangles[index].points[(k + 1) % 3];
+				int neighbour = edgeToTriangle[EdgeKey(b, a)];
+				if (visited.find(neighbour) != visited.end())
+					continue;
+				if (Distance(triangles[neighbour], points[eye]) > tolerance)
+				{
+					visited.insert(neighbour);
+					stack.push_back(neighbour);
+				}
+				else
+					horizon.push_back(std::make_pair(a, b));
+			}
+		}
+
+		orphans.clear();
+		for (int i = 0; i < visible.size(); i++)
+		{
+			HullTriangle& triangle = triangles[visible[i]];
+			triangle.removed = true;
+			for (int k = 0; k < triangle.outside.size(); k++)
+			{
+				if (triangle.outside[k] != eye)
+					orphans.push_back(triangle.outside[k]);
+			}
+			triangle.outside.clear();
+		}
+
+		// connect the horizon to the eye, edges keep their winding
+		newTriangles.clear();
+		for (int i = 0; i < horizon.size(); i++)
+		{
+			newTriangles.push_back(triangles.size());
+			AddTriangle(triangles, edgeToTriangle, points, horizon[i].first, horizon[i].second, eye);
+		}
+		for (int i = 0; i < orphans.size(); i++)
+		{
+			AssignOutside(triangles, newTriangles, points, orphans[i], tolerance);
+		}
+	}
+	return true;
+}
+
+void ColliderBuilder::MergeTriangles(	const std::vector<HullTriangle>& triangles,
+										const std::vector<glm::vec3>& points,
+										Hull& hull)
+{
+	std::unordered_map<long long, int> edgeToTriangle;
+	for (int i = 0; i < triangles.size(); i++)
+	{
+		if (triangles[i].removed)
+			continue;
+		for (int k = 0; k < 3; k++)
+		{
+			edgeToTriangle[EdgeKey(triangles[i].points[k], triangles[i].points[(k + 1) % 3])] = i;
+		}
+	}
+
+	std::vector<int> 					group(triangles.size(), -1);
+	std::vector<int> 					remap(points.size(), -1);
+	std::vector<std::vector<int>> 		facePoints;
+	std::vector<glm::vec3> 				faceNormals;
+	std::vector<int> 					stack;
+	std::vector<int> 					members;
+	std::unordered_map<int, int> 		next;
+	for (int i = 0; i < triangles.size(); i++)
+	{
+		if (triangles[i].removed || group[i] != -1)
+			continue;
+
+		// flood fill the neighbours with the same normal
+		int groupIndex = facePoints.size();
+		glm::vec3 normal = glm::vec3(0.f, 0.f, 0.f);
+		members.clear();
+		stack.assign(1, i);
+		group[i] = groupIndex;
+		while (stack.size() > 0)
+		{
+			int index = stack.back();
+			stack.pop_back();
+			members.push_back(index);
+			const HullTriangle& triangle = triangles[index];
+			normal += glm::cross(points[triangle.points[1]] - points[triangle.points[0]], points[triangle.points[2]] - points[triangle.points[0]]);
+			for (int k = 0; k < 3; k++)
+			{
+				int neighbour = edgeToTriangle[EdgeKey(triangle.points[(k + 1) % 3], triangle.points[k])];
+				if (group[neighbour] == -1 && glm::all(glm::epsilonEqual(triangles[i].normal, triangles[neighbour].normal, epsilon)))
+				{
+					group[neighbour] = groupIndex;
+					stack.push_back(neighbour);
+				}
+			}
+		}
+
+		// boundary edges are the ones whose twin is in another group, follow them to get the ordered points
+		next.clear();
+		int start = -1;
+		for (int m = 0; m < members.size(); m++)
+		{
+			const HullTriangle& triangle = triangles[members[m]];
+			for (int k = 0; k < 3; k++)
+			{
+				int a = triangle.points[k];
+				int b = triangle.points[(k + 1) % 3];
+				if (group[edgeToTriangle[EdgeKey(b, a)]] != groupIndex)
+				{
+					next[a] = b;
+					start = a;
+				}
+			}
+		}
+		std::vector<int> ordered;
+		int currentPoint = start;
+		do
+		{
+			ordered.push_back(currentPoint);
+			currentPoint = next[currentPoint];
+		} while (currentPoint != start && ordered.size() <= next.size());
+
+		for (int k = 0; k < ordered.size(); k++)
+		{
+			remap[ordered[k]] = 0;
+		}
+		CanonicalOrder(ordered);
+		facePoints.push_back(ordered);
+		faceNormals.push_back(glm::normalize(normal));
+	}
+
+	// same face order as the brute force builder - by the lowest three indices of each face
+	std::vector<std::vector<int>> 	keys(facePoints.size());
+	std::vector<int> 				order(facePoints.size());
+	for (int i = 0; i < facePoints.size(); i++)
+	{
+		keys[i] = facePoints[i];
+		std::sort(keys[i].begin(), keys[i].end());
+		keys[i].resize(3);
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [&keys](int a, int b) { return keys[a] < keys[b]; });
+
+	// keep only the hull vertices, in the order they were given
+	for (int i = 0; i < points.size(); i++)
+	{
+		if (remap[i] == -1)
+			continue;
+		remap[i] = hull.points.size();
+		hull.points.push_back(points[i]);
+	}
+
+	std::unordered_set<long long> edges;
+	for (int f = 0; f < order.size(); f++)
+	{
+		int i = order[f];
+		ColliderFace face;
+		face.normal = faceNormals[i];
+		int count = facePoints[i].size();
+		for (int k = 0; k < count; k++)
+		{
+			int a = remap[facePoints[i][k]];
+			int b = remap[facePoints[i][(k + 1) % count]];
+			face.points.push_back(a);
+			if (edges.find(EdgeKey(b, a)) == edges.end() && edges.find(EdgeKey(a, b)) == edges.end())
+			{
+				edges.insert(EdgeKey(a, b));
+				hull.edges.push_back(std::make_pair(a, b));
+			}
+		}
+		hull.faces.push_back(face);
+	}
+}
+
+void ColliderBuilder::ComputeEdgeFaces(Hull& hull)
+{
+	hull.edgeFaces.assign(hull.edges.size(), std::make_pair(-1, -1));
+	for (int i = 0; i < hull.edges.size(); i++)
+	{
+		std::pair<int, int> edge = hull.edges[i];
+		for (int j = 0; j < hull.faces.size(); j++)
+		{
+			const std::vector<int>& facePoints = hull.faces[j].points;
+			int count = facePoints.size();
+			for (int k = 0; k < count; k++)
+			{
+				int v1 = facePoints[k];
+				int v2 = facePoints[(k + 1) % count];
+				if ((v1 == edge.first && v2 == edge.second) || (v1 == edge.second && v2 == edge.first))
+				{
+					if (hull.edgeFaces[i].first == -1)
+						hull.edgeFaces[i].first = j;
+					else
+						hull.edgeFaces[i].second = j;
+					break;
+				}
+			}
+		}
+	}
+}
+
+void ColliderBuilder::ComputeBounds(Hull& hull)
+{
+	glm::vec3 min = hull.points[0];
+	glm::vec3 max = hull.points[0];
+	float radiusSquared = 0.f;
+	for (int i = 0; i < hull.points.size(); i++)
+	{
+		min = glm::min(min, hull.points[i]);
+		max = glm::max(max, hull.points[i]);
+		radiusSquared = glm::max(radiusSquared, glm::dot(hull.points[i], hull.points[i]));
+	}
+	hull.radius = sqrtf(radiusSquared);
+	hull.aabbCenter = 0.5f * (min + max);
+	hull.aabbHalfExtents = 0.5f * (max - min);
+}
+
+bool ColliderBuilder::DetectBox(Hull& hull)
+{
+	hull.isBox = false;
+	if (hull.points.size() != 8 || hull.faces.size() != 6)
+		return false;
+
+	// every face normal has to be one of three orthogonal axes (or its opposite)
+	glm::vec3 axes[3];
+	int axisCount = 0;
+	for (int i = 0; i < hull.faces.size(); i++)
+	{
+		if (hull.faces[i].points.size() != 4)
+			return false;
+		glm::vec3 normal = hull.faces[i].normal;
+		bool isKnown = false;
+		for (int k = 0; k < axisCount; k++)
+		{
+			float cosine = std::abs(glm::dot(normal, axes[k]));
+			if (cosine > 1.f - epsilon)
+				isKnown = true;
+			else if (cosine > epsilon)
+				return false;
+		}
+		if (isKnown)
+			continue;
+		if (axisCount == 3)
+			return false;
+		axes[axisCount++] = normal;
+	}
+	if (axisCount != 3)
+		return false;
+	axes[2] = glm::normalize(glm::cross(axes[0], axes[1]));
+
+	glm::vec3 min = glm::vec3(FLT_MAX, FLT_MAX, FLT_MAX);
+	glm::vec3 max = -min;
+	for (int i = 0; i < hull.points.size(); i++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			float projection = glm::dot(hull.points[i], axes[k]);
+			min[k] = std::min(min[k], projection);
+			max[k] = std::max(max[k], projection);
+		}
+	}
+	glm::vec3 middle = 0.5f * (min + max);
+	glm::vec3 halfExtents = 0.5f * (max - min);
+
+	// all the points have to sit on the corners
+	for (int i = 0; i < hull.points.size(); i++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			float projection = glm::dot(hull.points[i], axes[k]);
+			if (std::abs(std::abs(projection - middle[k]) - halfExtents[k]) > epsilon)
+				return false;
+		}
+	}
+
+	hull.boxAxes = glm::mat3(axes[0], axes[1], axes[2]);
+	hull.boxCenter = hull.boxAxes * middle;
+	hull.boxHalfExtents = halfExtents;
+	hull.isBox = true;
+	return true;
 }
 
 void ColliderBuilder::FindExtremeFaces(	std::vector<std::unique_ptr<cFace>>& faces,
@@ -143,7 +925,7 @@ void ColliderBuilder::MergeFaces(	std::vector<std::unique_ptr<cFace>>& faces,
  	}
 }
 
-bool ColliderBuilder::IsExtremeEdge(std::vector<int> pointIndices, std::pair<int, int> edge, std::vector<glm::vec3>& points)
+bool ColliderBuilder::IsExtremeEdge(const std::vector<int>& pointIndices, std::pair<int, int> edge, std::vector<glm::vec3>& points)
 {
 	/*				 / Q
 			 	   / |
@@ -181,7 +963,7 @@ bool ColliderBuilder::IsExtremeEdge(std::vector<int> pointIndices, std::pair<int
 	return true;
 }
 
-bool ColliderBuilder::ContainsEdge(std::vector<std::pair<int, int>> edges, std::pair<int, int> edge)
+bool ColliderBuilder::ContainsEdge(const std::vector<std::pair<int, int>>& edges, std::pair<int, int> edge)
 {
 	for (int i = 0; i < edges.size(); i++)
 	{
@@ -193,7 +975,7 @@ bool ColliderBuilder::ContainsEdge(std::vector<std::pair<int, int>> edges, std::
 	return false;
 }
 
-glm::vec3 ColliderBuilder::GetCenter(std::vector<glm::vec3> points)
+glm::vec3 ColliderBuilder::GetCenter(const std::vector<glm::vec3>& points)
 {
 	glm::vec3 center = glm::vec3(0.f,0.f,0.f);
 	float count = points.size();
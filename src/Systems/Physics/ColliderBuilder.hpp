@@ -5,6 +5,10 @@
 #include <glm/glm.hpp>
 #include <unordered_set>
 #include "Collider.hpp"
+#include "HullCache.hpp"
+#include "Heightfield.hpp"
+#include "TriangleMesh.hpp"
+#include "CompoundCollider.hpp"
 
 struct cFace
 {
@@ -13,23 +17,154 @@ struct cFace
 	std::unordered_set<int> points;
 };
 
+/**
+HullTriangle - a face of the triangle hull built by quickhull. Points are in counter clockwise
+order when looking at the face from outside.
+*/
+struct HullTriangle
+{
+	int 				points[3];
+	glm::vec3 			normal;
+	float 				offset;
+	bool 				removed;
+	// points still outside of this face, waiting to be added to the hull
+	std::vector<int> 	outside;
+};
+
+/**
+MassProperties - mass, center of mass and inertia tensor (about the center of mass) of a solid of uniform density.
+*/
+struct MassProperties
+{
+	float		mass;
+	float		volume;
+	glm::vec3	centerOfMass;
+	glm::mat3	inertiaTensor;
+};
+
 /**
 ColliderBuilder is used to generate the edges and faces of a collider from a set of points.
-The algorithm used is a naive one and should be optimized at a later stage.
+The hull is built with quickhull (O(n log n) expected), coplanar triangles are then merged into
+polygonal faces. The original brute force builder is kept for flat inputs and as a reference.
 */
 class ColliderBuilder
 {
 	public:
 
+		/**
+		Build creates a collider from world space points. The hull is built around the centroid
+		of the points and the centroid becomes the collider position.
+		*/
 		static std::shared_ptr<Collider> Build(int id, DynamicType colliderType, std::vector<glm::vec3> points);
 
+		/**
+		Same as Build but the hull is taken from the cache when the same points were built before.
+		New hulls are added to the cache, saving it is left to the caller.
+		*/
+		static std::shared_ptr<Collider> Build(int id, DynamicType colliderType, std::vector<glm::vec3> points, HullCache& cache);
+
+		/**
+		BuildBox creates a collider from the corners of the given axis aligned bounds.
+		Flat bounds get one unit of thickness below them so the hull has a volume.
+		*/
+		static std::shared_ptr<Collider> BuildBox(int id, DynamicType colliderType, glm::vec3 min, glm::vec3 max);
+
+		/**
+		BuildCompound puts the given colliders of one body behind a single proxy spanning their bounds.
+		*/
+		static std::shared_ptr<CompoundCollider> BuildCompound(int id, DynamicType colliderType, std::vector<std::shared_ptr<Collider>> children);
+
+		/**
+		BuildTriangleMesh creates a static mesh from the vertices and indices of a Geometry
+		(3 floats per vertex, stride indices per triangle corner, the vertex index first).
+		*/
+		static std::shared_ptr<TriangleMesh> BuildTriangleMesh(int id, const std::vector<float>& vertices, const std::vector<int>& indices, int stride);
+
+		/**
+		BuildHeightfield creates a heightfield from the vertices of a terrain mesh laid out on a regular
+		grid with square cells (duplicated vertices are fine). Returns nullptr if the points are not such a grid.
+		*/
+		static std::shared_ptr<Heightfield> BuildHeightfield(int id, const std::vector<glm::vec3>& points);
+
+		/**
+		ComputeMassProperties integrates the volume of the hull, split in tetrahedra from its centroid to the
+		triangles of every face. The center of mass and the tensor axes are in the local space of the hull.
+		*/
+		static MassProperties ComputeMassProperties(const Hull& hull, float density = 1.f);
+
+		/**
+		Same for a collider in its current pose, the center of mass and the tensor axes are in world space.
+		The children of a compound are summed with the parallel axis theorem.
+		*/
+		static MassProperties ComputeMassProperties(std::shared_ptr<Collider> collider, float density = 1.f);
+
+		/**
+		Same for all the colliders of a body together, about their common center of mass.
+		*/
+		static MassProperties ComputeMassProperties(const std::vector<std::shared_ptr<Collider>>& colliders, float density = 1.f);
+
+		/**
+		ShiftInertia moves an inertia tensor taken about the center of mass to a point at offset from it
+		(parallel axis theorem). The result is in the same axes.
+		*/
+		static glm::mat3 ShiftInertia(const glm::mat3& inertiaTensor, float mass, glm::vec3 offset);
+
+		/**
+		BuildHull computes the faces and edges of the points as they are given (no recentering).
+		The result can be shared between many colliders.
+		*/
+		static std::shared_ptr<Hull> BuildHull(std::vector<glm::vec3> points);
+
+		/**
+		BuildHullBruteForce - the original O(n^4) builder, tests every triple of points against all the others.
+		Used when quickhull cannot start (all the points are coplanar).
+		*/
+		static std::shared_ptr<Hull> BuildHullBruteForce(std::vector<glm::vec3> points);
+
+		/**
+		WeldPoints returns the indices of the points left after merging points closer than the weld tolerance.
+		*/
+		static std::vector<int> WeldPoints(const std::vector<glm::vec3>& points);
+
+		/**
+		QuickHull builds the triangle hull of the given candidate points. Returns false if the points
+		do not span a volume.
+		*/
+		static bool QuickHull(	const std::vector<glm::vec3>& points,
+								const std::vector<int>& candidates,
+								std::vector<HullTriangle>& triangles);
+
+		/**
+		MergeTriangles groups adjacent triangles with the same normal into polygonal faces and fills the hull.
+		Only the points used by the faces are kept, in their original order.
+		*/
+		static void MergeTriangles(	const std::vector<HullTriangle>& triangles,
+									const std::vector<glm::vec3>& points,
+									Hull& hull);
+
+		/**
+		ComputeEdgeFaces finds the two faces sharing each edge (Gauss map arcs used by CheckEdges).
+		*/
+		static void ComputeEdgeFaces(Hull& hull);
+
+		/**
+		ComputeBounds fills the local bounding sphere (around the origin) and AABB of the hull.
+		*/
+		static void ComputeBounds(Hull& hull);
+
+		/**
+		DetectBox checks if the hull is an oriented box (8 points, 6 quads, 3 pairs of orthogonal normals)
+		and if so fills the box center, half extents and axes.
+		*/
+		static bool DetectBox(Hull& hull);
+
 		static void FindExtremeFaces(	std::vector<std::unique_ptr<cFace>>& faces, 
 										std::vector<glm::vec3>& points,
 										glm::vec3 center);
 
-		static bool IsExtremeEdge(std::vector<int> pointIndices, std::pair<int, int> edge, std::vector<glm::vec3>& points);
+		static bool IsExtremeEdge(const std::vector<int>& pointIndices, std::pair<int, int> edge, std::vector<glm::vec3>& points);
 
-		static glm::vec3 GetCenter(std::vector<glm::vec3> points);
+		static glm::vec3 GetCenter(const std::vector<glm::vec3>& points);
 		
 		static std::unique_ptr<cFace> CreateFace(int v1, int v2, int v3, glm::vec3 center, std::vector<glm::vec3>& points);
 		
@@ -38,5 +173,5 @@ class ColliderBuilder
 								std::vector<std::pair<int, int>>& finalEdges,
 								std::vector<glm::vec3>& points);
 		
-		static bool ContainsEdge(std::vector<std::pair<int, int>> edges, std::pair<int, int> edge);
+		static bool ContainsEdge(const std::vector<std::pair<int, int>>& edges, std::pair<int, int> edge);
 };
\ No newline at end of file
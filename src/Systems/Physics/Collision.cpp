@@ -1,16 +1,57 @@
 #include "Collision.hpp"
 
 
-Collision::Collision(  int firstID,
-                    std::shared_ptr<Collider> firstCollider,
-                    int secondID,
-                    std::shared_ptr<Collider> secondCollider,
-                    std::vector<Contact> contacts): \
-                    first(firstID), 
-                    firstCollider(firstCollider),
-                    second(secondID),
-                    secondCollider(secondCollider),
-                    contacts(contacts)
-{
-
-}
\ No newline at end of file
+ContactArena::ContactArena()
+{
+
+}
+
+void ContactArena::Clear()
+{
+    this->collisions.clear();
+    this->contacts.clear();
+    this->colliders.clear();
+}
+
+void ContactArena::AddContact(glm::vec3 contactPoint, glm::vec3 contactNormal, float penetration)
+{
+    this->contacts.emplace_back(contactPoint, contactNormal, penetration);
+}
+
+const Collision* ContactArena::AddCollision(Collider& first, Collider& second, int firstContact)
+{
+    int contactCount = this->contacts.size() - firstContact;
+    if (contactCount <= 0)
+        return nullptr;
+    Collision collision;
+    collision.first = first.entityID;
+    collision.second = second.entityID;
+    collision.firstCollider = this->colliders.size();
+    collision.secondCollider = this->colliders.size() + 1;
+    collision.firstContact = firstContact;
+    collision.contactCount = contactCount;
+    this->colliders.push_back(&first);
+    this->colliders.push_back(&second);
+    this->collisions.push_back(collision);
+    return &this->collisions.back();
+}
+
+const std::vector<Collision>& ContactArena::GetCollisions() const
+{
+    return this->collisions;
+}
+
+int ContactArena::GetContactCount() const
+{
+    return this->contacts.size();
+}
+
+const Contact* ContactArena::GetContacts(const Collision& collision) const
+{
+    return this->contacts.data() + collision.firstContact;
+}
+
+Collider& ContactArena::GetCollider(int index) const
+{
+    return *this->colliders[index];
+}
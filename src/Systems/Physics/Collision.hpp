@@ -7,21 +7,60 @@
 #include "Collider.hpp"
 
 class PhysicsComponent;
-/* 
-Collision represents a collision between 2 colliders. It contains one or more contacts
+/*
+Collision represents a collision between 2 colliders. It contains one or more contacts.
+The colliders and the contacts live in a ContactArena, the collision only keeps indices into it.
  */
-class Collision
+struct Collision
+{
+    // entity ids
+    int first;
+    int second;
+    // indices into the colliders of the arena
+    int firstCollider;
+    int secondCollider;
+    // the contacts are [firstContact, firstContact + contactCount) of the arena
+    int firstContact;
+    int contactCount;
+};
+
+/*
+ContactArena stores the collisions of a frame with all their contacts in one contiguous array.
+It is cleared, not freed, every frame, so once its vectors are warm the narrowphase does not allocate.
+Colliders are kept as plain pointers, they are owned by the grid and have to outlive the frame.
+ */
+class ContactArena
 {
     public:
-        Collision(  int firstID,
-                    std::shared_ptr<Collider> firstCollider,
-                    int secondID,
-                    std::shared_ptr<Collider> secondCollider,
-                    std::vector<Contact> contacts);
-        int first;
-        int second;
-        std::shared_ptr<Collider> firstCollider;
-        std::shared_ptr<Collider> secondCollider;
-        std::vector<Contact> contacts;
+        ContactArena();
+
+        /**
+        Clear drops every collision, the capacity is kept.
+        */
+        void Clear();
+
+        /**
+        AddContact appends a contact to the collision being built.
+        */
+        void AddContact(glm::vec3 contactPoint, glm::vec3 contactNormal, float penetration);
+
+        /**
+        AddCollision closes a collision with the contacts added since firstContact (see GetContactCount).
+        Returns nullptr without adding anything if there are none. The pointer is valid until the next AddCollision.
+        */
+        const Collision* AddCollision(Collider& first, Collider& second, int firstContact);
+
+        const std::vector<Collision>&   GetCollisions() const;
+        int                             GetContactCount() const;
+
+        /**
+        Contacts of a collision, contactCount of them.
+        */
+        const Contact*  GetContacts(const Collision& collision) const;
+        Collider&       GetCollider(int index) const;
+
     private:
-};
\ No newline at end of file
+        std::vector<Collision>  collisions;
+        std::vector<Contact>    contacts;
+        std::vector<Collider*>  colliders;
+};
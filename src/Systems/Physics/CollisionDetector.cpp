@@ -2,8 +2,10 @@
 #include <memory>
 #include <iostream>
 #include <unordered_set>
+#include <algorithm>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/norm.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include "CollisionDetector.hpp"
 #include "../../util.hpp"
 
@@ -13,16 +15,67 @@ CollisionDetector::CollisionDetector()
 
 }
 
-std::shared_ptr<Collision> CollisionDetector::Collide(std::shared_ptr<Collider> first, std::shared_ptr<Collider> second)
+bool CollisionDetector::Filter(Collider& first, Collider& second)
 {
+    if (first.CanCollide(second))
+        return true;
+    this->stats.pairsFiltered++;
+    return false;
+}
+
+const Collision* CollisionDetector::Collide(std::shared_ptr<Collider> first, std::shared_ptr<Collider> second, ContactArena& arena)
+{
+    this->stats.pairsTested++;
+    if (!this->BoundsOverlap(*first, *second))
+    {
+        this->stats.pairsRejectedEarly++;
+        return nullptr;
+    }
+
+    NarrowphaseType narrowphase = this->SelectNarrowphase(*first, *second);
+    if (narrowphase == NarrowphaseType::BoxNarrowphase)
+    {
+        this->stats.pairsBox++;
+        return this->CollideBoxes(first, second, arena);
+    }
+
+    glm::quat relativeOrientation;
+    glm::vec3 relativePosition;
+    this->TransformIntoFrame(*first, *second, relativeOrientation, relativePosition);
+
+    if (narrowphase == NarrowphaseType::GJKNarrowphase)
+    {
+        const Collision* collision;
+        this->stats.pairsGJK++;
+        if (this->CollideGJK(first, second, arena, collision))
+            return collision;
+    }
+    this->stats.pairsFullSAT++;
+
     std::vector<glm::vec3> contactPoints;
 
+    ColliderView viewA;
+    viewA.points    = &first->GetPoints();
+    viewA.faces     = &first->GetFaces();
+    viewA.edges     = &first->GetEdges();
+    viewA.edgeFaces = &first->GetEdgeFaces();
+    viewA.rotation  = glm::mat3(1.f);
+    viewA.center    = glm::vec3(0.f, 0.f, 0.f);
+
+    ColliderView viewB;
+    viewB.points    = &this->transformedPoints;
+    viewB.faces     = &second->GetFaces();
+    viewB.edges     = &second->GetEdges();
+    viewB.edgeFaces = &second->GetEdgeFaces();
+    viewB.rotation  = glm::mat3_cast(relativeOrientation);
+    viewB.center    = relativePosition;
+
     // get edges and faces
-    const std::vector<glm::vec3>&           pointsA = first->GetPoints();
-    const std::vector<std::pair<int, int>>& edgesA  = first->GetEdges();
+    const std::vector<glm::vec3>&           pointsA = *viewA.points;
+    const std::vector<std::pair<int, int>>& edgesA  = *viewA.edges;
 
-    const std::vector<glm::vec3>&           pointsB = second->GetPoints();
-    const std::vector<std::pair<int, int>>& edgesB  = second->GetEdges();
+    const std::vector<glm::vec3>&           pointsB = *viewB.points;
+    const std::vector<std::pair<int, int>>& edgesB  = *viewB.edges;
 
     SATData data;
     data.isFaceACollision = false;
@@ -30,15 +83,36 @@ std::shared_ptr<Collision> CollisionDetector::Collide(std::shared_ptr<Collider>
     data.minPenDepth = 10000.f;
     data.minEdgeDistance = 10000.f;
 
-    if (this->CheckFaces(data, first, second, true))
+    if (this->CheckFaces(data, viewA, viewB, true))
         return nullptr;
 
-    if (this->CheckFaces(data, second, first, false))
+    if (this->CheckFaces(data, viewB, viewA, false))
         return nullptr;
 
-    if (this->CheckEdges(data, first, second))
+    if (this->CheckEdges(data, viewA, viewB))
         return nullptr;
 
+    if (data.isFaceCollision)
+    {
+        if (data.isFaceACollision)
+        {
+            contactPoints = this->GetContactPoints(data, viewA, viewB);
+            data.collisionAxis = -data.collisionAxis;
+        }
+        else
+            contactPoints = this->GetContactPoints(data, viewB, viewA);
+
+        // the face axis won through the face/edge tolerance but its clipped face misses the reference face,
+        // the colliders meet edge to edge
+        if (contactPoints.empty() && data.bestEdgeA != -1)
+        {
+            data.isFaceCollision = false;
+            data.indexEdgeA = data.bestEdgeA;
+            data.indexEdgeB = data.bestEdgeB;
+            data.minPenDepth = data.bestEdgePenDepth;
+            data.collisionAxis = data.bestEdgeAxis;
+        }
+    }
     if (!data.isFaceCollision)
     {
         // TODO : Refactor this part as the same chunk is present in ShortestDistanceBetweenEdges
@@ -49,85 +123,876 @@ std::shared_ptr<Collision> CollisionDetector::Collide(std::shared_ptr<Collider>
         contactPoints.push_back(this->GetContactBetweenEdges(edgeA, edgeB));
 
         // adjust the direction of the normal.
-        float direction = glm::dot(second->center - first->center, data.collisionAxis);
+        float direction = glm::dot(viewB.center - viewA.center, data.collisionAxis);
         if (direction > 0.f)
             data.collisionAxis = -data.collisionAxis;
     }
-    else
+    // no edge axis to fall back on, the deepest point of the second collider
+    if (contactPoints.empty())
+        contactPoints.push_back(this->GetSupportPoint(pointsB, data.collisionAxis));
+
+    // back to world space
+    glm::vec3 normal = first->orientation * data.collisionAxis;
+    int firstContact = arena.GetContactCount();
+    for (int i = 0; i < contactPoints.size(); i++)
+        arena.AddContact(first->ToWorld(contactPoints[i]), normal, data.minPenDepth);
+    return arena.AddCollision(*first, *second, firstContact);
+}
+
+void CollisionDetector::TransformIntoFrame(Collider& first, Collider& second, glm::quat& relativeOrientation, glm::vec3& relativePosition)
+{
+    // express the second collider in the local frame of the first one.
+    glm::quat inverseA = glm::conjugate(first.orientation);
+    relativeOrientation = inverseA * second.orientation;
+    relativePosition = inverseA * (second.center - first.center);
+
+    const std::vector<glm::vec3>& localPointsB = second.GetPoints();
+    this->transformedPoints.resize(localPointsB.size());
+    for (int i = 0; i < localPointsB.size(); i++)
     {
-        if (data.isFaceACollision)
+        this->transformedPoints[i] = relativeOrientation * localPointsB[i] + relativePosition;
+    }
+}
+
+bool CollisionDetector::Overlap(std::shared_ptr<Collider> first, std::shared_ptr<Collider> second)
+{
+    this->stats.pairsTested++;
+    if (!this->BoundsOverlap(*first, *second))
+    {
+        this->stats.pairsRejectedEarly++;
+        return false;
+    }
+    this->stats.pairsSensor++;
+
+    glm::quat relativeOrientation;
+    glm::vec3 relativePosition;
+    this->TransformIntoFrame(*first, *second, relativeOrientation, relativePosition);
+
+    ColliderView viewA;
+    viewA.points    = &first->GetPoints();
+    viewA.faces     = &first->GetFaces();
+    viewA.edges     = &first->GetEdges();
+    viewA.edgeFaces = &first->GetEdgeFaces();
+    viewA.rotation  = glm::mat3(1.f);
+    viewA.center    = glm::vec3(0.f, 0.f, 0.f);
+
+    ColliderView viewB;
+    viewB.points    = &this->transformedPoints;
+    viewB.faces     = &second->GetFaces();
+    viewB.edges     = &second->GetEdges();
+    viewB.edgeFaces = &second->GetEdgeFaces();
+    viewB.rotation  = glm::mat3_cast(relativeOrientation);
+    viewB.center    = relativePosition;
+
+    SATData data;
+    data.isFaceACollision = false;
+    data.isFaceCollision = false;
+    data.minPenDepth = 10000.f;
+    data.minEdgeDistance = 10000.f;
+
+    // any separating axis is enough, no need to look for the best one
+    return !this->CheckFaces(data, viewA, viewB, true) &&
+           !this->CheckFaces(data, viewB, viewA, false) &&
+           !this->CheckEdges(data, viewA, viewB);
+}
+
+const Collision* CollisionDetector::CollideHeightfield(std::shared_ptr<Collider> collider, Heightfield& heightfield, ContactArena& arena)
+{
+    this->stats.pairsTested++;
+    if (!glm::all(glm::lessThanEqual(collider->aabbMin, heightfield.aabbMax)) || !glm::all(glm::lessThanEqual(heightfield.aabbMin, collider->aabbMax)))
+    {
+        this->stats.pairsRejectedEarly++;
+        return nullptr;
+    }
+    int minRow, maxRow, minCol, maxCol;
+    if (!heightfield.GetCellRange(collider->aabbMin, collider->aabbMax, minRow, maxRow, minCol, maxCol))
+    {
+        this->stats.pairsRejectedEarly++;
+        return nullptr;
+    }
+    this->stats.pairsHeightfield++;
+
+    int firstContact = arena.GetContactCount();
+    // hull points below the triangle under them
+    const std::vector<glm::vec3>& points = collider->GetPoints();
+    for (int i = 0; i < points.size(); i++)
+    {
+        glm::vec3 point = collider->ToWorld(points[i]);
+        float height;
+        glm::vec3 normal;
+        if (!heightfield.GetSurface(point.x, point.z, height, normal))
+            continue;
+        // vertical depth projected on the triangle normal
+        float depth = (height - point.y) * normal.y;
+        if (depth > 0.f)
+            arena.AddContact(point, normal, depth);
+    }
+
+    // terrain samples inside the hull, catches peaks under a large face
+    const std::vector<ColliderFace>& faces = collider->GetFaces();
+    for (int row = minRow; row <= maxRow + 1; row++)
+    {
+        for (int col = minCol; col <= maxCol + 1; col++)
         {
-            contactPoints = this->GetContactPoints(data, first, second);
-            data.collisionAxis = -data.collisionAxis;
+            glm::vec3 sample = heightfield.GetPoint(row, col);
+            if (!glm::all(glm::lessThanEqual(collider->aabbMin, sample)) || !glm::all(glm::lessThanEqual(sample, collider->aabbMax)))
+                continue;
+            glm::vec3 localSample = collider->ToLocal(sample);
+            // distance to the closest face, negative inside
+            float maxDistance = -10000.f;
+            for (int j = 0; j < faces.size() && maxDistance < 0.f; j++)
+            {
+                float distance = glm::dot(faces[j].normal, localSample - points[faces[j].points[0]]);
+                maxDistance = std::max(maxDistance, distance);
+            }
+            if (maxDistance >= 0.f)
+                continue;
+            float height;
+            glm::vec3 normal;
+            heightfield.GetSurface(sample.x, sample.z, height, normal);
+            arena.AddContact(sample, normal, -maxDistance);
         }
-        else
-            contactPoints = this->GetContactPoints(data, second, first);
     }
 
-    assert(contactPoints.size() != 0);
+    return arena.AddCollision(*collider, *heightfield.GetCollider(), firstContact);
+}
 
-    std::vector<Contact> contacts;
-    std::shared_ptr<Collision> collision = std::make_shared<Collision>(first->entityID, first, second->entityID, second, contacts);
-    for (int i = 0; i < contactPoints.size(); i++)
+namespace
+{
+    /**
+    Sutherland-Hodgman against a single plane (keeps the side where dot(normal, p) <= offset), fixed buffers.
+    */
+    int ClipAgainstPlane(const glm::vec3* input, int count, glm::vec3 normal, float offset, glm::vec3* output)
+    {
+        int outputCount = 0;
+        for (int i = 0; i < count; i++)
+        {
+            glm::vec3 v1 = input[i];
+            glm::vec3 v2 = input[(i + 1) % count];
+            float d1 = glm::dot(normal, v1) - offset;
+            float d2 = glm::dot(normal, v2) - offset;
+            if (d1 <= 0.f)
+                output[outputCount++] = v1;
+            if ((d1 < 0.f && d2 > 0.f) || (d1 > 0.f && d2 < 0.f))
+                output[outputCount++] = v1 + (d1 / (d1 - d2)) * (v2 - v1);
+        }
+        return outputCount;
+    }
+}
+
+const Collision* CollisionDetector::CollideMesh(std::shared_ptr<Collider> collider, TriangleMesh& mesh, ContactArena& arena)
+{
+    this->stats.pairsTested++;
+    this->meshTriangles.clear();
+    if (glm::all(glm::lessThanEqual(collider->aabbMin, mesh.aabbMax)) && glm::all(glm::lessThanEqual(mesh.aabbMin, collider->aabbMax)))
+        mesh.Query(collider->aabbMin, collider->aabbMax, this->meshTriangles);
+    if (this->meshTriangles.empty())
+    {
+        this->stats.pairsRejectedEarly++;
+        return nullptr;
+    }
+    this->stats.pairsMesh++;
+
+    // EPA normals this close to the triangle normal are face contacts
+    float faceContactCosine = 0.95f;
+    int firstContact = arena.GetContactCount();
+    const std::vector<glm::vec3>& points = collider->GetPoints();
+    this->queryPoints.resize(3);
+    for (int i = 0; i < this->meshTriangles.size(); i++)
+    {
+        glm::vec3 a, b, c;
+        mesh.GetTriangle(this->meshTriangles[i], a, b, c);
+        this->queryPoints[0] = collider->ToLocal(a);
+        this->queryPoints[1] = collider->ToLocal(b);
+        this->queryPoints[2] = collider->ToLocal(c);
+        GJKResult result;
+        if (!this->gjk.Query(points, this->queryPoints, result))
+            continue;
+        if (!this->gjk.Penetration(points, this->queryPoints, result) || result.depth <= 0.f)
+            continue;
+
+        // when EPA pushes out along the triangle face, clip the incident hull face against the triangle
+        // sides like the face/face case of SAT, a single midpoint per triangle lets boxes rock on the floor
+        glm::vec3 triangleNormal = glm::cross(this->queryPoints[1] - this->queryPoints[0], this->queryPoints[2] - this->queryPoints[0]);
+        float length = glm::length(triangleNormal);
+        if (length > 0.f)
+        {
+            triangleNormal = triangleNormal / length;
+            if (glm::dot(triangleNormal, result.normal) > 0.f)
+                triangleNormal = -triangleNormal;
+        }
+        if (length > 0.f && -glm::dot(triangleNormal, result.normal) > faceContactCosine)
+        {
+            int contactCount = this->ClipAgainstTriangle(*collider, triangleNormal);
+            glm::vec3 normal = collider->orientation * triangleNormal;
+            for (int j = 0; j < contactCount; j++)
+            {
+                float depth = glm::dot(triangleNormal, this->queryPoints[0] - this->clipPoints[j]);
+                arena.AddContact(collider->ToWorld(this->clipPoints[j]), normal, depth);
+            }
+            if (contactCount > 0)
+                continue;
+        }
+
+        // same convention as CollideGJK, the normal points from the triangle to the collider
+        glm::vec3 point = collider->ToWorld(0.5f * (result.closestA + result.closestB));
+        glm::vec3 normal = collider->orientation * -result.normal;
+        arena.AddContact(point, normal, result.depth);
+    }
+
+    return arena.AddCollision(*collider, *mesh.GetCollider(), firstContact);
+}
+
+int CollisionDetector::ClipAgainstTriangle(Collider& collider, glm::vec3 normal)
+{
+    // incident face - the one most anti parallel to the triangle normal
+    const std::vector<glm::vec3>& points = collider.GetPoints();
+    const std::vector<ColliderFace>& faces = collider.GetFaces();
+    int incident = 0;
+    float minCosine = 1.f;
+    for (int i = 0; i < faces.size(); i++)
+    {
+        float cosine = glm::dot(faces[i].normal, normal);
+        if (cosine < minCosine)
+        {
+            minCosine = cosine;
+            incident = i;
+        }
+    }
+
+    // every side plane adds at most one point to a convex polygon
+    int count = faces[incident].points.size();
+    this->clipPoints.resize(count + 3);
+    this->clipScratch.resize(count + 3);
+    for (int i = 0; i < count; i++)
+        this->clipPoints[i] = points[faces[incident].points[i]];
+
+    const glm::vec3* triangle = this->queryPoints.data();
+    for (int i = 0; i < 3 && count > 0; i++)
     {
-        glm::vec3 point = contactPoints[i];
-        Contact contact = Contact(point, data.collisionAxis, data.minPenDepth);
-        collision->contacts.push_back(contact);
+        glm::vec3 side = glm::cross(triangle[(i + 1) % 3] - triangle[i], normal);
+        // outward, away from the opposite corner
+        if (glm::dot(side, triangle[(i + 2) % 3] - triangle[i]) > 0.f)
+            side = -side;
+        count = ClipAgainstPlane(this->clipPoints.data(), count, side, glm::dot(side, triangle[i]), this->clipScratch.data());
+        std::swap(this->clipPoints, this->clipScratch);
     }
-    return collision;
+
+    // keep the points below the triangle
+    float offset = glm::dot(normal, triangle[0]);
+    int contactCount = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (glm::dot(normal, this->clipPoints[i]) < offset)
+            this->clipPoints[contactCount++] = this->clipPoints[i];
+    }
+    return contactCount;
 }
 
-bool CollisionDetector::CheckFaces(SATData& data, std::shared_ptr<Collider> first, std::shared_ptr<Collider> second, bool isFaceA)
+NarrowphaseType CollisionDetector::SelectNarrowphase(Collider& first, Collider& second)
 {
+    // rough count of the axes SAT has to test, before any pruning
+    int satAxes = first.GetFaces().size() + second.GetFaces().size() + first.GetEdges().size() * second.GetEdges().size();
+    if (satAxes > this->gjkThreshold)
+        return NarrowphaseType::GJKNarrowphase;
+    if (this->useBoxNarrowphase && first.GetHull()->isBox && second.GetHull()->isBox)
+        return NarrowphaseType::BoxNarrowphase;
+    return NarrowphaseType::SATNarrowphase;
+}
 
+bool CollisionDetector::CollideGJK(std::shared_ptr<Collider> first, std::shared_ptr<Collider> second, ContactArena& arena, const Collision*& collision)
+{
+    collision = nullptr;
+    GJKResult result;
     const std::vector<glm::vec3>& pointsA = first->GetPoints();
-    const std::vector<glm::vec3>& pointsB = second->GetPoints();
-    const std::vector<ColliderFace>& faces = first->GetFaces();
+    if (!this->gjk.Query(pointsA, this->transformedPoints, result))
+        return true;
+    // could not build a polytope, let SAT handle the pair
+    if (!this->gjk.Penetration(pointsA, this->transformedPoints, result))
+        return false;
+    if (result.depth <= 0.f)
+        return true;
+
+    // EPA gives a single contact between the two witness points, normal points from second to first
+    glm::vec3 point = first->ToWorld(0.5f * (result.closestA + result.closestB));
+    glm::vec3 normal = first->orientation * -result.normal;
+    int firstContact = arena.GetContactCount();
+    arena.AddContact(point, normal, result.depth);
+    collision = arena.AddCollision(*first, *second, firstContact);
+    return true;
+}
+
+namespace
+{
+    /**
+    Corners of the face of the box with the outward normal sign * axes[axis], in winding order.
+    */
+    void GetBoxFace(const BoxView& box, int axis, float sign, glm::vec3* corners)
+    {
+        glm::vec3 u = box.axes[(axis + 1) % 3] * box.halfExtents[(axis + 1) % 3];
+        glm::vec3 v = box.axes[(axis + 2) % 3] * box.halfExtents[(axis + 2) % 3];
+        glm::vec3 faceCenter = box.center + box.axes[axis] * (sign * box.halfExtents[axis]);
+        corners[0] = faceCenter + u + v;
+        corners[1] = faceCenter - u + v;
+        corners[2] = faceCenter - u - v;
+        corners[3] = faceCenter + u - v;
+    }
+
+    /**
+    Edge of the box parallel to axes[axis] that is farthest along direction.
+    */
+    std::pair<glm::vec3, glm::vec3> GetBoxEdge(const BoxView& box, int axis, glm::vec3 direction)
+    {
+        glm::vec3 point = box.center;
+        for (int k = 0; k < 3; k++)
+        {
+            if (k == axis)
+                continue;
+            float sign = glm::dot(box.axes[k], direction) >= 0.f ? 1.f : -1.f;
+            point += box.axes[k] * (sign * box.halfExtents[k]);
+        }
+        glm::vec3 half = box.axes[axis] * box.halfExtents[axis];
+        return std::make_pair(point - half, point + half);
+    }
+
+    /**
+    Corner of the box farthest along direction.
+    */
+    glm::vec3 GetBoxSupport(const BoxView& box, glm::vec3 direction)
+    {
+        glm::vec3 point = box.center;
+        for (int k = 0; k < 3; k++)
+        {
+            float sign = glm::dot(box.axes[k], direction) >= 0.f ? 1.f : -1.f;
+            point += box.axes[k] * (sign * box.halfExtents[k]);
+        }
+        return point;
+    }
+
+    /**
+    Clips the incident box face against the reference face side planes and keeps the points below the reference face.
+    normal is the outward normal of the reference face. Returns the number of contacts written.
+    */
+    int GetBoxContacts(const BoxView& reference, int axis, glm::vec3 normal, const BoxView& incident, glm::vec3* contacts)
+    {
+        // incident face - the one most anti parallel to the reference normal
+        int incidentAxis = 0;
+        float maxCosine = -1.f;
+        for (int k = 0; k < 3; k++)
+        {
+            float cosine = std::abs(glm::dot(incident.axes[k], normal));
+            if (cosine > maxCosine)
+            {
+                maxCosine = cosine;
+                incidentAxis = k;
+            }
+        }
+        float incidentSign = glm::dot(incident.axes[incidentAxis], normal) > 0.f ? -1.f : 1.f;
 
-    glm::vec3 centerDir = second->center - first->center;
+        glm::vec3 bufferA[8];
+        glm::vec3 bufferB[8];
+        GetBoxFace(incident, incidentAxis, incidentSign, bufferA);
+        int count = 4;
+
+        glm::vec3* input = bufferA;
+        glm::vec3* output = bufferB;
+        for (int k = 1; k < 3 && count > 0; k++)
+        {
+            glm::vec3 side = reference.axes[(axis + k) % 3];
+            float extent = reference.halfExtents[(axis + k) % 3];
+            float offset = glm::dot(side, reference.center);
+            count = ClipAgainstPlane(input, count, side, offset + extent, output);
+            std::swap(input, output);
+            count = ClipAgainstPlane(input, count, -side, -offset + extent, output);
+            std::swap(input, output);
+        }
+
+        float faceOffset = glm::dot(normal, reference.center) + std::abs(glm::dot(normal * reference.halfExtents[axis], reference.axes[axis]));
+        int contactCount = 0;
+        for (int i = 0; i < count; i++)
+        {
+            if (glm::dot(normal, input[i]) <= faceOffset)
+                contacts[contactCount++] = input[i];
+        }
+        return contactCount;
+    }
+}
+
+const Collision* CollisionDetector::CollideBoxes(std::shared_ptr<Collider> first, std::shared_ptr<Collider> second, ContactArena& arena)
+{
+    const Hull& hullA = *first->GetHull();
+    const Hull& hullB = *second->GetHull();
+
+    // B in the local frame of A, same working frame as the generic SAT
+    glm::quat inverseA = glm::conjugate(first->orientation);
+    glm::quat relativeOrientation = inverseA * second->orientation;
+    glm::vec3 relativePosition = inverseA * (second->center - first->center);
+
+    BoxView boxA;
+    boxA.center = hullA.boxCenter;
+    boxA.axes = hullA.boxAxes;
+    boxA.halfExtents = hullA.boxHalfExtents;
+
+    BoxView boxB;
+    boxB.center = relativeOrientation * hullB.boxCenter + relativePosition;
+    boxB.axes = glm::mat3_cast(relativeOrientation) * hullB.boxAxes;
+    boxB.halfExtents = hullB.boxHalfExtents;
+
+    const glm::vec3& a = boxA.halfExtents;
+    const glm::vec3& b = boxB.halfExtents;
+    glm::vec3 t = boxB.center - boxA.center;
+
+    // rotation of B relative to A
+    float absR[3][3];
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            absR[i][j] = std::abs(glm::dot(boxA.axes[i], boxB.axes[j]));
+        }
+    }
+
+    // 0 - face of A, 1 - face of B, 2 - edge/edge. Same preferences as the generic SAT:
+    // later faces win ties, edges have to be better than the faces by faceEdgeTolerance.
+    int         type = -1;
+    int         indexA = 0;
+    int         indexB = 0;
+    float       minPenDepth = 10000.f;
+    glm::vec3   axis;
+    float       faceEdgeTolerance = 0.005f;
+    // deepest edge/edge axis whatever the faces do, for when the face clipping finds nothing
+    int         edgeIndexA = -1;
+    int         edgeIndexB = -1;
+    float       edgePenDepth = 10000.f;
+    glm::vec3   edgeAxis;
+
+    for (int i = 0; i < 3; i++)
+    {
+        float distance = glm::dot(t, boxA.axes[i]);
+        float rB = b.x * absR[i][0] + b.y * absR[i][1] + b.z * absR[i][2];
+        float penDepth = a[i] + rB - std::abs(distance);
+        if (penDepth < 0.f)
+            return nullptr;
+        if (penDepth <= minPenDepth)
+        {
+            type = 0;
+            indexA = i;
+            minPenDepth = penDepth;
+            axis = distance >= 0.f ? boxA.axes[i] : -boxA.axes[i];
+        }
+    }
+    for (int j = 0; j < 3; j++)
+    {
+        float distance = glm::dot(t, boxB.axes[j]);
+        float rA = a.x * absR[0][j] + a.y * absR[1][j] + a.z * absR[2][j];
+        float penDepth = rA + b[j] - std::abs(distance);
+        if (penDepth < 0.f)
+            return nullptr;
+        if (penDepth <= minPenDepth)
+        {
+            type = 1;
+            indexB = j;
+            minPenDepth = penDepth;
+            // B's face normal pointing towards A
+            axis = distance >= 0.f ? -boxB.axes[j] : boxB.axes[j];
+        }
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            glm::vec3 cross = glm::cross(boxA.axes[i], boxB.axes[j]);
+            // parallel edges, already covered by the face axes
+            if (glm::length2(cross) < 0.005f)
+                continue;
+            cross = glm::normalize(cross);
+            float rA = 0.f;
+            float rB = 0.f;
+            for (int k = 0; k < 3; k++)
+            {
+                rA += a[k] * std::abs(glm::dot(boxA.axes[k], cross));
+                rB += b[k] * std::abs(glm::dot(boxB.axes[k], cross));
+            }
+            float distance = glm::dot(t, cross);
+            float penDepth = rA + rB - std::abs(distance);
+            if (penDepth < 0.f)
+                return nullptr;
+            if (penDepth < edgePenDepth)
+            {
+                edgeIndexA = i;
+                edgeIndexB = j;
+                edgePenDepth = penDepth;
+                edgeAxis = distance >= 0.f ? cross : -cross;
+            }
+            if (penDepth + faceEdgeTolerance < minPenDepth)
+            {
+                type = 2;
+                indexA = i;
+                indexB = j;
+                minPenDepth = penDepth;
+                axis = distance >= 0.f ? cross : -cross;
+            }
+        }
+    }
+
+    // normal points from the second collider towards the first one
+    glm::vec3   normal;
+    glm::vec3   contactPoints[8];
+    int         contactCount = 0;
+    if (type == 0)
+    {
+        contactCount = GetBoxContacts(boxA, indexA, axis, boxB, contactPoints);
+        normal = -axis;
+    }
+    else if (type == 1)
+    {
+        contactCount = GetBoxContacts(boxB, indexB, axis, boxA, contactPoints);
+        normal = axis;
+    }
+    // a face axis can win through faceEdgeTolerance while the clipped incident face misses the
+    // reference face entirely, the boxes then meet edge to edge
+    if (contactCount == 0 && edgeIndexA != -1)
+    {
+        type = 2;
+        indexA = edgeIndexA;
+        indexB = edgeIndexB;
+        minPenDepth = edgePenDepth;
+        axis = edgeAxis;
+    }
+    if (type == 2)
+    {
+        std::pair<glm::vec3, glm::vec3> edgeA = GetBoxEdge(boxA, indexA, axis);
+        std::pair<glm::vec3, glm::vec3> edgeB = GetBoxEdge(boxB, indexB, -axis);
+        contactPoints[contactCount++] = this->GetContactBetweenEdges(edgeA, edgeB);
+        normal = -axis;
+    }
+    // every edge pair parallel, the deepest corner of the second box
+    if (contactCount == 0)
+        contactPoints[contactCount++] = GetBoxSupport(boxB, normal);
+
+    // back to world space
+    normal = first->orientation * normal;
+    int firstContact = arena.GetContactCount();
+    for (int i = 0; i < contactCount; i++)
+    {
+        arena.AddContact(first->ToWorld(contactPoints[i]), normal, minPenDepth);
+    }
+    return arena.AddCollision(*first, *second, firstContact);
+}
+
+float CollisionDetector::Distance(std::shared_ptr<Collider> first, std::shared_ptr<Collider> second, glm::vec3& closestFirst, glm::vec3& closestSecond)
+{
+    glm::quat relativeOrientation;
+    glm::vec3 relativePosition;
+    this->TransformIntoFrame(*first, *second, relativeOrientation, relativePosition);
+
+    GJKResult result;
+    this->gjk.Query(first->GetPoints(), this->transformedPoints, result);
+    closestFirst = first->ToWorld(result.closestA);
+    closestSecond = first->ToWorld(result.closestB);
+    return result.distance;
+}
+
+bool CollisionDetector::TimeOfImpact(   std::shared_ptr<Collider> moving,
+                                        glm::vec3 startPosition,
+                                        glm::quat startOrientation,
+                                        glm::vec3 endPosition,
+                                        glm::quat endOrientation,
+                                        std::shared_ptr<Collider> target,
+                                        float& toi)
+{
+    return this->Advance(moving, startPosition, startOrientation, endPosition, endOrientation, target, nullptr, toi);
+}
+
+bool CollisionDetector::TimeOfImpact(   std::shared_ptr<Collider> moving,
+                                        glm::vec3 startPosition,
+                                        glm::quat startOrientation,
+                                        glm::vec3 endPosition,
+                                        glm::quat endOrientation,
+                                        glm::vec3 a,
+                                        glm::vec3 b,
+                                        glm::vec3 c,
+                                        float& toi)
+{
+    glm::vec3 triangle[3] = {a, b, c};
+    return this->Advance(moving, startPosition, startOrientation, endPosition, endOrientation, nullptr, triangle, toi);
+}
+
+bool CollisionDetector::Advance(std::shared_ptr<Collider> moving,
+                                glm::vec3 startPosition,
+                                glm::quat startOrientation,
+                                glm::vec3 endPosition,
+                                glm::quat endOrientation,
+                                std::shared_ptr<Collider> target,
+                                const glm::vec3* triangle,
+                                float& toi)
+{
+    // upper bound of how fast any point of the collider moves towards the target, per unit of t.
+    // translation plus rotation angle times the farthest the collider reaches from the body origin.
+    moving->Update(endPosition, endOrientation);
+    float reach = glm::length(moving->center - endPosition) + moving->radius;
+    float cosine = std::min(std::abs(glm::dot(glm::normalize(startOrientation), glm::normalize(endOrientation))), 1.f);
+    float angle = 2.f * acosf(cosine);
+    float maxSpeed = glm::length(endPosition - startPosition) + angle * reach;
+
+    bool isHit = false;
+    float t = 0.f;
+    for (int i = 0; i < this->toiMaxIterations; i++)
+    {
+        moving->Update(glm::mix(startPosition, endPosition, t), nlerp(startOrientation, endOrientation, t));
+        // the target in the frame of the moving collider
+        const std::vector<glm::vec3>* targetPoints = &this->queryPoints;
+        if (target != nullptr)
+        {
+            glm::quat relativeOrientation;
+            glm::vec3 relativePosition;
+            this->TransformIntoFrame(*moving, *target, relativeOrientation, relativePosition);
+            targetPoints = &this->transformedPoints;
+        }
+        else
+        {
+            // like CollideMesh
+            this->queryPoints.resize(3);
+            for (int j = 0; j < 3; j++)
+                this->queryPoints[j] = moving->ToLocal(triangle[j]);
+        }
+        GJKResult result;
+        bool isIntersecting = this->gjk.Query(moving->GetPoints(), *targetPoints, result);
+        float distance = isIntersecting ? 0.f : result.distance;
+        if (distance <= this->toiTolerance)
+        {
+            if (i > 0)
+            {
+                isHit = true;
+                break;
+            }
+            // touching at the start, e.g. resting on the floor or placed past an impact by the last sweep.
+            // Only a motion into the target is a hit, sliding along it or leaving it is left to the discrete pass.
+            glm::vec3 separation = result.closestA - result.closestB;
+            if (isIntersecting)
+                separation = this->gjk.Penetration(moving->GetPoints(), *targetPoints, result) ? -result.normal : glm::vec3(0.f);
+            if (glm::length2(separation) < 1e-12f)
+            {
+                // flat target EPA could not handle, from its centroid to the moving collider instead
+                glm::vec3 centroid(0.f);
+                for (int j = 0; j < targetPoints->size(); j++)
+                    centroid += (*targetPoints)[j];
+                separation = moving->ToLocal(moving->center) - centroid / (float)targetPoints->size();
+            }
+            isHit = glm::dot(moving->orientation * separation, endPosition - startPosition) < 0.f;
+            break;
+        }
+        if (maxSpeed <= 0.f)
+            break;
+        // no point can cover the distance sooner than this
+        t += distance / maxSpeed;
+        if (t > 1.f)
+            break;
+    }
+    moving->Update(endPosition, endOrientation);
+    toi = t;
+    return isHit;
+}
+
+bool CollisionDetector::Raycast(Collider& collider, glm::vec3 origin, glm::vec3 direction, float maxDistance, QueryHit& hit)
+{
+    // work in the local frame of the hull, the faces are used as they are
+    glm::vec3 localOrigin = collider.ToLocal(origin);
+    glm::vec3 localDirection = glm::conjugate(collider.orientation) * direction;
+    const std::vector<glm::vec3>& points = collider.GetPoints();
+    const std::vector<ColliderFace>& faces = collider.GetFaces();
+
+    float tEnter = 0.f;
+    float tExit = maxDistance;
+    int enterFace = -1;
+    for (int i = 0; i < faces.size(); i++)
+    {
+        glm::vec3 normal = faces[i].normal;
+        // positive while the origin is behind the face plane
+        float distance = glm::dot(normal, points[faces[i].points[0]] - localOrigin);
+        float denominator = glm::dot(normal, localDirection);
+        if (std::abs(denominator) < 1e-8f)
+        {
+            // parallel to the face and in front of it
+            if (distance < 0.f)
+                return false;
+            continue;
+        }
+        float t = distance / denominator;
+        if (denominator < 0.f)
+        {
+            if (t > tEnter)
+            {
+                tEnter = t;
+                enterFace = i;
+            }
+        }
+        else
+            tExit = std::min(tExit, t);
+        if (tEnter > tExit)
+            return false;
+    }
+
+    hit.collider = &collider;
+    hit.entityID = collider.entityID;
+    hit.distance = tEnter;
+    hit.point = origin + direction * tEnter;
+    hit.normal = enterFace == -1 ? -direction : collider.orientation * faces[enterFace].normal;
+    return true;
+}
+
+bool CollisionDetector::SphereCast(Collider& collider, glm::vec3 origin, glm::vec3 direction, float radius, float maxDistance, QueryHit& hit)
+{
+    glm::vec3 localOrigin = collider.ToLocal(origin);
+    glm::vec3 localDirection = glm::conjugate(collider.orientation) * direction;
+    const std::vector<glm::vec3>& points = collider.GetPoints();
+    this->queryPoints.resize(1);
+
+    GJKResult result;
+    float t = 0.f;
+    for (int i = 0; i < this->toiMaxIterations; i++)
+    {
+        this->queryPoints[0] = localOrigin + localDirection * t;
+        bool isIntersecting = this->gjk.Query(points, this->queryPoints, result);
+        float distance = isIntersecting ? 0.f : result.distance - radius;
+        if (distance <= this->toiTolerance)
+        {
+            hit.collider = &collider;
+            hit.entityID = collider.entityID;
+            hit.distance = t;
+            if (isIntersecting || result.distance < 1e-6f)
+            {
+                // the center is inside the hull, there is no separating direction
+                hit.point = origin + direction * t;
+                hit.normal = -direction;
+            }
+            else
+            {
+                hit.point = collider.ToWorld(result.closestA);
+                hit.normal = collider.orientation * glm::normalize(result.closestB - result.closestA);
+            }
+            return true;
+        }
+        // the sphere can move this far without touching the hull
+        t += distance;
+        if (t > maxDistance)
+            return false;
+    }
+    return false;
+}
+
+bool CollisionDetector::OverlapBox(Collider& collider, glm::vec3 center, glm::vec3 halfExtents, glm::quat orientation)
+{
+    glm::vec3 localCenter = collider.ToLocal(center);
+    glm::quat localOrientation = glm::conjugate(collider.orientation) * orientation;
+    this->queryPoints.resize(8);
+    for (int i = 0; i < 8; i++)
+    {
+        glm::vec3 corner = glm::vec3(i & 1 ? halfExtents.x : -halfExtents.x, i & 2 ? halfExtents.y : -halfExtents.y, i & 4 ? halfExtents.z : -halfExtents.z);
+        this->queryPoints[i] = localCenter + localOrientation * corner;
+    }
+    GJKResult result;
+    return this->gjk.Query(collider.GetPoints(), this->queryPoints, result);
+}
+
+bool CollisionDetector::BoundsOverlap(const Collider& first, const Collider& second)
+{
+    glm::vec3 centerDiff = second.center - first.center;
+    float radiusSum = first.radius + second.radius;
+    if (glm::dot(centerDiff, centerDiff) > radiusSum * radiusSum)
+        return false;
+    // component-wise compares, no branches until the final reduction
+    glm::bvec3 minOk = glm::lessThanEqual(first.aabbMin, second.aabbMax);
+    glm::bvec3 maxOk = glm::lessThanEqual(second.aabbMin, first.aabbMax);
+    return glm::all(minOk) && glm::all(maxOk);
+}
+
+const CollisionStats& CollisionDetector::GetStats()
+{
+    return this->stats;
+}
+
+void CollisionDetector::ResetStats()
+{
+    this->stats = CollisionStats();
+}
+
+bool CollisionDetector::CheckFaces(SATData& data, const ColliderView& first, const ColliderView& second, bool isFaceA)
+{
+
+    const std::vector<glm::vec3>& pointsA = *first.points;
+    const std::vector<glm::vec3>& pointsB = *second.points;
+    const std::vector<ColliderFace>& faces = *first.faces;
+
+    glm::vec3 centerDir = second.center - first.center;
 
     float currPenDepth = 0.f;
     for (int i = 0; i < faces.size(); i++)
     {
-        if (this->IsSeparatingAxis(faces[i].normal, pointsA, pointsB, currPenDepth))
+        glm::vec3 normal = first.rotation * faces[i].normal;
+        if (this->IsSeparatingAxis(normal, pointsA, pointsB, currPenDepth))
         {
             return true;
         }
-        float sameDirAsCenters = glm::dot(centerDir, faces[i].normal);
+        float sameDirAsCenters = glm::dot(centerDir, normal);
         if (currPenDepth <= data.minPenDepth && sameDirAsCenters >= 0.f)
         {
             data.indexFace = i;
             data.isFaceACollision = isFaceA;
             data.isFaceCollision = true;
-            data.collisionAxis = faces[i].normal;
+            data.collisionAxis = normal;
             data.minPenDepth = currPenDepth;
         }
     }
     return false;
 }
 
-bool CollisionDetector::CheckEdges(SATData& data, std::shared_ptr<Collider> first, std::shared_ptr<Collider> second)
+bool CollisionDetector::CheckEdges(SATData& data, const ColliderView& first, const ColliderView& second)
 {
-    const std::vector<glm::vec3>&           pointsA = first->GetPoints();
-    const std::vector<std::pair<int, int>>& edgesA  = first->GetEdges();
+    const std::vector<glm::vec3>&           pointsA = *first.points;
+    const std::vector<std::pair<int, int>>& edgesA  = *first.edges;
 
-    const std::vector<glm::vec3>&           pointsB = second->GetPoints();
-    const std::vector<std::pair<int, int>>& edgesB  = first->GetEdges();
+    const std::vector<glm::vec3>&           pointsB = *second.points;
+    const std::vector<std::pair<int, int>>& edgesB  = *second.edges;
+
+    const std::vector<ColliderFace>&        facesA  = *first.faces;
+    const std::vector<ColliderFace>&        facesB  = *second.faces;
+    const std::vector<std::pair<int, int>>& edgeFacesA = *first.edgeFaces;
+    const std::vector<std::pair<int, int>>& edgeFacesB = *second.edgeFaces;
 
     float faceEdgeTolerance = 0.005f;
     float currPenDepth = 0.f;
     for (int i = 0; i < edgesA.size(); i++)
     {
+        glm::vec3 edgeA = pointsA[edgesA[i].second] - pointsA[edgesA[i].first];
+        bool hasFacesA = edgeFacesA[i].first != -1 && edgeFacesA[i].second != -1;
+        glm::vec3 normalA1, normalA2;
+        if (hasFacesA)
+        {
+            normalA1 = first.rotation * facesA[edgeFacesA[i].first].normal;
+            normalA2 = first.rotation * facesA[edgeFacesA[i].second].normal;
+        }
         for (int j = 0; j < edgesB.size(); j++)
         {
+            // Gauss map pruning - only edges whose arcs intersect build a face of the Minkowski difference.
+            bool hasFacesB = edgeFacesB[j].first != -1 && edgeFacesB[j].second != -1;
+            if (hasFacesA && hasFacesB)
+            {
+                glm::vec3 normalB1 = second.rotation * facesB[edgeFacesB[j].first].normal;
+                glm::vec3 normalB2 = second.rotation * facesB[edgeFacesB[j].second].normal;
+                if (!this->IsMinkowskiFace(normalA1, normalA2, -normalB1, -normalB2))
+                    continue;
+            }
+
             // take the cross
-            glm::vec3 edgeA = pointsA[edgesA[i].second] - pointsA[edgesA[i].first];
             glm::vec3 edgeB = pointsB[edgesB[j].second] - pointsB[edgesB[j].first];
-            glm::vec3 possibleCollisionAxis = glm::normalize(glm::cross(edgeA, edgeB));
+            glm::vec3 possibleCollisionAxis = glm::cross(edgeA, edgeB);
             bool isMin = false;
 
-            if (glm::length2(possibleCollisionAxis) < 0.005f)
+            // parallel edges
+            if (glm::length2(possibleCollisionAxis) < 0.005f * glm::length2(edgeA) * glm::length2(edgeB))
                 continue;
+            possibleCollisionAxis = glm::normalize(possibleCollisionAxis);
 
             // SAT check
             if (this->IsSeparatingAxis(possibleCollisionAxis, pointsA, pointsB, currPenDepth))
@@ -135,6 +1000,14 @@ bool CollisionDetector::CheckEdges(SATData& data, std::shared_ptr<Collider> firs
                 return true;
             }
 
+            if (currPenDepth < data.bestEdgePenDepth)
+            {
+                data.bestEdgeA = i;
+                data.bestEdgeB = j;
+                data.bestEdgePenDepth = currPenDepth;
+                data.bestEdgeAxis = possibleCollisionAxis;
+            }
+
             std::pair<glm::vec3, glm::vec3> e1 = std::make_pair(pointsA[edgesA[i].first], pointsA[edgesA[i].second]);
             std::pair<glm::vec3, glm::vec3> e2 = std::make_pair(pointsB[edgesB[j].first], pointsB[edgesB[j].second]);
             float currMinDistance = this->GetMinDistanceBetweenEdges(e1, e2);
@@ -165,6 +1038,19 @@ bool CollisionDetector::CheckEdges(SATData& data, std::shared_ptr<Collider> firs
     return false;
 }
 
+bool CollisionDetector::IsMinkowskiFace(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d)
+{
+    // arcs AB and CD on the unit sphere intersect if C and D are on different sides of the plane
+    // through AB, A and B are on different sides of the plane through CD, and both arcs lie in the same hemisphere.
+    glm::vec3 bCrossA = glm::cross(b, a);
+    glm::vec3 dCrossC = glm::cross(d, c);
+    float cba = glm::dot(c, bCrossA);
+    float dba = glm::dot(d, bCrossA);
+    float adc = glm::dot(a, dCrossC);
+    float bdc = glm::dot(b, dCrossC);
+    return cba * dba < 0.f && adc * bdc < 0.f && cba * bdc > 0.f;
+}
+
 bool CollisionDetector::IsSeparatingAxis(glm::vec3 direction,
                                         const std::vector<glm::vec3>& pointsA,
                                         const std::vector<glm::vec3>& pointsB,
@@ -299,18 +1185,18 @@ float CollisionDetector::GetMinDistanceBetweenEdges(const std::pair<glm::vec3, g
     return glm::length2(result);
 }
 
-std::vector<glm::vec3> CollisionDetector::GetContactPoints(SATData& data, std::shared_ptr<Collider> first, std::shared_ptr<Collider> second)
+std::vector<glm::vec3> CollisionDetector::GetContactPoints(SATData& data, const ColliderView& first, const ColliderView& second)
 {
-    const std::vector<ColliderFace>& incidentFaces = second->GetFaces();
-    const std::vector<glm::vec3>& incidentPoints = second->GetPoints();
+    const std::vector<ColliderFace>& incidentFaces = *second.faces;
+    const std::vector<glm::vec3>& incidentPoints = *second.points;
 
-    const std::vector<glm::vec3>& referencePoints = first->GetPoints();
+    const std::vector<glm::vec3>& referencePoints = *first.points;
 
     float min = 10000.f;
     int index = -1;
     for (int i = 0; i < incidentFaces.size(); i++)
     {
-        float currentMin = glm::dot(data.collisionAxis, incidentFaces[i].normal);
+        float currentMin = glm::dot(data.collisionAxis, second.rotation * incidentFaces[i].normal);
         if (currentMin < min)
         {
             min = currentMin;
@@ -328,15 +1214,16 @@ std::vector<glm::vec3> CollisionDetector::GetContactPoints(SATData& data, std::s
 
     // create faces to clip against
     std::vector<std::pair<glm::vec3, glm::vec3>> sideFaces;
-    const ColliderFace& referenceFace = first->GetFaces()[data.indexFace];
+    const ColliderFace& referenceFace = (*first.faces)[data.indexFace];
+    glm::vec3 referenceNormal = first.rotation * referenceFace.normal;
     int count = referenceFace.points.size();
     for (int i = 0; i < referenceFace.points.size(); i++)
     {
         int v1 = referenceFace.points[i];
         int v2 = referenceFace.points[(i + 1) % count];
         glm::vec3 edge = referencePoints[v2] - referencePoints[v1];
-        glm::vec3 normal = glm::normalize(glm::cross( referenceFace.normal, edge));
-        if (glm::dot(referencePoints[v1] - first->center, normal) < 0.f)
+        glm::vec3 normal = glm::normalize(glm::cross( referenceNormal, edge));
+        if (glm::dot(referencePoints[v1] - first.center, normal) < 0.f)
             normal = -normal;
         sideFaces.push_back(std::make_pair(normal, referencePoints[v1]));
     }
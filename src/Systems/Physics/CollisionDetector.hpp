@@ -2,8 +2,13 @@
 
 #include <memory>
 #include <vector>
+#include <cstdint>
 
+#include "GJK.hpp"
+#include "Query.hpp"
 #include "Collision.hpp"
+#include "Heightfield.hpp"
+#include "TriangleMesh.hpp"
 
 #include "Collider.hpp"
 
@@ -18,26 +23,207 @@ class SATData
         float       minPenDepth;
         float       minEdgeDistance;
         glm::vec3   collisionAxis;
+        // deepest edge/edge axis regardless of the face preference, used when the face clipping finds no point
+        int         bestEdgeA = -1;
+        int         bestEdgeB = -1;
+        float       bestEdgePenDepth = 10000.f;
+        glm::vec3   bestEdgeAxis;
+};
+
+/**
+CollisionStats - counters of the work done by the narrowphase since the last reset.
+ */
+struct CollisionStats
+{
+    std::uint64_t pairsTested       = 0;
+    // rejected by the bounding sphere / AABB check
+    std::uint64_t pairsRejectedEarly = 0;
+    // went through the full SAT test
+    std::uint64_t pairsFullSAT      = 0;
+    // sent to GJK/EPA by the narrowphase policy
+    std::uint64_t pairsGJK          = 0;
+    // box/box pairs handled by the 15 axis box test
+    std::uint64_t pairsBox          = 0;
+    // skipped by the layer/mask filter, never reach Collide
+    std::uint64_t pairsFiltered     = 0;
+    // sensor pairs, boolean overlap test only
+    std::uint64_t pairsSensor       = 0;
+    // collider/terrain pairs tested against the heightfield triangles
+    std::uint64_t pairsHeightfield  = 0;
+    // collider/mesh pairs with at least one triangle under the collider bounds
+    std::uint64_t pairsMesh         = 0;
+};
+
+enum NarrowphaseType
+{
+    SATNarrowphase,
+    GJKNarrowphase,
+    BoxNarrowphase
+};
+
+/**
+ColliderView - the geometry of a collider expressed in the frame the narrowphase works in.
+The first collider of a pair is used in its own local frame, the second one is transformed into it.
+ */
+struct ColliderView
+{
+    const std::vector<glm::vec3>*           points;
+    const std::vector<ColliderFace>*        faces;
+    const std::vector<std::pair<int, int>>* edges;
+    const std::vector<std::pair<int, int>>* edgeFaces;
+    // rotates the face normals into the working frame
+    glm::mat3                               rotation;
+    glm::vec3                               center;
+};
+
+/**
+BoxView - an oriented box in the working frame. Axes are the columns of the matrix.
+ */
+struct BoxView
+{
+    glm::vec3   center;
+    glm::mat3   axes;
+    glm::vec3   halfExtents;
 };
 
 /**
 Collision detector contains all the logic that checks if two colliders are intersecting.
+All the tests run in the local frame of the first collider, results are returned in world space.
  */
 class CollisionDetector
 {
     public:
         CollisionDetector();
 
-        std::shared_ptr<Collision> Collide(std::shared_ptr<Collider> first, std::shared_ptr<Collider> second);
+        /**
+        Filter applies the layer/mask test to a candidate pair, returns false if it should be skipped.
+        */
+        bool Filter(Collider& first, Collider& second);
+
+        /**
+        Collide adds the collision of the pair with its contacts to the arena. Returns it, nullptr if the
+        colliders do not touch.
+        */
+        const Collision* Collide(std::shared_ptr<Collider> first, std::shared_ptr<Collider> second, ContactArena& arena);
 
-        bool CheckFaces(SATData& data, std::shared_ptr<Collider> first,  std::shared_ptr<Collider> second, bool isFaceA);
+        /**
+        Overlap is the boolean SAT test used for sensors - same axes as Collide but no contact generation.
+        */
+        bool Overlap(std::shared_ptr<Collider> first, std::shared_ptr<Collider> second);
 
-        bool CheckEdges(SATData& data, std::shared_ptr<Collider> first, std::shared_ptr<Collider> second);
+        /**
+        CollideHeightfield tests a convex collider against the terrain cells under its AABB. Hull points below
+        the triangle under them and terrain samples inside the hull become contacts along the terrain normal.
+        The collider is the first of the collision, the heightfield proxy collider the second.
+        */
+        const Collision* CollideHeightfield(std::shared_ptr<Collider> collider, Heightfield& heightfield, ContactArena& arena);
+
+        /**
+        CollideMesh runs GJK/EPA between the collider and every mesh triangle the BVH returns for its AABB.
+        A triangle pushing along its face normal gives the incident hull face clipped against it, the others
+        one contact between the EPA witness points. The collider is the first of the collision.
+        */
+        const Collision* CollideMesh(std::shared_ptr<Collider> collider, TriangleMesh& mesh, ContactArena& arena);
+
+        /**
+        SelectNarrowphase is the policy picking the backend for a pair. SAT cost grows with
+        faces + edgesA * edgesB, GJK/EPA only with the number of points, so complex hulls go to GJK.
+        Two boxes use the dedicated box test.
+        */
+        NarrowphaseType SelectNarrowphase(Collider& first, Collider& second);
+
+        /**
+        CollideGJK runs GJK + EPA on the pair (second already transformed by TransformIntoFrame).
+        Returns false if EPA could not produce a result and SAT should be used instead.
+        */
+        bool CollideGJK(std::shared_ptr<Collider> first, std::shared_ptr<Collider> second, ContactArena& arena, const Collision*& collision);
+
+        /**
+        CollideBoxes is the fast path for two box hulls - 15 axis SAT (3 + 3 face axes, 9 edge crosses)
+        with the contacts built from the box corners, no per point transform or allocation.
+        Returns nullptr if the boxes are separated.
+        */
+        const Collision* CollideBoxes(std::shared_ptr<Collider> first, std::shared_ptr<Collider> second, ContactArena& arena);
+
+        /**
+        Distance returns the distance between two colliders and the closest points on both, in world space.
+        Returns 0 if they intersect.
+        */
+        float Distance(std::shared_ptr<Collider> first, std::shared_ptr<Collider> second, glm::vec3& closestFirst, glm::vec3& closestSecond);
+
+        /**
+        TimeOfImpact - conservative advancement of a moving collider against a fixed one. The owning body moves
+        linearly from the start to the end pose. Returns true and the fraction of the motion in toi if the
+        colliders come within toiTolerance of each other. A target already within toiTolerance at the start pose
+        is a hit at toi 0 only if the motion goes into it, resting and sliding contacts are left to the
+        discrete collision pass.
+        The moving collider is left at the end pose.
+        */
+        bool TimeOfImpact(  std::shared_ptr<Collider> moving,
+                            glm::vec3 startPosition,
+                            glm::quat startOrientation,
+                            glm::vec3 endPosition,
+                            glm::quat endOrientation,
+                            std::shared_ptr<Collider> target,
+                            float& toi);
+
+        /**
+        TimeOfImpact against a fixed world space triangle, for the mesh and terrain triangles under a sweep.
+        */
+        bool TimeOfImpact(  std::shared_ptr<Collider> moving,
+                            glm::vec3 startPosition,
+                            glm::quat startOrientation,
+                            glm::vec3 endPosition,
+                            glm::quat endOrientation,
+                            glm::vec3 a,
+                            glm::vec3 b,
+                            glm::vec3 c,
+                            float& toi);
+
+        // Scene queries against a single collider. They only use the scratch buffers of the detector,
+        // so one detector per thread is enough to run them in parallel.
+
+        /**
+        Raycast clips the ray against the face planes of the hull. direction has to be normalized.
+        */
+        bool Raycast(Collider& collider, glm::vec3 origin, glm::vec3 direction, float maxDistance, QueryHit& hit);
+
+        /**
+        SphereCast - conservative advancement of the sphere center along the ray, distances come from GJK.
+        */
+        bool SphereCast(Collider& collider, glm::vec3 origin, glm::vec3 direction, float radius, float maxDistance, QueryHit& hit);
+
+        /**
+        OverlapBox - GJK intersection test between the hull and an oriented box.
+        */
+        bool OverlapBox(Collider& collider, glm::vec3 center, glm::vec3 halfExtents, glm::quat orientation);
+
+        bool CheckFaces(SATData& data, const ColliderView& first, const ColliderView& second, bool isFaceA);
+
+        /**
+        CheckEdges tests the cross products of edge pairs. Pairs that do not form a face of the
+        Minkowski difference are skipped (Gauss map test on the adjacent face normals).
+        */
+        bool CheckEdges(SATData& data, const ColliderView& first, const ColliderView& second);
+
+        /**
+        IsMinkowskiFace - a, b are the normals of the faces adjacent to an edge of A and c, d the negated
+        normals adjacent to an edge of B. Returns true if the two arcs intersect on the Gauss map.
+        */
+        bool IsMinkowskiFace(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d);
 
         /**
         the first collider will hold the reference face and the second will hold the incident face.
         */
-        std::vector<glm::vec3> GetContactPoints(SATData& data, std::shared_ptr<Collider> first, std::shared_ptr<Collider> second);
+        std::vector<glm::vec3> GetContactPoints(SATData& data, const ColliderView& first, const ColliderView& second);
+
+        /**
+        BoundsOverlap is the early-out done before any SAT work - bounding spheres first, then world AABBs.
+         */
+        bool BoundsOverlap(const Collider& first, const Collider& second);
+
+        const CollisionStats& GetStats();
+        void ResetStats();
 
         // Helpers
         /** 
@@ -72,7 +258,56 @@ class CollisionDetector
         glm::vec3 GetSupportPoint(const std::vector<glm::vec3>& points,  glm::vec3 direction);
 
         float tolerance = 0.0005f;
+        // SAT axis count above which the GJK backend is used
+        int gjkThreshold = 400;
+        // box/box pairs use CollideBoxes instead of the generic SAT
+        bool useBoxNarrowphase = true;
+        // conservative advancement stops once the colliders are this close
+        float toiTolerance = 0.01f;
+        int toiMaxIterations = 32;
         
     private:
 
+        /**
+        TransformIntoFrame fills transformedPoints with the points of second in the local frame of first.
+        */
+        void TransformIntoFrame(Collider& first, Collider& second, glm::quat& relativeOrientation, glm::vec3& relativePosition);
+
+        /**
+        Advance is the conservative advancement behind both TimeOfImpact, against target or,
+        when target is null, against the triangle.
+        */
+        bool Advance(   std::shared_ptr<Collider> moving,
+                        glm::vec3 startPosition,
+                        glm::quat startOrientation,
+                        glm::vec3 endPosition,
+                        glm::quat endOrientation,
+                        std::shared_ptr<Collider> target,
+                        const glm::vec3* triangle,
+                        float& toi);
+
+        /**
+        ClipAgainstTriangle clips the face of the collider most anti parallel to normal against the side planes
+        of the triangle in queryPoints (collider local frame) and keeps the points below it in clipPoints.
+        normal is the unit triangle normal facing the collider. Returns the number of points kept.
+        */
+        int ClipAgainstTriangle(Collider& collider, glm::vec3 normal);
+
+        CollisionStats stats;
+        GJK gjk;
+
+        /**
+        Scratch buffer holding the points of the second collider in the frame of the first one.
+        Reused between calls so the transform does not allocate.
+        */
+        std::vector<glm::vec3> transformedPoints;
+
+        // query shapes in the local frame of the collider being tested
+        std::vector<glm::vec3> queryPoints;
+        // mesh triangles under the collider bounds
+        std::vector<int> meshTriangles;
+        // incident face polygon while it is clipped against a mesh triangle
+        std::vector<glm::vec3> clipPoints;
+        std::vector<glm::vec3> clipScratch;
+
 };
\ No newline at end of file
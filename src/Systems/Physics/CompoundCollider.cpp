@@ -0,0 +1,146 @@
+#include "CompoundCollider.hpp"
+#include <cassert>
+#include <algorithm>
+
+namespace
+{
+    const int stackSize = 32;
+    // one child per leaf, so a query returns exactly the overlapping children
+    const int maxLeafSize = 1;
+}
+
+CompoundCollider::CompoundCollider( int entityID,
+                                    glm::vec3 center,
+                                    std::shared_ptr<const Hull> hull,
+                                    DynamicType dynamicType,
+                                    std::vector<std::shared_ptr<Collider>> children) : \
+                                    Collider(entityID, center, hull, dynamicType)
+{
+    assert(!children.empty());
+    this->isCompound = true;
+    // the proxy starts unrotated, world bounds minus the center are the bounds in the proxy frame
+    std::vector<glm::vec3> boundsMin(children.size());
+    std::vector<glm::vec3> boundsMax(children.size());
+    std::vector<int> order(children.size());
+    for (int i = 0; i < children.size(); i++)
+    {
+        boundsMin[i] = children[i]->aabbMin - center;
+        boundsMax[i] = children[i]->aabbMax - center;
+        order[i] = i;
+    }
+    this->nodes.reserve(2 * children.size());
+    this->BuildNode(boundsMin, boundsMax, order, 0, children.size());
+    for (int i = 0; i < order.size(); i++)
+        this->children.push_back(children[order[i]]);
+}
+
+CompoundCollider::CompoundCollider( int entityID,
+                                    glm::vec3 center,
+                                    std::shared_ptr<const Hull> hull,
+                                    DynamicType dynamicType,
+                                    std::vector<std::shared_ptr<Collider>> children,
+                                    std::vector<BVHNode> nodes) : \
+                                    Collider(entityID, center, hull, dynamicType),
+                                    children(children),
+                                    nodes(nodes)
+{
+    assert(!children.empty() && !nodes.empty());
+    this->isCompound = true;
+}
+
+int CompoundCollider::BuildNode(const std::vector<glm::vec3>& boundsMin,
+                                const std::vector<glm::vec3>& boundsMax,
+                                std::vector<int>& order,
+                                int begin,
+                                int end)
+{
+    int index = this->nodes.size();
+    this->nodes.emplace_back();
+    glm::vec3 nodeMin = boundsMin[order[begin]];
+    glm::vec3 nodeMax = boundsMax[order[begin]];
+    for (int i = begin + 1; i < end; i++)
+    {
+        nodeMin = glm::min(nodeMin, boundsMin[order[i]]);
+        nodeMax = glm::max(nodeMax, boundsMax[order[i]]);
+    }
+    this->nodes[index].min = nodeMin;
+    this->nodes[index].max = nodeMax;
+    this->nodes[index].offset = begin;
+    this->nodes[index].count = end - begin;
+    if (end - begin <= maxLeafSize)
+        return index;
+
+    glm::vec3 extent = nodeMax - nodeMin;
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+    int middle = (begin + end) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end, [&](int a, int b)
+    {
+        return boundsMin[a][axis] + boundsMax[a][axis] < boundsMin[b][axis] + boundsMax[b][axis];
+    });
+    this->BuildNode(boundsMin, boundsMax, order, begin, middle);
+    int right = this->BuildNode(boundsMin, boundsMax, order, middle, end);
+    this->nodes[index].offset = right;
+    this->nodes[index].count = 0;
+    return index;
+}
+
+void CompoundCollider::Attach(glm::vec3 bodyPosition, glm::quat bodyOrientation)
+{
+    Collider::Attach(bodyPosition, bodyOrientation);
+    for (int i = 0; i < this->children.size(); i++)
+    {
+        this->children[i]->entityID = this->entityID;
+        this->children[i]->dynamicType = this->dynamicType;
+        this->children[i]->Attach(bodyPosition, bodyOrientation);
+    }
+}
+
+void CompoundCollider::Update(glm::vec3 bodyPosition, glm::quat bodyOrientation)
+{
+    Collider::Update(bodyPosition, bodyOrientation);
+    for (int i = 0; i < this->children.size(); i++)
+        this->children[i]->Update(bodyPosition, bodyOrientation);
+}
+
+void CompoundCollider::Query(glm::vec3 min, glm::vec3 max, std::vector<std::shared_ptr<Collider>>& parts)
+{
+    // world box into the proxy frame, same projection as UpdateBounds
+    glm::mat3 rotation = glm::mat3_cast(glm::conjugate(this->orientation));
+    glm::vec3 halfExtents = 0.5f * (max - min);
+    glm::vec3 localHalfExtents = glm::abs(rotation[0]) * halfExtents.x +
+                                 glm::abs(rotation[1]) * halfExtents.y +
+                                 glm::abs(rotation[2]) * halfExtents.z;
+    glm::vec3 localCenter = this->ToLocal(0.5f * (min + max));
+    glm::vec3 localMin = localCenter - localHalfExtents;
+    glm::vec3 localMax = localCenter + localHalfExtents;
+
+    int stack[stackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        int index = stack[--top];
+        const BVHNode& node = this->nodes[index];
+        if (!glm::all(glm::lessThanEqual(localMin, node.max)) || !glm::all(glm::lessThanEqual(node.min, localMax)))
+            continue;
+        if (node.count > 0)
+        {
+            for (int i = node.offset; i < node.offset + node.count; i++)
+                parts.push_back(this->children[i]);
+            continue;
+        }
+        assert(top + 2 <= stackSize);
+        stack[top++] = node.offset;
+        stack[top++] = index + 1;
+    }
+}
+
+const std::vector<std::shared_ptr<Collider>>& CompoundCollider::GetChildren()
+{
+    return this->children;
+}
+
+const std::vector<BVHNode>& CompoundCollider::GetNodes()
+{
+    return this->nodes;
+}
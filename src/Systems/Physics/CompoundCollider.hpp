@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Collider.hpp"
+#include "TriangleMesh.hpp"
+
+/**
+CompoundCollider - several convex hulls of one body behind a single grid proxy. The hull of the proxy
+is the box around the children, the children are kept in a small BVH built in the proxy frame.
+Children are not in the grid and only tested when the proxy overlaps something.
+*/
+class CompoundCollider : public Collider
+{
+    public:
+        /**
+        center and hull are the proxy box, children are given in world space like any built collider.
+        */
+        CompoundCollider(   int entityID,
+                            glm::vec3 center,
+                            std::shared_ptr<const Hull> hull,
+                            DynamicType dynamicType,
+                            std::vector<std::shared_ptr<Collider>> children);
+
+        /**
+        Restores a compound with its BVH, children have to be in the leaf order of the nodes (see GetChildren).
+        */
+        CompoundCollider(   int entityID,
+                            glm::vec3 center,
+                            std::shared_ptr<const Hull> hull,
+                            DynamicType dynamicType,
+                            std::vector<std::shared_ptr<Collider>> children,
+                            std::vector<BVHNode> nodes);
+
+        /**
+        Attaches the children to the body as well, they take the entity and dynamic type of the compound.
+        */
+        void Attach(glm::vec3 bodyPosition, glm::quat bodyOrientation) override;
+
+        /**
+        Moves the proxy and the children. Children updates are plain transforms, their BVH is never rebuilt.
+        */
+        void Update(glm::vec3 bodyPosition, glm::quat bodyOrientation) override;
+
+        /**
+        Query appends the children whose bounds overlap the given world bounds. Read only, safe to run from several threads.
+        */
+        void Query(glm::vec3 min, glm::vec3 max, std::vector<std::shared_ptr<Collider>>& parts);
+
+        const std::vector<std::shared_ptr<Collider>>&   GetChildren();
+        const std::vector<BVHNode>&                     GetNodes();
+
+    private:
+        /**
+        Median split on the longest axis of the child centers, children are few so SAH does not pay off here.
+        */
+        int BuildNode(  const std::vector<glm::vec3>& boundsMin,
+                        const std::vector<glm::vec3>& boundsMax,
+                        std::vector<int>& order,
+                        int begin,
+                        int end);
+
+        // in BVH leaf order
+        std::vector<std::shared_ptr<Collider>>  children;
+        // bounds in the proxy frame
+        std::vector<BVHNode>                    nodes;
+};
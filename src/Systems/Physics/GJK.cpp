@@ -0,0 +1,441 @@
+#include <cmath>
+#include <cassert>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/norm.hpp>
+#include "GJK.hpp"
+
+namespace
+{
+    glm::vec3 Farthest(const std::vector<glm::vec3>& points, glm::vec3 direction)
+    {
+        assert(points.size() != 0);
+        float max = glm::dot(direction, points[0]);
+        int index = 0;
+        for (int i = 1; i < points.size(); i++)
+        {
+            float current = glm::dot(direction, points[i]);
+            if (current > max)
+            {
+                max = current;
+                index = i;
+            }
+        }
+        return points[index];
+    }
+}
+
+GJK::GJK() : simplexSize(0)
+{
+
+}
+
+SupportPoint GJK::Support(const std::vector<glm::vec3>& pointsA, const std::vector<glm::vec3>& pointsB, glm::vec3 direction)
+{
+    SupportPoint support;
+    support.a = Farthest(pointsA, direction);
+    support.b = Farthest(pointsB, -direction);
+    support.point = support.a - support.b;
+    return support;
+}
+
+bool GJK::Query(const std::vector<glm::vec3>& pointsA, const std::vector<glm::vec3>& pointsB, GJKResult& result)
+{
+    this->simplex[0] = this->Support(pointsA, pointsB, pointsB[0] - pointsA[0]);
+    this->weights[0] = 1.f;
+    this->simplexSize = 1;
+    glm::vec3 closest = this->simplex[0].point;
+    result.intersecting = false;
+
+    for (int iteration = 0; iteration < this->maxIterations; iteration++)
+    {
+        float closestSquared = glm::dot(closest, closest);
+        // origin on the simplex - touching or intersecting
+        if (closestSquared < this->tolerance * this->tolerance)
+        {
+            result.intersecting = true;
+            break;
+        }
+
+        SupportPoint support = this->Support(pointsA, pointsB, -closest);
+        // no progress towards the origin, the current simplex holds the closest feature
+        if (closestSquared - glm::dot(closest, support.point) <= this->tolerance * closestSquared)
+            break;
+
+        this->simplex[this->simplexSize] = support;
+        this->simplexSize++;
+        closest = this->ReduceSimplex();
+        // the origin is inside the tetrahedron
+        if (this->simplexSize == 4)
+        {
+            result.intersecting = true;
+            break;
+        }
+    }
+
+    result.closestA = glm::vec3(0.f, 0.f, 0.f);
+    result.closestB = glm::vec3(0.f, 0.f, 0.f);
+    for (int i = 0; i < this->simplexSize; i++)
+    {
+        result.closestA += this->weights[i] * this->simplex[i].a;
+        result.closestB += this->weights[i] * this->simplex[i].b;
+    }
+    result.distance = result.intersecting ? 0.f : glm::length(closest);
+    return result.intersecting;
+}
+
+glm::vec3 GJK::ReduceSimplex()
+{
+    switch (this->simplexSize)
+    {
+        case 1:
+            this->weights[0] = 1.f;
+            return this->simplex[0].point;
+        case 2:
+            return this->ReduceSegment(this->simplex, this->weights, this->simplexSize);
+        case 3:
+            return this->ReduceTriangle(this->simplex, this->weights, this->simplexSize);
+        default:
+            return this->ReduceTetrahedron();
+    }
+}
+
+glm::vec3 GJK::ReduceSegment(SupportPoint* points, float* weights, int& size)
+{
+    glm::vec3 a = points[0].point;
+    glm::vec3 ab = points[1].point - a;
+    float lengthSquared = glm::dot(ab, ab);
+    float t = lengthSquared > 0.f ? glm::dot(-a, ab) / lengthSquared : 0.f;
+    if (t <= 0.f)
+    {
+        size = 1;
+        weights[0] = 1.f;
+        return a;
+    }
+    if (t >= 1.f)
+    {
+        points[0] = points[1];
+        size = 1;
+        weights[0] = 1.f;
+        return points[0].point;
+    }
+    size = 2;
+    weights[0] = 1.f - t;
+    weights[1] = t;
+    return a + t * ab;
+}
+
+glm::vec3 GJK::ReduceTriangle(SupportPoint* points, float* weights, int& size)
+{
+    // Real-Time Collision Detection 5.1.5, closest point on triangle to the origin
+    glm::vec3 a = points[0].point;
+    glm::vec3 b = points[1].point;
+    glm::vec3 c = points[2].point;
+    glm::vec3 ab = b - a;
+    glm::vec3 ac = c - a;
+
+    float d1 = glm::dot(ab, -a);
+    float d2 = glm::dot(ac, -a);
+    if (d1 <= 0.f && d2 <= 0.f)
+    {
+        size = 1;
+        weights[0] = 1.f;
+        return a;
+    }
+
+    float d3 = glm::dot(ab, -b);
+    float d4 = glm::dot(ac, -b);
+    if (d3 >= 0.f && d4 <= d3)
+    {
+        points[0] = points[1];
+        size = 1;
+        weights[0] = 1.f;
+        return b;
+    }
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f)
+    {
+        float v = d1 / (d1 - d3);
+        size = 2;
+        weights[0] = 1.f - v;
+        weights[1] = v;
+        return a + v * ab;
+    }
+
+    float d5 = glm::dot(ab, -c);
+    float d6 = glm::dot(ac, -c);
+    if (d6 >= 0.f && d5 <= d6)
+    {
+        points[0] = points[2];
+        size = 1;
+        weights[0] = 1.f;
+        return c;
+    }
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f)
+    {
+        float w = d2 / (d2 - d6);
+        points[1] = points[2];
+        size = 2;
+        weights[0] = 1.f - w;
+        weights[1] = w;
+        return a + w * ac;
+    }
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f)
+    {
+        float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        points[0] = points[1];
+        points[1] = points[2];
+        size = 2;
+        weights[0] = 1.f - w;
+        weights[1] = w;
+        return b + w * (c - b);
+    }
+
+    float denominator = 1.f / (va + vb + vc);
+    float v = vb * denominator;
+    float w = vc * denominator;
+    size = 3;
+    weights[0] = 1.f - v - w;
+    weights[1] = v;
+    weights[2] = w;
+    return a + ab * v + ac * w;
+}
+
+glm::vec3 GJK::ReduceTetrahedron()
+{
+    // check the origin against the 4 faces, the closest point is on one of the faces it is outside of.
+    static const int faceIndices[4][4] = {{0, 1, 2, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {1, 3, 2, 0}};
+    SupportPoint bestPoints[4];
+    float bestWeights[4];
+    int bestSize = 0;
+    float bestDistance = INFINITY;
+    glm::vec3 bestClosest;
+
+    for (int i = 0; i < 4; i++)
+    {
+        const SupportPoint& a = this->simplex[faceIndices[i][0]];
+        const SupportPoint& b = this->simplex[faceIndices[i][1]];
+        const SupportPoint& c = this->simplex[faceIndices[i][2]];
+        const SupportPoint& d = this->simplex[faceIndices[i][3]];
+        glm::vec3 normal = glm::cross(b.point - a.point, c.point - a.point);
+        float originSide = glm::dot(-a.point, normal);
+        float oppositeSide = glm::dot(d.point - a.point, normal);
+        // flat tetrahedron - every face is a candidate
+        bool isDegenerate = std::abs(oppositeSide) < this->tolerance * this->tolerance;
+        if (!isDegenerate && originSide * oppositeSide >= 0.f)
+            continue;
+
+        SupportPoint points[4] = {a, b, c};
+        float weights[4];
+        int size = 3;
+        glm::vec3 closest = this->ReduceTriangle(points, weights, size);
+        float distance = glm::dot(closest, closest);
+        if (distance < bestDistance)
+        {
+            bestDistance = distance;
+            bestClosest = closest;
+            bestSize = size;
+            for (int j = 0; j < size; j++)
+            {
+                bestPoints[j] = points[j];
+                bestWeights[j] = weights[j];
+            }
+        }
+    }
+
+    // inside all the faces
+    if (bestSize == 0)
+        return glm::vec3(0.f, 0.f, 0.f);
+
+    this->simplexSize = bestSize;
+    for (int i = 0; i < bestSize; i++)
+    {
+        this->simplex[i] = bestPoints[i];
+        this->weights[i] = bestWeights[i];
+    }
+    return bestClosest;
+}
+
+bool GJK::BuildTetrahedron(const std::vector<glm::vec3>& pointsA, const std::vector<glm::vec3>& pointsB)
+{
+    static const glm::vec3 axes[6] = {  glm::vec3(1.f, 0.f, 0.f), glm::vec3(-1.f, 0.f, 0.f),
+                                        glm::vec3(0.f, 1.f, 0.f), glm::vec3(0.f, -1.f, 0.f),
+                                        glm::vec3(0.f, 0.f, 1.f), glm::vec3(0.f, 0.f, -1.f)};
+    float epsilon = this->tolerance * this->tolerance;
+    if (this->simplexSize == 1)
+    {
+        for (int i = 0; i < 6 && this->simplexSize == 1; i++)
+        {
+            SupportPoint support = this->Support(pointsA, pointsB, axes[i]);
+            if (glm::length2(support.point - this->simplex[0].point) > epsilon)
+                this->simplex[this->simplexSize++] = support;
+        }
+    }
+    if (this->simplexSize == 2)
+    {
+        glm::vec3 line = this->simplex[1].point - this->simplex[0].point;
+        for (int i = 0; i < 6 && this->simplexSize == 2; i += 2)
+        {
+            glm::vec3 perpendicular = glm::cross(line, axes[i]);
+            if (glm::length2(perpendicular) < epsilon)
+                continue;
+            for (int sign = 0; sign < 2 && this->simplexSize == 2; sign++)
+            {
+                SupportPoint support = this->Support(pointsA, pointsB, sign == 0 ? perpendicular : -perpendicular);
+                if (glm::length2(glm::cross(support.point - this->simplex[0].point, line)) > epsilon)
+                    this->simplex[this->simplexSize++] = support;
+            }
+        }
+    }
+    if (this->simplexSize == 3)
+    {
+        glm::vec3 normal = glm::cross(  this->simplex[1].point - this->simplex[0].point,
+                                        this->simplex[2].point - this->simplex[0].point);
+        SupportPoint support = this->Support(pointsA, pointsB, normal);
+        if (std::abs(glm::dot(support.point - this->simplex[0].point, normal)) < epsilon)
+            support = this->Support(pointsA, pointsB, -normal);
+        if (std::abs(glm::dot(support.point - this->simplex[0].point, normal)) < epsilon)
+            return false;
+        this->simplex[this->simplexSize++] = support;
+    }
+    return this->simplexSize == 4;
+}
+
+bool GJK::Penetration(const std::vector<glm::vec3>& pointsA, const std::vector<glm::vec3>& pointsB, GJKResult& result)
+{
+    if (!this->BuildTetrahedron(pointsA, pointsB))
+        return false;
+
+    // orient the tetrahedron so that face 012 points away from vertex 3
+    if (glm::dot(glm::cross(this->simplex[1].point - this->simplex[0].point,
+                            this->simplex[2].point - this->simplex[0].point),
+                 this->simplex[3].point - this->simplex[0].point) > 0.f)
+    {
+        SupportPoint temp = this->simplex[1];
+        this->simplex[1] = this->simplex[2];
+        this->simplex[2] = temp;
+    }
+
+    this->vertices.clear();
+    this->faces.clear();
+    for (int i = 0; i < 4; i++)
+    {
+        this->vertices.push_back(this->simplex[i]);
+    }
+    if (!this->AddFace(0, 1, 2) || !this->AddFace(0, 3, 1) || !this->AddFace(0, 2, 3) || !this->AddFace(1, 3, 2))
+        return false;
+
+    int closestFace = 0;
+    for (int iteration = 0; iteration < this->maxIterations; iteration++)
+    {
+        closestFace = 0;
+        for (int i = 1; i < this->faces.size(); i++)
+        {
+            if (this->faces[i].distance < this->faces[closestFace].distance)
+                closestFace = i;
+        }
+
+        EPAFace face = this->faces[closestFace];
+        SupportPoint support = this->Support(pointsA, pointsB, face.normal);
+        if (glm::dot(support.point, face.normal) - face.distance < this->tolerance)
+            break;
+
+        // remove every face the new point can see and keep their horizon
+        this->edges.clear();
+        for (int i = this->faces.size() - 1; i >= 0; i--)
+        {
+            const EPAFace& current = this->faces[i];
+            if (glm::dot(current.normal, support.point - this->vertices[current.a].point) > 0.f)
+            {
+                this->AddEdge(current.a, current.b);
+                this->AddEdge(current.b, current.c);
+                this->AddEdge(current.c, current.a);
+                this->faces[i] = this->faces.back();
+                this->faces.pop_back();
+            }
+        }
+
+        int index = this->vertices.size();
+        this->vertices.push_back(support);
+        for (int i = 0; i < this->edges.size(); i++)
+        {
+            this->AddFace(this->edges[i].first, this->edges[i].second, index);
+        }
+        if (this->faces.size() == 0)
+            return false;
+    }
+
+    closestFace = 0;
+    for (int i = 1; i < this->faces.size(); i++)
+    {
+        if (this->faces[i].distance < this->faces[closestFace].distance)
+            closestFace = i;
+    }
+    const EPAFace& face = this->faces[closestFace];
+
+    // barycentric coordinates of the origin projected on the face give the witness points
+    const SupportPoint& a = this->vertices[face.a];
+    const SupportPoint& b = this->vertices[face.b];
+    const SupportPoint& c = this->vertices[face.c];
+    glm::vec3 projection = face.normal * face.distance;
+    glm::vec3 v0 = b.point - a.point;
+    glm::vec3 v1 = c.point - a.point;
+    glm::vec3 v2 = projection - a.point;
+    float d00 = glm::dot(v0, v0);
+    float d01 = glm::dot(v0, v1);
+    float d11 = glm::dot(v1, v1);
+    float d20 = glm::dot(v2, v0);
+    float d21 = glm::dot(v2, v1);
+    float denominator = d00 * d11 - d01 * d01;
+    float v = 0.f;
+    float w = 0.f;
+    if (std::abs(denominator) > 0.f)
+    {
+        v = (d11 * d20 - d01 * d21) / denominator;
+        w = (d00 * d21 - d01 * d20) / denominator;
+    }
+    float u = 1.f - v - w;
+
+    result.intersecting = true;
+    result.normal = face.normal;
+    result.depth = face.distance;
+    result.closestA = u * a.a + v * b.a + w * c.a;
+    result.closestB = u * a.b + v * b.b + w * c.b;
+    return true;
+}
+
+bool GJK::AddFace(int a, int b, int c)
+{
+    EPAFace face;
+    face.a = a;
+    face.b = b;
+    face.c = c;
+    glm::vec3 normal = glm::cross(  this->vertices[b].point - this->vertices[a].point,
+                                    this->vertices[c].point - this->vertices[a].point);
+    float length = glm::length(normal);
+    if (length < this->tolerance * this->tolerance)
+        return false;
+    face.normal = normal / length;
+    face.distance = glm::dot(face.normal, this->vertices[a].point);
+    this->faces.push_back(face);
+    return true;
+}
+
+void GJK::AddEdge(int a, int b)
+{
+    // an edge shared by two removed faces is not on the horizon
+    for (int i = 0; i < this->edges.size(); i++)
+    {
+        if (this->edges[i].first == b && this->edges[i].second == a)
+        {
+            this->edges[i] = this->edges.back();
+            this->edges.pop_back();
+            return;
+        }
+    }
+    this->edges.push_back(std::make_pair(a, b));
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+/**
+SupportPoint - a point of the Minkowski difference A - B together with the points of A and B that produced it.
+*/
+struct SupportPoint
+{
+    glm::vec3 point;
+    glm::vec3 a;
+    glm::vec3 b;
+};
+
+/**
+GJKResult - output of a GJK/EPA query. All vectors are in the frame of the input points.
+*/
+struct GJKResult
+{
+    bool        intersecting;
+    // GJK - distance between the shapes and the closest points on both of them
+    float       distance;
+    glm::vec3   closestA;
+    glm::vec3   closestB;
+    // EPA - penetration normal (pointing from A towards B) and depth
+    glm::vec3   normal;
+    float       depth;
+};
+
+/**
+GJK implements the Gilbert-Johnson-Keerthi distance algorithm and the Expanding Polytope Algorithm
+for penetration depth. Both shapes are given as point clouds expressed in the same frame.
+Cost is O(iterations * (Na + Nb)) and does not depend on the number of faces and edges.
+*/
+class GJK
+{
+    public:
+        GJK();
+
+        /**
+        Query runs GJK. Returns true if the shapes intersect, otherwise fills the distance and closest points.
+        */
+        bool Query(const std::vector<glm::vec3>& pointsA, const std::vector<glm::vec3>& pointsB, GJKResult& result);
+
+        /**
+        Penetration runs EPA on the simplex left by a Query that returned true.
+        Returns false if the polytope could not be built (flat shapes), result is then untouched.
+        */
+        bool Penetration(const std::vector<glm::vec3>& pointsA, const std::vector<glm::vec3>& pointsB, GJKResult& result);
+
+        SupportPoint Support(const std::vector<glm::vec3>& pointsA, const std::vector<glm::vec3>& pointsB, glm::vec3 direction);
+
+        int     maxIterations = 64;
+        float   tolerance = 0.0001f;
+
+    private:
+
+        struct EPAFace
+        {
+            int         a;
+            int         b;
+            int         c;
+            glm::vec3   normal;
+            float       distance;
+        };
+
+        /**
+        Finds the point of the simplex closest to the origin, reduces the simplex to the feature
+        containing it and stores the barycentric weights. Returns the closest point.
+        */
+        glm::vec3 ReduceSimplex();
+        glm::vec3 ReduceSegment(SupportPoint* points, float* weights, int& size);
+        glm::vec3 ReduceTriangle(SupportPoint* points, float* weights, int& size);
+        glm::vec3 ReduceTetrahedron();
+
+        /** Grows a degenerate simplex into a tetrahedron enclosing the origin. */
+        bool BuildTetrahedron(const std::vector<glm::vec3>& pointsA, const std::vector<glm::vec3>& pointsB);
+        bool AddFace(int a, int b, int c);
+        void AddEdge(int a, int b);
+
+        SupportPoint                        simplex[4];
+        float                               weights[4];
+        int                                 simplexSize;
+
+        // EPA scratch buffers, reused between queries
+        std::vector<SupportPoint>           vertices;
+        std::vector<EPAFace>                faces;
+        std::vector<std::pair<int, int>>    edges;
+};
@@ -1,5 +1,7 @@
 #include "Grid.hpp"
 #include <set>
+#include <algorithm>
+#include <thread>
 #include <iostream>
 #include <unordered_map>
 
@@ -8,53 +10,158 @@ Grid::Grid(float gridLength, float halfWidth) : gridLength(gridLength),
                                                 halfWidth(halfWidth),
                                                 collisionDetector()
 {
-    this->cells.resize(this->cellsInRow);
-    // cell insertion
-    for (int row = 0; row < this->cells.size() ; row++)
+    // levels double the cell size until a single cell covers the grid
+    int levelCount = 1;
+    while (ceilf(gridLength / (2 * halfWidth * (1 << (levelCount - 1)))) > 1)
+        levelCount++;
+    this->coarseCells.resize(levelCount - 1);
+    this->levelCounts.resize(levelCount, 0);
+
+    for (int level = 0; level < levelCount; level++)
     {
-        this->cells[row].reserve(this->cellsInRow);
-        for (int col = 0; col < this->cellsInRow; col++)
+        std::vector<std::vector<Cell>>& levelCells = this->GetCells(level);
+        float levelHalfWidth = halfWidth * (1 << level);
+        int levelCellsInRow = ceilf(gridLength / (2 * levelHalfWidth));
+        levelCells.resize(levelCellsInRow);
+        // cell insertion
+        for (int row = 0; row < levelCells.size() ; row++)
         {
-            float x = col * 2 * halfWidth + halfWidth;
-            float z = row * 2 * halfWidth + halfWidth;
-            this->cells[row].emplace_back(glm::vec3(x, 0.f, z), halfWidth, row, col);
+            levelCells[row].reserve(levelCellsInRow);
+            for (int col = 0; col < levelCellsInRow; col++)
+            {
+                float x = col * 2 * levelHalfWidth + levelHalfWidth;
+                float z = row * 2 * levelHalfWidth + levelHalfWidth;
+                levelCells[row].emplace_back(glm::vec3(x, 0.f, z), levelHalfWidth, row, col);
+            }
         }
     }
 }
 
-std::vector<std::shared_ptr<Collision>> Grid::CheckCollisions()
+const std::vector<Collision>& Grid::CheckCollisions()
 {
     // check current and adjacent cells
-    std::vector<std::shared_ptr<Collision>> collisions;
-    for (int row = 0; row < this->cells.size() ; row++)
+    // 1. broadphase, pairs with overlapping bounds go to the pair cache
+    this->pairCache.BeginFrame();
+    for (int level = 0; level < this->levelCounts.size(); level++)
+    {
+        if (this->levelCounts[level] == 0)
+            continue;
+        // larger colliders are only met from the smaller side, skip that when every coarser level is empty
+        bool hasCoarser = false;
+        for (int coarser = level + 1; coarser < this->levelCounts.size(); coarser++)
+            hasCoarser = hasCoarser || this->levelCounts[coarser] > 0;
+
+        std::vector<std::vector<Cell>>& levelCells = this->GetCells(level);
+        for (int row = 0; row < levelCells.size() ; row++)
+        {
+            for (int col = 0; col < levelCells[row].size(); col++)
+            {
+                std::vector<std::pair<int, int>> eligibleCells = this->GetEligibleCells(row, col, level);
+                for (int i = 0; i < eligibleCells.size(); i++)
+                    this->CheckCells(row, col, eligibleCells[i].first, eligibleCells[i].second, level);
+                if (!hasCoarser)
+                    continue;
+                const std::vector<std::shared_ptr<Collider>>& dynamicColliders = levelCells[row][col].GetDynamicColliders();
+                const std::vector<std::shared_ptr<Collider>>& staticColliders = levelCells[row][col].GetStaticColliders();
+                for (int i = 0; i < dynamicColliders.size(); i++)
+                    this->CheckCoarser(dynamicColliders[i]);
+                for (int i = 0; i < staticColliders.size(); i++)
+                    this->CheckCoarser(staticColliders[i]);
+            }
+        }
+    }
+    this->pairCache.EndFrame();
+
+    // 2. narrowphase on the active pairs, sensors only get the overlap test
+    this->contactArena.Clear();
+    this->sensorOverlaps.clear();
+    std::vector<BroadphasePair>& pairs = this->pairCache.GetPairs();
+    for (int i = 0; i < pairs.size(); i++)
+    {
+        BroadphasePair& pair = pairs[i];
+        if (pair.isSensor)
+        {
+            if (this->collisionDetector.Overlap(pair.first, pair.second))
+                this->sensorOverlaps.emplace_back(pair.first, pair.second);
+            continue;
+        }
+        pair.collision = -1;
+        if (this->collisionDetector.Collide(pair.first, pair.second, this->contactArena) != nullptr)
+            pair.collision = this->contactArena.GetCollisions().size() - 1;
+    }
+
+    // terrain against the dynamic colliders of the cells it covers
+    std::vector<std::shared_ptr<Collider>>& parts = this->queryParts;
+    for (int i = 0; i < this->heightfields.size(); i++)
+    {
+        Heightfield& heightfield = *this->heightfields[i];
+        std::shared_ptr<Collider> terrain = heightfield.GetCollider();
+        for (int level = 0; level < this->levelCounts.size(); level++)
+        {
+            if (this->levelCounts[level] == 0)
+                continue;
+            std::vector<std::vector<Cell>>& levelCells = this->GetCells(level);
+            int minRow, maxRow, minCol, maxCol;
+            this->GetCellRange(level, heightfield.aabbMin, heightfield.aabbMax, minRow, maxRow, minCol, maxCol);
+            for (int row = minRow; row <= maxRow; row++)
+            {
+                for (int col = minCol; col <= maxCol; col++)
+                {
+                    const std::vector<std::shared_ptr<Collider>>& dynamicColliders = levelCells[row][col].GetDynamicColliders();
+                    for (int j = 0; j < dynamicColliders.size(); j++)
+                    {
+                        if (dynamicColliders[j]->isSensor || !this->collisionDetector.Filter(*dynamicColliders[j], *terrain))
+                            continue;
+                        parts.clear();
+                        this->GetParts(dynamicColliders[j], heightfield.aabbMin, heightfield.aabbMax, parts);
+                        for (int k = 0; k < parts.size(); k++)
+                            this->collisionDetector.CollideHeightfield(parts[k], heightfield, this->contactArena);
+                    }
+                }
+            }
+        }
+    }
+
+    // same for the static meshes
+    for (int i = 0; i < this->meshes.size(); i++)
     {
-        for (int col = 0; col < this->cells[row].size(); col++)
+        TriangleMesh& mesh = *this->meshes[i];
+        std::shared_ptr<Collider> proxy = mesh.GetCollider();
+        for (int level = 0; level < this->levelCounts.size(); level++)
         {
-            std::vector<std::pair<int, int>> eligibleCells = this->GetEligibleCells(row, col);
-            std::vector<std::shared_ptr<Collider>> dynamicCollidersA = this->cells[row][col].GetDynamicColliders();
-            for (int i = 0; i < eligibleCells.size(); i++)
+            if (this->levelCounts[level] == 0)
+                continue;
+            std::vector<std::vector<Cell>>& levelCells = this->GetCells(level);
+            int minRow, maxRow, minCol, maxCol;
+            this->GetCellRange(level, mesh.aabbMin, mesh.aabbMax, minRow, maxRow, minCol, maxCol);
+            for (int row = minRow; row <= maxRow; row++)
             {
-                int rowB = eligibleCells[i].first;
-                int colB = eligibleCells[i].second;
-                std::vector<std::shared_ptr<Collision>> newCollisions = this->CheckCells(row, col, rowB, colB);
-                if (newCollisions.size() > 0)
+                for (int col = minCol; col <= maxCol; col++)
                 {
-                    collisions.reserve(collisions.size() + newCollisions.size());
-                    collisions.insert(collisions.end(), newCollisions.begin(), newCollisions.end());
+                    const std::vector<std::shared_ptr<Collider>>& dynamicColliders = levelCells[row][col].GetDynamicColliders();
+                    for (int j = 0; j < dynamicColliders.size(); j++)
+                    {
+                        if (dynamicColliders[j]->isSensor || !this->collisionDetector.Filter(*dynamicColliders[j], *proxy))
+                            continue;
+                        parts.clear();
+                        this->GetParts(dynamicColliders[j], mesh.aabbMin, mesh.aabbMax, parts);
+                        for (int k = 0; k < parts.size(); k++)
+                            this->collisionDetector.CollideMesh(parts[k], mesh, this->contactArena);
+                    }
                 }
             }
         }
     }
-    return collisions;
+    return this->contactArena.GetCollisions();
 }
 
-std::vector<std::shared_ptr<Collision>> Grid::CheckCells(int rowA, int colA, int rowB, int colB)
+void Grid::CheckCells(int rowA, int colA, int rowB, int colB, int level)
 {
-    std::vector<std::shared_ptr<Collision>> collisions;
-    std::vector<std::shared_ptr<Collider>> dynamicCollidersA = this->cells[rowA][colA].GetDynamicColliders();
-    std::vector<std::shared_ptr<Collider>> dynamicCollidersB = this->cells[rowB][colB].GetDynamicColliders();
-    std::vector<std::shared_ptr<Collider>> staticCollidersA = this->cells[rowA][colA].GetStaticColliders();
-    std::vector<std::shared_ptr<Collider>> staticCollidersB = this->cells[rowB][colB].GetStaticColliders();
+    std::vector<std::vector<Cell>>& levelCells = this->GetCells(level);
+    const std::vector<std::shared_ptr<Collider>>& dynamicCollidersA = levelCells[rowA][colA].GetDynamicColliders();
+    const std::vector<std::shared_ptr<Collider>>& dynamicCollidersB = levelCells[rowB][colB].GetDynamicColliders();
+    const std::vector<std::shared_ptr<Collider>>& staticCollidersA = levelCells[rowA][colA].GetStaticColliders();
+    const std::vector<std::shared_ptr<Collider>>& staticCollidersB = levelCells[rowB][colB].GetStaticColliders();
     for (int i = 0; i < dynamicCollidersA.size(); i++)
     {
         // the starting point of dynamicCollidersB changes based on wether or not we are checking the same cell.
@@ -67,11 +174,7 @@ std::vector<std::shared_ptr<Collision>> Grid::CheckCells(int rowA, int colA, int
                 continue;
             std::shared_ptr<Collider> first = dynamicCollidersA[i];
             std::shared_ptr<Collider> second = dynamicCollidersB[j];
-            std::shared_ptr<Collision> collision = this->collisionDetector.Collide(first, second);
-            if (collision != nullptr)
-            {
-                collisions.push_back(collision);
-            }
+            this->CheckPair(first, second);
         }
     }
 
@@ -81,11 +184,7 @@ std::vector<std::shared_ptr<Collision>> Grid::CheckCells(int rowA, int colA, int
         {
             std::shared_ptr<Collider> first = dynamicCollidersA[i];
             std::shared_ptr<Collider> second = staticCollidersB[j];
-            std::shared_ptr<Collision> collision = this->collisionDetector.Collide(first, second);
-            if (collision != nullptr)
-            {
-                collisions.push_back(collision);
-            }
+            this->CheckPair(first, second);
         }
     }
 
@@ -98,29 +197,515 @@ std::vector<std::shared_ptr<Collision>> Grid::CheckCells(int rowA, int colA, int
             {
                 std::shared_ptr<Collider> first = staticCollidersA[i];
                 std::shared_ptr<Collider> second = dynamicCollidersB[j];
-                std::shared_ptr<Collision> collision = this->collisionDetector.Collide(first, second);
-                if (collision != nullptr)
+                this->CheckPair(first, second);
+            }
+        }
+    }
+}
+
+void Grid::CheckCoarser(std::shared_ptr<Collider> collider)
+{
+    // a coarser collider overlapping this one has its center at most one cell away from this center
+    bool isDynamic = collider->dynamicType == DynamicType::Dynamic || collider->dynamicType == DynamicType::WithPhysics;
+    glm::vec3 center = (collider->aabbMin + collider->aabbMax) * 0.5f;
+    for (int level = collider->level + 1; level < this->levelCounts.size(); level++)
+    {
+        if (this->levelCounts[level] == 0)
+            continue;
+        std::vector<std::vector<Cell>>& levelCells = this->GetCells(level);
+        int row, col;
+        this->Locate(level, center, row, col);
+        for (int rowB = std::max(row - 1, 0); rowB <= std::min(row + 1, (int)levelCells.size() - 1); rowB++)
+        {
+            for (int colB = std::max(col - 1, 0); colB <= std::min(col + 1, (int)levelCells[rowB].size() - 1); colB++)
+            {
+                const std::vector<std::shared_ptr<Collider>>& dynamicColliders = levelCells[rowB][colB].GetDynamicColliders();
+                for (int i = 0; i < dynamicColliders.size(); i++)
+                    this->CheckPair(collider, dynamicColliders[i]);
+                if (!isDynamic)
+                    continue;
+                const std::vector<std::shared_ptr<Collider>>& staticColliders = levelCells[rowB][colB].GetStaticColliders();
+                for (int i = 0; i < staticColliders.size(); i++)
+                    this->CheckPair(collider, staticColliders[i]);
+            }
+        }
+    }
+}
+
+void Grid::CheckPair(std::shared_ptr<Collider> first, std::shared_ptr<Collider> second, int depth)
+{
+    if (!this->collisionDetector.Filter(*first, *second))
+        return;
+    // compounds are opened one side at a time, their children go through the same checks
+    if (first->isCompound || second->isCompound)
+    {
+        bool isFirst = first->isCompound;
+        std::shared_ptr<Collider> other = isFirst ? second : first;
+        // the nested calls use the buffers of the next depths, this one stays valid while iterating
+        if (this->pairParts.size() <= depth)
+            this->pairParts.resize(depth + 1);
+        this->pairParts[depth].clear();
+        this->GetParts(isFirst ? first : second, other->aabbMin, other->aabbMax, this->pairParts[depth]);
+        for (int i = 0; i < this->pairParts[depth].size(); i++)
+        {
+            std::shared_ptr<Collider> part = this->pairParts[depth][i];
+            if (isFirst)
+                this->CheckPair(part, second, depth + 1);
+            else
+                this->CheckPair(first, part, depth + 1);
+        }
+        return;
+    }
+    if (glm::all(glm::lessThanEqual(first->aabbMin, second->aabbMax)) && glm::all(glm::lessThanEqual(second->aabbMin, first->aabbMax)))
+        this->pairCache.Report(first, second);
+}
+
+void Grid::GetParts(std::shared_ptr<Collider> collider, glm::vec3 min, glm::vec3 max, std::vector<std::shared_ptr<Collider>>& parts)
+{
+    if (collider->isCompound)
+        static_cast<CompoundCollider&>(*collider).Query(min, max, parts);
+    else
+        parts.push_back(collider);
+}
+
+ContactArena& Grid::GetContactArena()
+{
+    return this->contactArena;
+}
+
+PairCache& Grid::GetPairCache()
+{
+    return this->pairCache;
+}
+
+const std::vector<std::pair<std::shared_ptr<Collider>, std::shared_ptr<Collider>>>& Grid::GetSensorOverlaps()
+{
+    return this->sensorOverlaps;
+}
+
+float Grid::Sweep(  std::shared_ptr<Collider>   collider,
+                    glm::vec3                   startPosition,
+                    glm::quat                   startOrientation,
+                    glm::vec3                   endPosition,
+                    glm::quat                   endOrientation)
+{
+    // swept AABB - union of the bounds at both ends of the motion
+    collider->Update(startPosition, startOrientation);
+    glm::vec3 sweptMin = collider->aabbMin;
+    glm::vec3 sweptMax = collider->aabbMax;
+    collider->Update(endPosition, endOrientation);
+    sweptMin = glm::min(sweptMin, collider->aabbMin);
+    sweptMax = glm::max(sweptMax, collider->aabbMax);
+
+    float minToi = 1.f;
+    std::vector<std::shared_ptr<Collider>>& parts = this->queryParts;
+    for (int level = 0; level < this->levelCounts.size(); level++)
+    {
+        if (this->levelCounts[level] == 0)
+            continue;
+        std::vector<std::vector<Cell>>& levelCells = this->GetCells(level);
+        int minRow, maxRow, minCol, maxCol;
+        this->GetCellRange(level, sweptMin, sweptMax, minRow, maxRow, minCol, maxCol);
+        for (int row = minRow; row <= maxRow; row++)
+        {
+            for (int col = minCol; col <= maxCol; col++)
+            {
+                const std::vector<std::shared_ptr<Collider>>& staticColliders = levelCells[row][col].GetStaticColliders();
+                for (int i = 0; i < staticColliders.size(); i++)
+                {
+                    std::shared_ptr<Collider> target = staticColliders[i];
+                    if (target->isSensor || !collider->CanCollide(*target))
+                        continue;
+                    if (!glm::all(glm::lessThanEqual(sweptMin, target->aabbMax)) || !glm::all(glm::lessThanEqual(target->aabbMin, sweptMax)))
+                        continue;
+                    parts.clear();
+                    this->GetParts(target, sweptMin, sweptMax, parts);
+                    for (int j = 0; j < parts.size(); j++)
+                    {
+                        float toi;
+                        if (this->collisionDetector.TimeOfImpact(collider, startPosition, startOrientation, endPosition, endOrientation, parts[j], toi))
+                            minToi = std::min(minToi, toi);
+                    }
+                }
+            }
+        }
+    }
+
+    // mesh triangles the BVH returns for the swept AABB
+    for (int i = 0; i < this->meshes.size(); i++)
+    {
+        TriangleMesh& mesh = *this->meshes[i];
+        if (!collider->CanCollide(*mesh.GetCollider()))
+            continue;
+        if (!glm::all(glm::lessThanEqual(sweptMin, mesh.aabbMax)) || !glm::all(glm::lessThanEqual(mesh.aabbMin, sweptMax)))
+            continue;
+        this->sweepTriangles.clear();
+        mesh.Query(sweptMin, sweptMax, this->sweepTriangles);
+        for (int j = 0; j < this->sweepTriangles.size(); j++)
+        {
+            glm::vec3 a, b, c;
+            mesh.GetTriangle(this->sweepTriangles[j], a, b, c);
+            float toi;
+            if (this->collisionDetector.TimeOfImpact(collider, startPosition, startOrientation, endPosition, endOrientation, a, b, c, toi))
+                minToi = std::min(minToi, toi);
+        }
+    }
+
+    // both triangles of every terrain cell under the swept AABB, split along the (row, col) - (row + 1, col + 1) diagonal
+    for (int i = 0; i < this->heightfields.size(); i++)
+    {
+        Heightfield& heightfield = *this->heightfields[i];
+        if (!collider->CanCollide(*heightfield.GetCollider()))
+            continue;
+        if (!glm::all(glm::lessThanEqual(sweptMin, heightfield.aabbMax)) || !glm::all(glm::lessThanEqual(heightfield.aabbMin, sweptMax)))
+            continue;
+        int minRow, maxRow, minCol, maxCol;
+        if (!heightfield.GetCellRange(sweptMin, sweptMax, minRow, maxRow, minCol, maxCol))
+            continue;
+        for (int row = minRow; row <= maxRow; row++)
+        {
+            for (int col = minCol; col <= maxCol; col++)
+            {
+                glm::vec3 corner = heightfield.GetPoint(row, col);
+                glm::vec3 diagonal = heightfield.GetPoint(row + 1, col + 1);
+                float toi;
+                if (this->collisionDetector.TimeOfImpact(collider, startPosition, startOrientation, endPosition, endOrientation, corner, diagonal, heightfield.GetPoint(row, col + 1), toi))
+                    minToi = std::min(minToi, toi);
+                if (this->collisionDetector.TimeOfImpact(collider, startPosition, startOrientation, endPosition, endOrientation, corner, heightfield.GetPoint(row + 1, col), diagonal, toi))
+                    minToi = std::min(minToi, toi);
+            }
+        }
+    }
+    return minToi;
+}
+
+namespace
+{
+    bool CompareHits(const QueryHit& a, const QueryHit& b)
+    {
+        return a.distance < b.distance;
+    }
+
+    /**
+    Slab test of the cast against the bounds grown by the cast radius. Returns the entry distance or -1.
+    */
+    float CastBounds(const CastQuery& query, glm::vec3 min, glm::vec3 max, float maxDistance)
+    {
+        float tEnter = 0.f;
+        float tExit = maxDistance;
+        for (int k = 0; k < 3; k++)
+        {
+            float low = min[k] - query.radius;
+            float high = max[k] + query.radius;
+            if (std::abs(query.direction[k]) < 1e-8f)
+            {
+                if (query.origin[k] < low || query.origin[k] > high)
+                    return -1.f;
+                continue;
+            }
+            float inverse = 1.f / query.direction[k];
+            float t1 = (low - query.origin[k]) * inverse;
+            float t2 = (high - query.origin[k]) * inverse;
+            tEnter = std::max(tEnter, std::min(t1, t2));
+            tExit = std::min(tExit, std::max(t1, t2));
+            if (tEnter > tExit)
+                return -1.f;
+        }
+        return tEnter;
+    }
+}
+
+void Grid::GetCellRange(int level, glm::vec3 min, glm::vec3 max, int& minRow, int& maxRow, int& minCol, int& maxCol)
+{
+    // colliders are stored in the cell of their center and are at most a cell wide,
+    // so look one cell further in every direction
+    int levelCellsInRow = this->GetCells(level).size();
+    this->Locate(level, min, minRow, minCol);
+    this->Locate(level, max, maxRow, maxCol);
+    minRow = std::max(minRow - 1, 0);
+    maxRow = std::min(maxRow + 1, levelCellsInRow - 1);
+    minCol = std::max(minCol - 1, 0);
+    maxCol = std::min(maxCol + 1, levelCellsInRow - 1);
+}
+
+void Grid::Locate(int level, glm::vec3 point, int& row, int& col)
+{
+    if (level == 0)
+    {
+        row = this->GetInsertRow(point);
+        col = this->GetInsertCol(point);
+        return;
+    }
+    int levelCellsInRow = this->GetCells(level).size();
+    float cellWidth = 2 * this->halfWidth * (1 << level);
+    row = std::min(std::max((int)floorf(point.z / cellWidth), 0), levelCellsInRow - 1);
+    col = std::min(std::max((int)floorf(point.x / cellWidth), 0), levelCellsInRow - 1);
+}
+
+void Grid::Cast(CollisionDetector& detector, std::vector<std::shared_ptr<Collider>>& parts, const CastQuery& query, std::vector<QueryHit>* hits, QueryHit& closest)
+{
+    closest.collider = nullptr;
+    closest.entityID = -1;
+    closest.distance = query.maxDistance;
+
+    glm::vec3 end = query.origin + query.direction * query.maxDistance;
+    glm::vec3 castMin = glm::min(query.origin, end) - query.radius;
+    glm::vec3 castMax = glm::max(query.origin, end) + query.radius;
+
+    QueryHit hit;
+    for (int level = 0; level < this->levelCounts.size(); level++)
+    {
+        if (this->levelCounts[level] == 0)
+            continue;
+        std::vector<std::vector<Cell>>& levelCells = this->GetCells(level);
+        int minRow, maxRow, minCol, maxCol;
+        this->GetCellRange(level, castMin, castMax, minRow, maxRow, minCol, maxCol);
+        for (int row = minRow; row <= maxRow; row++)
+        {
+            for (int col = minCol; col <= maxCol; col++)
+            {
+                for (int type = 0; type < 2; type++)
+                {
+                    const std::vector<std::shared_ptr<Collider>>& colliders = type == 0 ? levelCells[row][col].GetStaticColliders()
+                                                                                        : levelCells[row][col].GetDynamicColliders();
+                    for (int i = 0; i < colliders.size(); i++)
+                    {
+                        parts.clear();
+                        this->GetParts(colliders[i], castMin, castMax, parts);
+                        for (int j = 0; j < parts.size(); j++)
+                        {
+                            Collider& collider = *parts[j];
+                            // when only the closest hit matters, anything starting behind it is skipped
+                            float maxDistance = hits != nullptr ? query.maxDistance : closest.distance;
+                            // sensors are volumes, not something a cast stops at
+                            if (collider.isSensor || CastBounds(query, collider.aabbMin, collider.aabbMax, maxDistance) < 0.f)
+                                continue;
+                            bool isHit = query.radius > 0.f ? detector.SphereCast(collider, query.origin, query.direction, query.radius, maxDistance, hit)
+                                                            : detector.Raycast(collider, query.origin, query.direction, maxDistance, hit);
+                            if (!isHit)
+                                continue;
+                            if (hits != nullptr)
+                                hits->push_back(hit);
+                            if (closest.collider == nullptr || hit.distance < closest.distance)
+                                closest = hit;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (query.radius > 0.f)
+        return;
+    for (int i = 0; i < this->meshes.size(); i++)
+    {
+        TriangleMesh& mesh = *this->meshes[i];
+        float maxDistance = hits != nullptr ? query.maxDistance : closest.distance;
+        if (!mesh.Raycast(query.origin, query.direction, maxDistance, hit.distance, hit.normal))
+            continue;
+        hit.collider = mesh.GetCollider().get();
+        hit.entityID = hit.collider->entityID;
+        hit.point = query.origin + query.direction * hit.distance;
+        if (hits != nullptr)
+            hits->push_back(hit);
+        if (closest.collider == nullptr || hit.distance < closest.distance)
+            closest = hit;
+    }
+}
+
+int Grid::Raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, std::vector<QueryHit>& hits)
+{
+    return this->SphereCast(origin, direction, 0.f, maxDistance, hits);
+}
+
+int Grid::SphereCast(glm::vec3 origin, glm::vec3 direction, float radius, float maxDistance, std::vector<QueryHit>& hits)
+{
+    CastQuery query;
+    query.origin = origin;
+    query.direction = direction;
+    query.maxDistance = maxDistance;
+    query.radius = radius;
+
+    QueryHit closest;
+    hits.clear();
+    this->Cast(this->collisionDetector, this->queryParts, query, &hits, closest);
+    std::sort(hits.begin(), hits.end(), CompareHits);
+    return hits.size();
+}
+
+int Grid::OverlapBox(glm::vec3 center, glm::vec3 halfExtents, glm::quat orientation, std::vector<QueryHit>& hits)
+{
+    hits.clear();
+    // world bounds of the box, same projection as Collider::UpdateBounds
+    glm::mat3 rotation = glm::mat3_cast(orientation);
+    glm::vec3 worldHalfExtents = glm::abs(rotation[0]) * halfExtents.x +
+                                 glm::abs(rotation[1]) * halfExtents.y +
+                                 glm::abs(rotation[2]) * halfExtents.z;
+    glm::vec3 min = center - worldHalfExtents;
+    glm::vec3 max = center + worldHalfExtents;
+
+    std::vector<std::shared_ptr<Collider>>& parts = this->queryParts;
+    for (int level = 0; level < this->levelCounts.size(); level++)
+    {
+        if (this->levelCounts[level] == 0)
+            continue;
+        std::vector<std::vector<Cell>>& levelCells = this->GetCells(level);
+        int minRow, maxRow, minCol, maxCol;
+        this->GetCellRange(level, min, max, minRow, maxRow, minCol, maxCol);
+        for (int row = minRow; row <= maxRow; row++)
+        {
+            for (int col = minCol; col <= maxCol; col++)
+            {
+                for (int type = 0; type < 2; type++)
                 {
-                    collisions.push_back(collision);
+                    const std::vector<std::shared_ptr<Collider>>& colliders = type == 0 ? levelCells[row][col].GetStaticColliders()
+                                                                                        : levelCells[row][col].GetDynamicColliders();
+                    for (int i = 0; i < colliders.size(); i++)
+                    {
+                        parts.clear();
+                        this->GetParts(colliders[i], min, max, parts);
+                        for (int j = 0; j < parts.size(); j++)
+                        {
+                            Collider& collider = *parts[j];
+                            if (!glm::all(glm::lessThanEqual(min, collider.aabbMax)) || !glm::all(glm::lessThanEqual(collider.aabbMin, max)))
+                                continue;
+                            if (!this->collisionDetector.OverlapBox(collider, center, halfExtents, orientation))
+                                continue;
+                            QueryHit hit;
+                            hit.collider = &collider;
+                            hit.entityID = collider.entityID;
+                            hit.distance = 0.f;
+                            hit.point = collider.center;
+                            hit.normal = glm::vec3(0.f, 0.f, 0.f);
+                            hits.push_back(hit);
+                        }
+                    }
                 }
             }
         }
     }
-    return collisions;
+    return hits.size();
+}
+
+void Grid::CastBatch(const std::vector<CastQuery>& queries, std::vector<QueryHit>& results, int threadCount)
+{
+    results.resize(queries.size());
+    if (threadCount <= 0)
+        threadCount = std::max((int)std::thread::hardware_concurrency(), 1);
+    threadCount = std::min(threadCount, std::max((int)queries.size(), 1));
+
+    // contiguous chunks, each thread owns a detector and a parts buffer for its scratch
+    int chunk = (queries.size() + threadCount - 1) / threadCount;
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; t++)
+    {
+        threads.emplace_back([this, &queries, &results, chunk, t]()
+        {
+            CollisionDetector detector;
+            std::vector<std::shared_ptr<Collider>> parts;
+            int end = std::min((int)queries.size(), (t + 1) * chunk);
+            for (int i = t * chunk; i < end; i++)
+                this->Cast(detector, parts, queries[i], nullptr, results[i]);
+        });
+    }
+    // the calling thread takes the first chunk, with the scratch of the grid
+    int end = std::min((int)queries.size(), chunk);
+    for (int i = 0; i < end; i++)
+        this->Cast(this->collisionDetector, this->queryParts, queries[i], nullptr, results[i]);
+    for (int t = 0; t < threads.size(); t++)
+        threads[t].join();
+}
+
+const CollisionStats& Grid::GetCollisionStats()
+{
+    return this->collisionDetector.GetStats();
+}
+
+void Grid::ResetCollisionStats()
+{
+    this->collisionDetector.ResetStats();
 }
 
 void Grid::Insert(std::shared_ptr<Collider> object)
 {
-    int col = this->GetInsertCol(object->center);
-    int row = this->GetInsertRow(object->center);
-    this->cells[row][col].Insert(object);
+    // the center of the bounds, so both sides of a collider are within half a cell of it
+    int level = this->GetLevel(object->aabbMin, object->aabbMax);
+    int row, col;
+    this->Locate(level, (object->aabbMin + object->aabbMax) * 0.5f, row, col);
+    this->GetCells(level)[row][col].Insert(object);
+    object->level = level;
+    this->levelCounts[level]++;
+}
+
+void Grid::Update(std::shared_ptr<Collider> object)
+{
+    int level = this->GetLevel(object->aabbMin, object->aabbMax);
+    int row, col;
+    this->Locate(level, (object->aabbMin + object->aabbMax) * 0.5f, row, col);
+    if (level != object->level || row != object->row || col != object->col)
+    {
+        this->Remove(object);
+        this->Insert(object);
+    }
+}
+
+void Grid::Insert(std::shared_ptr<Heightfield> heightfield)
+{
+    this->heightfields.push_back(heightfield);
+}
+
+void Grid::Insert(std::shared_ptr<TriangleMesh> mesh)
+{
+    this->meshes.push_back(mesh);
+}
+
+const std::vector<std::shared_ptr<Heightfield>>& Grid::GetHeightfields()
+{
+    return this->heightfields;
+}
+
+const std::vector<std::shared_ptr<TriangleMesh>>& Grid::GetMeshes()
+{
+    return this->meshes;
+}
+
+float Grid::GetGridLength()
+{
+    return this->gridLength;
+}
+
+float Grid::GetCellHalfWidth()
+{
+    return this->halfWidth;
 }
 
 void Grid::Remove(std::shared_ptr<Collider> object)
 {
     int row = object->row;
     int col = object->col;
-    this->cells[row][col].Remove(object);
+    this->GetCells(object->level)[row][col].Remove(object);
+    this->levelCounts[object->level]--;
+}
+
+int Grid::GetLevel(glm::vec3 min, glm::vec3 max)
+{
+    float extent = std::max(max.x - min.x, max.z - min.z);
+    int level = 0;
+    while (level < this->levelCounts.size() - 1 && extent > 2 * this->halfWidth * (1 << level))
+        level++;
+    return level;
+}
+
+int Grid::GetLevelCount()
+{
+    return this->levelCounts.size();
+}
+
+std::vector<std::vector<Cell>>& Grid::GetCells(int level)
+{
+    if (level == 0)
+        return this->cells;
+    return this->coarseCells[level - 1];
 }
 
 int Grid::GetInsertCol(glm::vec3 point)
@@ -176,7 +761,7 @@ int Grid::GetInsertRow(glm::vec3 point)
     return high;
 }
 
-std::vector<std::pair<int, int>> Grid::GetEligibleCells(int cellRow, int cellCol)
+std::vector<std::pair<int, int>> Grid::GetEligibleCells(int cellRow, int cellCol, int level)
 {
     // ---|---|
     //  x | x |
@@ -186,11 +771,12 @@ std::vector<std::pair<int, int>> Grid::GetEligibleCells(int cellRow, int cellCol
     //  x | x |
     // ---|---|
     std::vector<std::pair<int, int>> result;
+    std::vector<std::vector<Cell>>& levelCells = this->GetCells(level);
     for (int row = -1; row < 2; row++)
     {
         for (int col = 0; col < 2; col++)
         {
-            if (cellRow + row >= 0 && cellRow + row < this->cells.size() && cellCol + col < this->cells[0].size())
+            if (cellRow + row >= 0 && cellRow + row < levelCells.size() && cellCol + col < levelCells[0].size())
             {
                 result.push_back(std::make_pair<int, int>(cellRow + row, cellCol + col));
             }
@@ -5,20 +5,43 @@
 #include "Cell.hpp"
 #include "Collider.hpp"
 #include "CollisionDetector.hpp"
+#include "Heightfield.hpp"
+#include "TriangleMesh.hpp"
+#include "CompoundCollider.hpp"
+#include "PairCache.hpp"
 
 class Grid
 {
     public:
         
         /**
-        Divides the 3d space into a 2d grid
+        Divides the 3d space into a 2d grid. The grid is hierarchical, every level doubles the cell size of the
+        one below it until a single cell covers the whole grid. Level 0 has cells of the given half width.
          */
         Grid(float gridLength, float halfWidth);
         /** 
-        Insert a Collider collider
+        Insert a Collider collider. It goes to the lowest level whose cells are at least as wide as its bounds,
+        into the cell holding its center.
          */
         void Insert(std::shared_ptr<Collider>   object);
 
+        /**
+        Update moves a collider to its new cell (and level, its bounds can grow when it rotates) after it moved.
+         */
+        void Update(std::shared_ptr<Collider>   object);
+
+        /**
+        Adds a terrain. Heightfields are not stored in the cells, every dynamic collider in the
+        cells they cover is tested against them.
+         */
+        void Insert(std::shared_ptr<Heightfield> heightfield);
+
+        /**
+        Adds static concave geometry. Like heightfields, meshes live outside of the cells.
+        Raycasts test them too, sphere casts and overlaps do not.
+         */
+        void Insert(std::shared_ptr<TriangleMesh> mesh);
+
         /** 
         Deletes an object from the grid.
          */
@@ -26,10 +49,65 @@ class Grid
         
         /**
         Performs a collision check on all the cells and generates contact data.
+        The broadphase updates the pair cache with the colliders whose bounds overlap, then the narrowphase
+        runs on the active pairs only. Colliders of a level are tested with the neighbour cells of the same
+        level, and each collider with the larger colliders of every coarser level around its center.
+        The collisions are valid until the next call, their contacts and colliders are in GetContactArena.
+         */
+        const std::vector<Collision>& CheckCollisions();
+
+        /**
+        Reports the overlapping pairs of two cells of a level to the pair cache.
+         */
+        void CheckCells(int rowA, int colA, int rowB, int colB, int level = 0);
+
+        /**
+        Contacts and colliders of the collisions of the last CheckCollisions.
+        */
+        ContactArena& GetContactArena();
+
+        /**
+        Broadphase pairs of the last CheckCollisions and the pairs added / removed by it.
+         */
+        PairCache& GetPairCache();
+
+        /**
+        Sensor pairs found overlapping by the last CheckCollisions. They are not part of the returned collisions.
          */
-        std::vector<std::shared_ptr<Collision>> CheckCollisions();
+        const std::vector<std::pair<std::shared_ptr<Collider>, std::shared_ptr<Collider>>>& GetSensorOverlaps();
 
-        std::vector<std::shared_ptr<Collision>> CheckCells(int rowA, int colA, int rowB, int colB);
+        const std::vector<std::shared_ptr<Heightfield>>&    GetHeightfields();
+        const std::vector<std::shared_ptr<TriangleMesh>>&   GetMeshes();
+        float GetGridLength();
+        float GetCellHalfWidth();
+
+        /**
+        Sweep is the continuous test for a fast collider moving from the start to the end body pose.
+        Static colliders, mesh triangles and terrain triangles overlapping the swept AABB are tested with
+        conservative advancement. Returns the earliest time of impact as a fraction of the motion, 1 if nothing is hit.
+         */
+        float Sweep(std::shared_ptr<Collider>   collider,
+                    glm::vec3                   startPosition,
+                    glm::quat                   startOrientation,
+                    glm::vec3                   endPosition,
+                    glm::quat                   endOrientation);
+
+        // =============
+        // Scene queries
+        // =============
+        // Hits are written to the given vector (cleared first) sorted by distance and their count is returned.
+        // The vectors keep their capacity, so queries do not allocate once they are warm.
+
+        int Raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, std::vector<QueryHit>& hits);
+        int SphereCast(glm::vec3 origin, glm::vec3 direction, float radius, float maxDistance, std::vector<QueryHit>& hits);
+        int OverlapBox(glm::vec3 center, glm::vec3 halfExtents, glm::quat orientation, std::vector<QueryHit>& hits);
+
+        /**
+        CastBatch runs every query for its closest hit, split over threadCount threads (0 - one per core).
+        results[i] gets the hit of queries[i], with a null collider if nothing was hit.
+        Every thread uses its own CollisionDetector, the grid must not be modified during the batch.
+         */
+        void CastBatch(const std::vector<CastQuery>& queries, std::vector<QueryHit>& results, int threadCount = 0);
 
         // ===============
         // Utility methods
@@ -38,7 +116,7 @@ class Grid
         /** 
         Returns a vector of pairs denoting the cells to be checked for collision detection
         */
-        std::vector<std::pair<int, int>> GetEligibleCells(int cellRow, int cellCol);
+        std::vector<std::pair<int, int>> GetEligibleCells(int cellRow, int cellCol, int level = 0);
         
         /** 
         GetInsertRow returns the row of the cell that the object needs to get inserted into
@@ -50,12 +128,77 @@ class Grid
          */
         int  GetInsertCol(glm::vec3 point);
 
+        /**
+        GetLevel returns the level for colliders with the given bounds. Only the horizontal extent counts.
+         */
+        int  GetLevel(glm::vec3 min, glm::vec3 max);
+        int  GetLevelCount();
+
+        /**
+        Cells of a level, level 0 is cells.
+         */
+        std::vector< std::vector< Cell > >& GetCells(int level);
+
+        /**
+        Narrowphase counters accumulated since the last ResetCollisionStats.
+         */
+        const CollisionStats& GetCollisionStats();
+        void ResetCollisionStats();
+
+        // the finest level
         std::vector< std::vector< Cell > > cells;
 
     private:
 
+        /**
+        CheckPair runs the filter on a candidate pair and reports it to the pair cache if the bounds overlap.
+        Compounds are opened, their children form the pairs. depth is the compound nesting, it picks the scratch buffer.
+         */
+        void CheckPair(std::shared_ptr<Collider> first, std::shared_ptr<Collider> second, int depth = 0);
+
+        /**
+        Cast tests every collider whose cell range and bounds the cast can reach. With hits it collects all
+        of them, otherwise only the closest one is kept in closest (distance = maxDistance if none).
+        detector and parts are the scratch of the calling thread.
+         */
+        void Cast(CollisionDetector& detector, std::vector<std::shared_ptr<Collider>>& parts, const CastQuery& query, std::vector<QueryHit>* hits, QueryHit& closest);
+
+        /**
+        GetParts appends the collider itself, or for a compound its children overlapping the given bounds.
+         */
+        void GetParts(std::shared_ptr<Collider> collider, glm::vec3 min, glm::vec3 max, std::vector<std::shared_ptr<Collider>>& parts);
+
+        /**
+        CheckCoarser tests a collider with the colliders of every coarser level in the cells around its center.
+         */
+        void CheckCoarser(std::shared_ptr<Collider> collider);
+
+        /**
+        Cell range (clamped to the grid) of a level that can hold colliders overlapping the given bounds.
+         */
+        void GetCellRange(int level, glm::vec3 min, glm::vec3 max, int& minRow, int& maxRow, int& minCol, int& maxCol);
+
+        /**
+        Row and column of the cell of a level holding the point.
+         */
+        void Locate(int level, glm::vec3 point, int& row, int& col);
+
         int     cellsInRow;
         float   halfWidth;
         float   gridLength;
+        // levels 1 and up, cell half width halfWidth * 2^level
+        std::vector< std::vector< std::vector< Cell > > > coarseCells;
+        // colliders stored at each level, empty levels are skipped
+        std::vector<int> levelCounts;
         CollisionDetector collisionDetector;
+        PairCache         pairCache;
+        ContactArena      contactArena;
+        std::vector<std::pair<std::shared_ptr<Collider>, std::shared_ptr<Collider>>> sensorOverlaps;
+        // scratch for the compound children, kept so warm queries and broadphase passes do not allocate
+        std::vector<std::shared_ptr<Collider>> queryParts;
+        std::vector<std::vector<std::shared_ptr<Collider>>> pairParts;
+        // mesh triangles under the swept bounds
+        std::vector<int> sweepTriangles;
+        std::vector<std::shared_ptr<Heightfield>> heightfields;
+        std::vector<std::shared_ptr<TriangleMesh>> meshes;
 };
\ No newline at end of file
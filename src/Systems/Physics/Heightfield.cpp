@@ -0,0 +1,153 @@
+#include "Heightfield.hpp"
+#include <cmath>
+#include <cassert>
+#include <limits>
+#include <algorithm>
+#include "ColliderBuilder.hpp"
+
+Heightfield::Heightfield(int entityID, glm::vec3 origin, int rows, int cols, float spacing, const std::vector<float>& heights) : \
+                        origin(origin),
+                        rows(rows),
+                        cols(cols),
+                        spacing(spacing)
+{
+    assert(rows > 1 && cols > 1 && heights.size() == rows * cols);
+    float minHeight = *std::min_element(heights.begin(), heights.end());
+    float maxHeight = *std::max_element(heights.begin(), heights.end());
+    this->heightOffset = minHeight;
+    this->heightScale = (maxHeight - minHeight) / std::numeric_limits<std::uint16_t>::max();
+    this->samples.resize(heights.size());
+    for (int i = 0; i < heights.size(); i++)
+    {
+        float sample = this->heightScale > 0.f ? (heights[i] - minHeight) / this->heightScale : 0.f;
+        this->samples[i] = (std::uint16_t)(sample + 0.5f);
+    }
+
+    this->BuildBounds(entityID);
+}
+
+Heightfield::Heightfield(   int entityID,
+                            glm::vec3 origin,
+                            int rows,
+                            int cols,
+                            float spacing,
+                            float heightOffset,
+                            float heightScale,
+                            const std::vector<std::uint16_t>& samples) : \
+                            origin(origin),
+                            rows(rows),
+                            cols(cols),
+                            spacing(spacing),
+                            heightOffset(heightOffset),
+                            heightScale(heightScale),
+                            samples(samples)
+{
+    assert(rows > 1 && cols > 1 && samples.size() == rows * cols);
+    this->BuildBounds(entityID);
+}
+
+void Heightfield::BuildBounds(int entityID)
+{
+    // bounds of the quantized samples, so a restored heightfield gets the same ones
+    std::uint16_t maxSample = *std::max_element(this->samples.begin(), this->samples.end());
+    float minHeight = this->heightOffset;
+    float maxHeight = this->heightOffset + maxSample * this->heightScale;
+    this->aabbMin = glm::vec3(this->origin.x, this->origin.y + minHeight, this->origin.z);
+    this->aabbMax = glm::vec3(this->origin.x + (this->cols - 1) * this->spacing, this->origin.y + maxHeight, this->origin.z + (this->rows - 1) * this->spacing);
+
+    // one unit thick below the lowest sample so the proxy is never flat
+    this->collider = ColliderBuilder::BuildBox(entityID, DynamicType::Static, this->aabbMin - glm::vec3(0.f, 1.f, 0.f), this->aabbMax);
+}
+
+float Heightfield::GetHeight(int row, int col)
+{
+    return this->origin.y + this->heightOffset + this->samples[row * this->cols + col] * this->heightScale;
+}
+
+glm::vec3 Heightfield::GetPoint(int row, int col)
+{
+    return glm::vec3(this->origin.x + col * this->spacing, this->GetHeight(row, col), this->origin.z + row * this->spacing);
+}
+
+bool Heightfield::GetSurface(float x, float z, float& height, glm::vec3& normal)
+{
+    float fx = (x - this->origin.x) / this->spacing;
+    float fz = (z - this->origin.z) / this->spacing;
+    if (fx < 0.f || fz < 0.f || fx > this->cols - 1 || fz > this->rows - 1)
+        return false;
+    int col = std::min((int)fx, this->cols - 2);
+    int row = std::min((int)fz, this->rows - 2);
+    float u = fx - col;
+    float v = fz - row;
+
+    float h00 = this->GetHeight(row, col);
+    float h01 = this->GetHeight(row, col + 1);
+    float h10 = this->GetHeight(row + 1, col);
+    float h11 = this->GetHeight(row + 1, col + 1);
+    // slopes of the triangle along x and z
+    float slopeX, slopeZ;
+    if (u >= v)
+    {
+        slopeX = h01 - h00;
+        slopeZ = h11 - h01;
+    }
+    else
+    {
+        slopeX = h11 - h10;
+        slopeZ = h10 - h00;
+    }
+    height = h00 + u * slopeX + v * slopeZ;
+    normal = glm::normalize(glm::vec3(-slopeX / this->spacing, 1.f, -slopeZ / this->spacing));
+    return true;
+}
+
+bool Heightfield::GetCellRange(glm::vec3 min, glm::vec3 max, int& minRow, int& maxRow, int& minCol, int& maxCol)
+{
+    if (max.x < this->aabbMin.x || max.z < this->aabbMin.z || min.x > this->aabbMax.x || min.z > this->aabbMax.z)
+        return false;
+    minCol = std::max(0, (int)std::floor((min.x - this->origin.x) / this->spacing));
+    maxCol = std::min(this->cols - 2, (int)std::floor((max.x - this->origin.x) / this->spacing));
+    minRow = std::max(0, (int)std::floor((min.z - this->origin.z) / this->spacing));
+    maxRow = std::min(this->rows - 2, (int)std::floor((max.z - this->origin.z) / this->spacing));
+    return true;
+}
+
+std::shared_ptr<Collider> Heightfield::GetCollider()
+{
+    return this->collider;
+}
+
+int Heightfield::GetRows()
+{
+    return this->rows;
+}
+
+int Heightfield::GetCols()
+{
+    return this->cols;
+}
+
+glm::vec3 Heightfield::GetOrigin()
+{
+    return this->origin;
+}
+
+float Heightfield::GetSpacing()
+{
+    return this->spacing;
+}
+
+float Heightfield::GetHeightOffset()
+{
+    return this->heightOffset;
+}
+
+float Heightfield::GetHeightScale()
+{
+    return this->heightScale;
+}
+
+const std::vector<std::uint16_t>& Heightfield::GetSamples()
+{
+    return this->samples;
+}
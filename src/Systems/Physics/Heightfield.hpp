@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "Collider.hpp"
+
+/**
+Heightfield - static terrain given as a regular grid of heights. Rows run along z and columns along x,
+sample (row, col) sits at origin + (col * spacing, height, row * spacing).
+Every cell is split into two triangles along its (row, col) - (row + 1, col + 1) diagonal.
+Heights are quantized to 16 bits over the height range, so a sample costs 2 bytes.
+*/
+class Heightfield
+{
+    public:
+        /**
+        heights are row major, rows * cols of them.
+        */
+        Heightfield(int entityID, glm::vec3 origin, int rows, int cols, float spacing, const std::vector<float>& heights);
+
+        /**
+        Restores a heightfield from its quantized samples, bit exact (used by the physics recordings).
+        */
+        Heightfield(int entityID,
+                    glm::vec3 origin,
+                    int rows,
+                    int cols,
+                    float spacing,
+                    float heightOffset,
+                    float heightScale,
+                    const std::vector<std::uint16_t>& samples);
+
+        float       GetHeight(int row, int col);
+        glm::vec3   GetPoint(int row, int col);
+
+        /**
+        GetSurface returns the height and the normal of the triangle under (x, z).
+        Returns false if the point is outside the heightfield.
+        */
+        bool GetSurface(float x, float z, float& height, glm::vec3& normal);
+
+        /**
+        GetCellRange - cells overlapped by the given bounds in the xz plane, clamped to the heightfield.
+        Returns false if the bounds miss the heightfield.
+        */
+        bool GetCellRange(glm::vec3 min, glm::vec3 max, int& minRow, int& maxRow, int& minCol, int& maxCol);
+
+        /**
+        Static collider spanning the bounds of the heightfield. It stands for the terrain in the
+        collisions and carries its entity ID, layer and mask, it is never inserted into the grid.
+        */
+        std::shared_ptr<Collider> GetCollider();
+
+        int GetRows();
+        int GetCols();
+        glm::vec3 GetOrigin();
+        float GetSpacing();
+        float GetHeightOffset();
+        float GetHeightScale();
+        const std::vector<std::uint16_t>& GetSamples();
+
+        // world bounds
+        glm::vec3   aabbMin;
+        glm::vec3   aabbMax;
+
+    private:
+        /**
+        Computes the world bounds from the samples and builds the proxy collider.
+        */
+        void BuildBounds(int entityID);
+
+        glm::vec3                   origin;
+        int                         rows;
+        int                         cols;
+        float                       spacing;
+        // height = heightOffset + sample * heightScale
+        float                       heightOffset;
+        float                       heightScale;
+        std::vector<std::uint16_t>  samples;
+        std::shared_ptr<Collider>   collider;
+};
@@ -0,0 +1,135 @@
+#include "HullCache.hpp"
+#include "BinaryIO.hpp"
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+
+using namespace BinaryIO;
+
+namespace
+{
+    const std::uint32_t magic = 0x4c554848; // "HHUL"
+
+    struct CacheHeader
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t count;
+        std::uint32_t padding;
+        std::uint64_t payloadSize;
+        std::uint64_t checksum;
+    };
+}
+
+HullCache::HullCache(std::string filename) : filename(filename), isDirty(false)
+{
+
+}
+
+bool HullCache::Load()
+{
+    this->hulls.clear();
+    this->isDirty = false;
+
+    std::ifstream file(this->filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+    std::streamsize fileSize = file.tellg();
+    if (fileSize < (std::streamsize)sizeof(CacheHeader))
+        return false;
+    std::vector<char> buffer(fileSize);
+    file.seekg(0, std::ios::beg);
+    if (!file.read(buffer.data(), fileSize))
+        return false;
+
+    CacheHeader header;
+    std::memcpy(&header, buffer.data(), sizeof(CacheHeader));
+    const char* payload = buffer.data() + sizeof(CacheHeader);
+    std::size_t payloadSize = fileSize - sizeof(CacheHeader);
+    if (header.magic != magic || header.version != HullCache::version || header.payloadSize != payloadSize)
+        return false;
+    if (header.checksum != Fnv1a(payload, payloadSize))
+        return false;
+
+    Reader reader(payload, payloadSize);
+    std::unordered_map<std::uint64_t, std::shared_ptr<const Hull>> loaded;
+    for (std::uint32_t i = 0; i < header.count && reader.isValid; i++)
+    {
+        std::uint64_t key = reader.Read<std::uint64_t>();
+        loaded[key] = ReadHull(reader);
+    }
+    if (!reader.isValid || reader.offset != payloadSize)
+        return false;
+
+    this->hulls.swap(loaded);
+    return true;
+}
+
+bool HullCache::Save()
+{
+    if (!this->isDirty)
+        return true;
+
+    std::vector<char> payload;
+    for (std::unordered_map<std::uint64_t, std::shared_ptr<const Hull>>::iterator it = this->hulls.begin(); it != this->hulls.end(); it++)
+    {
+        Write(payload, it->first);
+        WriteHull(payload, *it->second);
+    }
+
+    CacheHeader header;
+    header.magic = magic;
+    header.version = HullCache::version;
+    header.count = this->hulls.size();
+    header.padding = 0;
+    header.payloadSize = payload.size();
+    header.checksum = Fnv1a(payload.data(), payload.size());
+
+    // write to a temporary file first so a crash never leaves a half written cache behind
+    std::string temporary = this->filename + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+        file.write(payload.data(), payload.size());
+        if (!file.good())
+            return false;
+    }
+    if (std::rename(temporary.c_str(), this->filename.c_str()) != 0)
+        return false;
+    this->isDirty = false;
+    return true;
+}
+
+std::shared_ptr<const Hull> HullCache::Find(std::uint64_t key)
+{
+    std::unordered_map<std::uint64_t, std::shared_ptr<const Hull>>::iterator it = this->hulls.find(key);
+    if (it == this->hulls.end())
+        return nullptr;
+    return it->second;
+}
+
+void HullCache::Insert(std::uint64_t key, std::shared_ptr<const Hull> hull)
+{
+    this->hulls[key] = hull;
+    this->isDirty = true;
+}
+
+std::uint64_t HullCache::Hash(const std::vector<glm::vec3>& points)
+{
+    std::uint64_t count = points.size();
+    std::uint64_t hash = Fnv1a(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (int i = 0; i < points.size(); i++)
+    {
+        // -0.f and 0.f are the same point
+        glm::vec3 point = points[i] + glm::vec3(0.f, 0.f, 0.f);
+        hash = Fnv1a(reinterpret_cast<const char*>(&point[0]), 3 * sizeof(float), hash);
+    }
+    return hash;
+}
+
+int HullCache::Size()
+{
+    return this->hulls.size();
+}
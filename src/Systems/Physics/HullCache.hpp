@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+#include "Collider.hpp"
+
+/**
+HullCache - persistent store of built hulls, keyed by a hash of the points they were built from.
+The whole file is read at once on Load and rejected if the version or the checksum do not match,
+in that case the hulls are simply rebuilt and the file rewritten on Save.
+The file uses the native byte order, it is a local cache and not meant to be shipped.
+*/
+class HullCache
+{
+    public:
+        HullCache(std::string filename);
+
+        /**
+        Reads the cache file. Returns false if it is missing or invalid, the cache is then empty.
+        */
+        bool Load();
+
+        /**
+        Writes every hull to the cache file. Does nothing if no hull was added since the last Load/Save.
+        */
+        bool Save();
+
+        std::shared_ptr<const Hull> Find(std::uint64_t key);
+        void                        Insert(std::uint64_t key, std::shared_ptr<const Hull> hull);
+
+        /**
+        Content hash of the input points (FNV-1a over the raw floats).
+        */
+        static std::uint64_t Hash(const std::vector<glm::vec3>& points);
+
+        int Size();
+
+        // bump whenever the hull builder output or the file layout changes
+        static const std::uint32_t version = 2;
+
+    private:
+        std::string                                                     filename;
+        std::unordered_map<std::uint64_t, std::shared_ptr<const Hull>>  hulls;
+        bool                                                            isDirty;
+};
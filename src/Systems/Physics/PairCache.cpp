@@ -0,0 +1,89 @@
+#include "PairCache.hpp"
+#include <algorithm>
+
+PairCache::PairCache() : frame(0)
+{
+
+}
+
+std::uint64_t PairCache::Key(const Collider& first, const Collider& second)
+{
+    std::uint64_t low = std::min(first.id, second.id);
+    std::uint64_t high = std::max(first.id, second.id);
+    return (high << 32) | low;
+}
+
+void PairCache::BeginFrame()
+{
+    this->frame++;
+    this->events.clear();
+}
+
+BroadphasePair& PairCache::Report(std::shared_ptr<Collider> first, std::shared_ptr<Collider> second)
+{
+    std::uint64_t key = PairCache::Key(*first, *second);
+    std::unordered_map<std::uint64_t, int>::iterator it = this->indices.find(key);
+    if (it != this->indices.end())
+    {
+        BroadphasePair& pair = this->pairs[it->second];
+        // reported once per frame, the age only counts frames
+        if (pair.frame != this->frame)
+            pair.age++;
+        pair.frame = this->frame;
+        // colliders can become sensors at any time
+        pair.isSensor = first->isSensor || second->isSensor;
+        return pair;
+    }
+
+    BroadphasePair pair;
+    pair.first = first;
+    pair.second = second;
+    pair.key = key;
+    pair.isSensor = first->isSensor || second->isSensor;
+    pair.frame = this->frame;
+    pair.age = 0;
+    pair.collision = -1;
+    this->indices[key] = this->pairs.size();
+    this->pairs.push_back(pair);
+    this->events.push_back({PairEvent::Added, first, second});
+    return this->pairs.back();
+}
+
+void PairCache::EndFrame()
+{
+    for (int i = 0; i < this->pairs.size();)
+    {
+        if (this->pairs[i].frame == this->frame)
+        {
+            i++;
+            continue;
+        }
+        // swap with the last pair, the index of the moved pair changes
+        this->events.push_back({PairEvent::Removed, this->pairs[i].first, this->pairs[i].second});
+        this->indices.erase(this->pairs[i].key);
+        if (i != this->pairs.size() - 1)
+        {
+            this->pairs[i] = std::move(this->pairs.back());
+            this->indices[this->pairs[i].key] = i;
+        }
+        this->pairs.pop_back();
+    }
+}
+
+BroadphasePair* PairCache::Find(const Collider& first, const Collider& second)
+{
+    std::unordered_map<std::uint64_t, int>::iterator it = this->indices.find(PairCache::Key(first, second));
+    if (it == this->indices.end())
+        return nullptr;
+    return &this->pairs[it->second];
+}
+
+std::vector<BroadphasePair>& PairCache::GetPairs()
+{
+    return this->pairs;
+}
+
+const std::vector<PairEvent>& PairCache::GetEvents()
+{
+    return this->events;
+}
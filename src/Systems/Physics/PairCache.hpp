@@ -0,0 +1,94 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+#include "Collider.hpp"
+
+/**
+BroadphasePair - two colliders whose bounds overlap. The pair lives as long as the bounds keep overlapping,
+so whatever the narrowphase wants to keep between frames for the pair is stored here.
+*/
+struct BroadphasePair
+{
+    // in the order the broadphase found them first, the narrowphase keeps that order
+    std::shared_ptr<Collider>   first;
+    std::shared_ptr<Collider>   second;
+    std::uint64_t               key;
+    bool                        isSensor;
+    // frame the pair was last reported by the broadphase
+    int                         frame;
+    // frames the pair has existed for, 0 on the frame it was added
+    int                         age;
+    // index of the collision of the last narrowphase run in the grid contact arena, -1 while the colliders are not touching
+    int                         collision;
+};
+
+/**
+PairEvent - a pair starting or ending to overlap. Removed pairs are reported with their colliders even if
+the colliders left the grid.
+*/
+struct PairEvent
+{
+    enum Type
+    {
+        Added,
+        Removed
+    };
+
+    Type                        type;
+    std::shared_ptr<Collider>   first;
+    std::shared_ptr<Collider>   second;
+};
+
+/**
+PairCache keeps the broadphase pairs between frames, looked up by a hash of the sorted collider ids.
+Every frame the broadphase reports the overlapping pairs between BeginFrame and EndFrame, EndFrame then
+drops the pairs that were not reported again. Pairs are only added or removed when the overlap
+begins or ends, and every change is recorded as an event of the frame.
+*/
+class PairCache
+{
+    public:
+        PairCache();
+
+        /**
+        Key of a pair, the same whichever collider comes first.
+        */
+        static std::uint64_t Key(const Collider& first, const Collider& second);
+
+        /**
+        BeginFrame clears the events of the previous frame.
+        */
+        void BeginFrame();
+
+        /**
+        Report marks the pair as overlapping this frame, adding it if it is new. Returns the pair.
+        */
+        BroadphasePair& Report(std::shared_ptr<Collider> first, std::shared_ptr<Collider> second);
+
+        /**
+        EndFrame removes the pairs that were not reported since BeginFrame.
+        */
+        void EndFrame();
+
+        /**
+        Returns the pair of the two colliders, nullptr if their bounds do not overlap.
+        */
+        BroadphasePair* Find(const Collider& first, const Collider& second);
+
+        /**
+        Active pairs in no particular order, the order changes when pairs are removed.
+        */
+        std::vector<BroadphasePair>&    GetPairs();
+        const std::vector<PairEvent>&   GetEvents();
+
+    private:
+        std::vector<BroadphasePair>                 pairs;
+        // key -> index in pairs
+        std::unordered_map<std::uint64_t, int>      indices;
+        std::vector<PairEvent>                      events;
+        int                                         frame;
+};
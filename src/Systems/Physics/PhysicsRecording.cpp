@@ -0,0 +1,454 @@
+#include "PhysicsRecording.hpp"
+#include <chrono>
+#include <cstring>
+
+#include "../../Components/TransformComponent.hpp"
+#include "../Messaging/MoveData.hpp"
+#include "../Messaging/MouseMoveData.hpp"
+
+using namespace BinaryIO;
+
+namespace
+{
+    const std::uint32_t magic = 0x4352504c; // "LPRC"
+
+    struct RecordingHeader
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        float         gridLength;
+        float         cellHalfWidth;
+        std::uint64_t sceneSize;
+    };
+
+    const std::uint32_t physicsBitset = ComponentType::Physics | ComponentType::Transform;
+
+    template <typename T>
+    void WriteArray(std::vector<char>& buffer, const std::vector<T>& values)
+    {
+        Write(buffer, (std::uint32_t)values.size());
+        const char* bytes = reinterpret_cast<const char*>(values.data());
+        buffer.insert(buffer.end(), bytes, bytes + values.size() * sizeof(T));
+    }
+
+    template <typename T>
+    std::vector<T> ReadArray(Reader& reader)
+    {
+        std::vector<T> values(reader.ReadCount(sizeof(T)));
+        for (int i = 0; i < values.size(); i++)
+            values[i] = reader.Read<T>();
+        return values;
+    }
+
+    void WriteCollider(std::vector<char>& buffer, std::shared_ptr<Collider> collider)
+    {
+        Write(buffer, (std::uint32_t)collider->isCompound);
+        Write(buffer, (std::int32_t)collider->entityID);
+        Write(buffer, collider->center);
+        Write(buffer, collider->orientation);
+        Write(buffer, (std::uint32_t)collider->dynamicType);
+        Write(buffer, collider->layer);
+        Write(buffer, collider->mask);
+        Write(buffer, (std::uint32_t)collider->isSensor);
+        WriteHull(buffer, *collider->GetHull());
+        if (collider->isCompound)
+        {
+            std::shared_ptr<CompoundCollider> compound = std::static_pointer_cast<CompoundCollider>(collider);
+            const std::vector<std::shared_ptr<Collider>>& children = compound->GetChildren();
+            Write(buffer, (std::uint32_t)children.size());
+            for (int i = 0; i < children.size(); i++)
+                WriteCollider(buffer, children[i]);
+            WriteArray(buffer, compound->GetNodes());
+        }
+    }
+
+    std::shared_ptr<Collider> ReadCollider(Reader& reader, int depth = 0)
+    {
+        bool isCompound = reader.Read<std::uint32_t>() != 0;
+        int entityID = reader.Read<std::int32_t>();
+        glm::vec3 center = reader.Read<glm::vec3>();
+        glm::quat orientation = reader.Read<glm::quat>();
+        DynamicType dynamicType = (DynamicType)reader.Read<std::uint32_t>();
+        std::uint32_t layer = reader.Read<std::uint32_t>();
+        std::uint32_t mask = reader.Read<std::uint32_t>();
+        bool isSensor = reader.Read<std::uint32_t>() != 0;
+        std::shared_ptr<Hull> hull = ReadHull(reader);
+        if (!reader.isValid || hull->points.empty())
+        {
+            reader.isValid = false;
+            return nullptr;
+        }
+
+        std::shared_ptr<Collider> collider;
+        if (isCompound)
+        {
+            // compounds are never nested
+            std::vector<std::shared_ptr<Collider>> children(depth == 0 ? reader.ReadCount(1) : 0);
+            for (int i = 0; i < children.size() && reader.isValid; i++)
+                children[i] = ReadCollider(reader, depth + 1);
+            std::vector<BVHNode> nodes = ReadArray<BVHNode>(reader);
+            if (!reader.isValid || children.empty() || nodes.empty())
+            {
+                reader.isValid = false;
+                return nullptr;
+            }
+            collider = std::make_shared<CompoundCollider>(entityID, center, hull, dynamicType, children, nodes);
+        }
+        else
+        {
+            collider = std::make_shared<Collider>(entityID, center, hull, dynamicType);
+        }
+        collider->orientation = orientation;
+        collider->UpdateBounds();
+        collider->layer = layer;
+        collider->mask = mask;
+        collider->isSensor = isSensor;
+        return collider;
+    }
+
+    void WriteMessage(std::vector<char>& buffer, const Message& message)
+    {
+        Write(buffer, (std::int32_t)message.senderID);
+        Write(buffer, (std::int32_t)message.receiverID);
+        Write(buffer, (std::uint32_t)message.type);
+        if (message.type == MessageType::Move)
+        {
+            std::shared_ptr<MoveData> data = std::static_pointer_cast<MoveData>(message.data);
+            Write(buffer, (std::uint8_t)data->forward);
+            Write(buffer, (std::uint8_t)data->backward);
+            Write(buffer, (std::uint8_t)data->left);
+            Write(buffer, (std::uint8_t)data->right);
+        }
+        else if (message.type == MessageType::MouseMove)
+        {
+            std::shared_ptr<MouseMoveData> data = std::static_pointer_cast<MouseMoveData>(message.data);
+            Write(buffer, data->deltaX);
+            Write(buffer, data->deltaY);
+        }
+    }
+
+    Message ReadMessage(Reader& reader)
+    {
+        int senderID = reader.Read<std::int32_t>();
+        int receiverID = reader.Read<std::int32_t>();
+        std::uint32_t type = reader.Read<std::uint32_t>();
+        if (type >= MessageType::MessageTypeEnd)
+        {
+            reader.isValid = false;
+            type = MessageType::Move;
+        }
+        Message message(senderID, receiverID, (MessageType)type);
+        if (type == MessageType::Move)
+        {
+            bool forward = reader.Read<std::uint8_t>() != 0;
+            bool backward = reader.Read<std::uint8_t>() != 0;
+            bool left = reader.Read<std::uint8_t>() != 0;
+            bool right = reader.Read<std::uint8_t>() != 0;
+            message.data = std::make_shared<MoveData>(forward, backward, left, right);
+        }
+        else if (type == MessageType::MouseMove)
+        {
+            float deltaX = reader.Read<float>();
+            float deltaY = reader.Read<float>();
+            message.data = std::make_shared<MouseMoveData>(deltaX, deltaY);
+        }
+        return message;
+    }
+}
+
+PhysicsRecorder::PhysicsRecorder()
+{
+
+}
+
+PhysicsRecorder::~PhysicsRecorder()
+{
+    this->Close();
+}
+
+bool PhysicsRecorder::Open(std::string filename, std::vector<std::unique_ptr<Entity>>& entities, PhysicsSystem& physicsSystem)
+{
+    this->Close();
+    std::vector<char> scene;
+
+    // bodies
+    std::uint32_t count = 0;
+    for (int i = 0; i < entities.size(); i++)
+    {
+        if (entities[i]->IsEligibleForSystem(physicsBitset))
+            count++;
+    }
+    Write(scene, count);
+    for (int i = 0; i < entities.size(); i++)
+    {
+        if (!entities[i]->IsEligibleForSystem(physicsBitset))
+            continue;
+        PhysicsComponent* component = entities[i]->GetComponent<PhysicsComponent>(ComponentType::Physics);
+        TransformComponent* transform = entities[i]->GetComponent<TransformComponent>(ComponentType::Transform);
+        Write(scene, (std::int32_t)entities[i]->id);
+        Write(scene, component->inverseMass);
+        Write(scene, component->acceleration);
+        Write(scene, component->velocity);
+        Write(scene, component->position);
+        Write(scene, component->forceAccumulator);
+        Write(scene, component->angularAcc);
+        Write(scene, component->angularVel);
+        Write(scene, component->orientation);
+        Write(scene, component->torqueAccumulator);
+        Write(scene, component->invInertiaTensor);
+        Write(scene, component->invInertiaTensorLocal);
+        Write(scene, (std::uint32_t)component->dynamicType);
+        Write(scene, (std::uint32_t)component->isBullet);
+        Write(scene, transform->position);
+        Write(scene, transform->orientation);
+        Write(scene, (std::uint32_t)component->colliders.size());
+        for (int j = 0; j < component->colliders.size(); j++)
+            WriteCollider(scene, component->colliders[j]);
+    }
+
+    // static shapes living outside of the bodies
+    Grid& grid = physicsSystem.GetGrid();
+    const std::vector<std::shared_ptr<Heightfield>>& heightfields = grid.GetHeightfields();
+    Write(scene, (std::uint32_t)heightfields.size());
+    for (int i = 0; i < heightfields.size(); i++)
+    {
+        std::shared_ptr<Collider> proxy = heightfields[i]->GetCollider();
+        Write(scene, (std::int32_t)proxy->entityID);
+        Write(scene, proxy->layer);
+        Write(scene, proxy->mask);
+        Write(scene, heightfields[i]->GetOrigin());
+        Write(scene, (std::int32_t)heightfields[i]->GetRows());
+        Write(scene, (std::int32_t)heightfields[i]->GetCols());
+        Write(scene, heightfields[i]->GetSpacing());
+        Write(scene, heightfields[i]->GetHeightOffset());
+        Write(scene, heightfields[i]->GetHeightScale());
+        WriteArray(scene, heightfields[i]->GetSamples());
+    }
+    const std::vector<std::shared_ptr<TriangleMesh>>& meshes = grid.GetMeshes();
+    Write(scene, (std::uint32_t)meshes.size());
+    for (int i = 0; i < meshes.size(); i++)
+    {
+        std::shared_ptr<Collider> proxy = meshes[i]->GetCollider();
+        Write(scene, (std::int32_t)proxy->entityID);
+        Write(scene, proxy->layer);
+        Write(scene, proxy->mask);
+        WriteArray(scene, meshes[i]->GetVertices());
+        WriteArray(scene, meshes[i]->GetIndices());
+        WriteArray(scene, meshes[i]->GetNodes());
+    }
+
+    this->file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!this->file.is_open())
+        return false;
+    RecordingHeader header;
+    header.magic = magic;
+    header.version = PhysicsRecorder::version;
+    header.gridLength = grid.GetGridLength();
+    header.cellHalfWidth = grid.GetCellHalfWidth();
+    header.sceneSize = scene.size();
+    this->file.write(reinterpret_cast<const char*>(&header), sizeof(RecordingHeader));
+    this->file.write(scene.data(), scene.size());
+    return this->file.good();
+}
+
+void PhysicsRecorder::WriteTick(float dt, const std::vector<Message>& messages, std::vector<std::unique_ptr<Entity>>& entities)
+{
+    this->buffer.clear();
+    Write(this->buffer, dt);
+    Write(this->buffer, (std::uint32_t)messages.size());
+    for (int i = 0; i < messages.size(); i++)
+        WriteMessage(this->buffer, messages[i]);
+    Write(this->buffer, PhysicsRecorder::HashState(entities));
+    this->file.write(this->buffer.data(), this->buffer.size());
+}
+
+void PhysicsRecorder::Close()
+{
+    if (this->file.is_open())
+        this->file.close();
+}
+
+bool PhysicsRecorder::IsOpen()
+{
+    return this->file.is_open();
+}
+
+std::uint64_t PhysicsRecorder::HashState(std::vector<std::unique_ptr<Entity>>& entities)
+{
+    std::uint64_t hash = Fnv1a(nullptr, 0);
+    for (int i = 0; i < entities.size(); i++)
+    {
+        if (!entities[i]->IsEligibleForSystem(physicsBitset))
+            continue;
+        PhysicsComponent* component = entities[i]->GetComponent<PhysicsComponent>(ComponentType::Physics);
+        std::int32_t id = entities[i]->id;
+        hash = Fnv1a(reinterpret_cast<const char*>(&id), sizeof(id), hash);
+        hash = Fnv1a(reinterpret_cast<const char*>(&component->position), sizeof(glm::vec3), hash);
+        hash = Fnv1a(reinterpret_cast<const char*>(&component->orientation), sizeof(glm::quat), hash);
+        hash = Fnv1a(reinterpret_cast<const char*>(&component->velocity), sizeof(glm::vec3), hash);
+        hash = Fnv1a(reinterpret_cast<const char*>(&component->angularVel), sizeof(glm::vec3), hash);
+    }
+    return hash;
+}
+
+PhysicsReplay::PhysicsReplay() : gridLength(0.f), cellHalfWidth(0.f)
+{
+
+}
+
+bool PhysicsReplay::Load(std::string filename)
+{
+    this->scene.clear();
+    this->ticks.clear();
+
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+    std::streamsize fileSize = file.tellg();
+    if (fileSize < (std::streamsize)sizeof(RecordingHeader))
+        return false;
+    std::vector<char> buffer(fileSize);
+    file.seekg(0, std::ios::beg);
+    if (!file.read(buffer.data(), fileSize))
+        return false;
+
+    RecordingHeader header;
+    std::memcpy(&header, buffer.data(), sizeof(RecordingHeader));
+    if (header.magic != magic || header.version != PhysicsRecorder::version)
+        return false;
+    if (header.sceneSize > fileSize - sizeof(RecordingHeader))
+        return false;
+    this->gridLength = header.gridLength;
+    this->cellHalfWidth = header.cellHalfWidth;
+    const char* sceneData = buffer.data() + sizeof(RecordingHeader);
+    this->scene.assign(sceneData, sceneData + header.sceneSize);
+
+    const char* tickData = sceneData + header.sceneSize;
+    Reader reader(tickData, buffer.data() + fileSize - tickData);
+    while (!reader.AtEnd())
+    {
+        RecordedTick tick;
+        tick.dt = reader.Read<float>();
+        std::uint32_t messageCount = reader.ReadCount(3 * sizeof(std::int32_t));
+        for (std::uint32_t i = 0; i < messageCount && reader.isValid; i++)
+            tick.messages.push_back(ReadMessage(reader));
+        tick.stateHash = reader.Read<std::uint64_t>();
+        // a recording cut short by a crash still replays up to its last complete tick
+        if (!reader.isValid)
+            break;
+        this->ticks.push_back(tick);
+    }
+    return true;
+}
+
+std::unique_ptr<PhysicsSystem> PhysicsReplay::CreateScene(std::vector<std::unique_ptr<Entity>>& entities)
+{
+    std::unique_ptr<PhysicsSystem> physicsSystem = std::make_unique<PhysicsSystem>(this->gridLength, this->cellHalfWidth);
+    Reader reader(this->scene.data(), this->scene.size());
+
+    std::uint32_t count = reader.ReadCount(sizeof(std::int32_t));
+    for (std::uint32_t i = 0; i < count && reader.isValid; i++)
+    {
+        std::unique_ptr<Entity> entity = std::make_unique<Entity>(reader.Read<std::int32_t>());
+        std::unique_ptr<PhysicsComponent> component = std::make_unique<PhysicsComponent>(1.f, glm::vec3(0.f), glm::quat(1.f, 0.f, 0.f, 0.f), glm::mat3(1.f), DynamicType::Static);
+        component->inverseMass = reader.Read<float>();
+        component->acceleration = reader.Read<glm::vec3>();
+        component->velocity = reader.Read<glm::vec3>();
+        component->position = reader.Read<glm::vec3>();
+        component->forceAccumulator = reader.Read<glm::vec3>();
+        component->angularAcc = reader.Read<glm::vec3>();
+        component->angularVel = reader.Read<glm::vec3>();
+        component->orientation = reader.Read<glm::quat>();
+        component->torqueAccumulator = reader.Read<glm::vec3>();
+        component->invInertiaTensor = reader.Read<glm::mat3>();
+        component->invInertiaTensorLocal = reader.Read<glm::mat3>();
+        component->dynamicType = (DynamicType)reader.Read<std::uint32_t>();
+        component->isBullet = reader.Read<std::uint32_t>() != 0;
+        glm::vec3 transformPosition = reader.Read<glm::vec3>();
+        glm::quat transformOrientation = reader.Read<glm::quat>();
+
+        std::uint32_t colliderCount = reader.ReadCount(1);
+        for (std::uint32_t j = 0; j < colliderCount && reader.isValid; j++)
+        {
+            std::shared_ptr<Collider> collider = ReadCollider(reader);
+            if (collider == nullptr)
+                break;
+            collider->Attach(component->position, component->orientation);
+            component->colliders.push_back(collider);
+        }
+        physicsSystem->Insert(component->colliders);
+
+        entity->AddComponent(std::move(component));
+        entity->AddComponent(std::make_unique<TransformComponent>(transformPosition, transformOrientation));
+        entities.push_back(std::move(entity));
+    }
+
+    std::uint32_t heightfieldCount = reader.ReadCount(1);
+    for (std::uint32_t i = 0; i < heightfieldCount && reader.isValid; i++)
+    {
+        int entityID = reader.Read<std::int32_t>();
+        std::uint32_t layer = reader.Read<std::uint32_t>();
+        std::uint32_t mask = reader.Read<std::uint32_t>();
+        glm::vec3 origin = reader.Read<glm::vec3>();
+        int rows = reader.Read<std::int32_t>();
+        int cols = reader.Read<std::int32_t>();
+        float spacing = reader.Read<float>();
+        float heightOffset = reader.Read<float>();
+        float heightScale = reader.Read<float>();
+        std::vector<std::uint16_t> samples = ReadArray<std::uint16_t>(reader);
+        if (!reader.isValid || rows < 2 || cols < 2 || samples.size() != rows * cols)
+            break;
+        std::shared_ptr<Heightfield> heightfield = std::make_shared<Heightfield>(entityID, origin, rows, cols, spacing, heightOffset, heightScale, samples);
+        heightfield->GetCollider()->layer = layer;
+        heightfield->GetCollider()->mask = mask;
+        physicsSystem->Insert(heightfield);
+    }
+
+    std::uint32_t meshCount = reader.ReadCount(1);
+    for (std::uint32_t i = 0; i < meshCount && reader.isValid; i++)
+    {
+        int entityID = reader.Read<std::int32_t>();
+        std::uint32_t layer = reader.Read<std::uint32_t>();
+        std::uint32_t mask = reader.Read<std::uint32_t>();
+        std::vector<glm::vec3> vertices = ReadArray<glm::vec3>(reader);
+        std::vector<int> indices = ReadArray<int>(reader);
+        std::vector<BVHNode> nodes = ReadArray<BVHNode>(reader);
+        if (!reader.isValid || nodes.empty() || indices.size() % 3 != 0)
+            break;
+        std::shared_ptr<TriangleMesh> mesh = std::make_shared<TriangleMesh>(entityID, vertices, indices, nodes);
+        mesh->GetCollider()->layer = layer;
+        mesh->GetCollider()->mask = mask;
+        physicsSystem->Insert(mesh);
+    }
+    return physicsSystem;
+}
+
+int PhysicsReplay::Run(std::vector<double>& tickTimes, std::vector<std::uint64_t>& hashes)
+{
+    std::vector<std::unique_ptr<Entity>> entities;
+    std::unique_ptr<PhysicsSystem> physicsSystem = this->CreateScene(entities);
+    std::vector<Message> globalQueue;
+
+    int firstMismatch = -1;
+    tickTimes.resize(this->ticks.size());
+    hashes.resize(this->ticks.size());
+    for (int i = 0; i < this->ticks.size(); i++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        physicsSystem->Update(this->ticks[i].dt, entities, this->ticks[i].messages, globalQueue);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        globalQueue.clear();
+
+        tickTimes[i] = std::chrono::duration<double>(end - start).count();
+        hashes[i] = PhysicsRecorder::HashState(entities);
+        if (firstMismatch < 0 && hashes[i] != this->ticks[i].stateHash)
+            firstMismatch = i;
+    }
+
+    return firstMismatch;
+}
+
+const std::vector<RecordedTick>& PhysicsReplay::GetTicks()
+{
+    return this->ticks;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+#include "PhysicsSystem.hpp"
+#include "BinaryIO.hpp"
+
+/**
+RecordedTick - one PhysicsSystem::Update, the step, the messages the system got and the state hash after it.
+*/
+struct RecordedTick
+{
+    float                   dt;
+    std::vector<Message>    messages;
+    std::uint64_t           stateHash;
+};
+
+/**
+PhysicsRecorder writes a physics recording - the scene as it is when the recording is opened, then one record
+per tick. The colliders are restored relative to the body poses of the scene, so the recording has to be opened
+before the first step. Ticks are buffered by the file stream, nothing is flushed per tick.
+*/
+class PhysicsRecorder
+{
+    public:
+        PhysicsRecorder();
+        ~PhysicsRecorder();
+
+        bool Open(std::string filename, std::vector<std::unique_ptr<Entity>>& entities, PhysicsSystem& physicsSystem);
+        void WriteTick(float dt, const std::vector<Message>& messages, std::vector<std::unique_ptr<Entity>>& entities);
+        void Close();
+        bool IsOpen();
+
+        /**
+        HashState - FNV-1a over the id, pose and velocities of every physics body, in entity order.
+        */
+        static std::uint64_t HashState(std::vector<std::unique_ptr<Entity>>& entities);
+
+        // bump whenever the file layout changes
+        static const std::uint32_t version = 1;
+
+    private:
+        std::ofstream       file;
+        std::vector<char>   buffer;
+};
+
+/**
+PhysicsReplay loads a recording and steps the scene rebuilt from it, no window or GL context needed.
+Messages are fed to PhysicsSystem::Update exactly as they were recorded, so a replay of the same
+build reproduces the recorded states bit for bit.
+*/
+class PhysicsReplay
+{
+    public:
+        PhysicsReplay();
+
+        /**
+        Reads the whole recording. Returns false if it is missing or invalid, a truncated last tick is dropped.
+        */
+        bool Load(std::string filename);
+
+        /**
+        CreateScene rebuilds the recorded bodies (physics and transform components) and their physics system.
+        */
+        std::unique_ptr<PhysicsSystem> CreateScene(std::vector<std::unique_ptr<Entity>>& entities);
+
+        /**
+        Run steps a new scene through every tick. tickTimes gets the seconds spent in each Update and hashes
+        the state after it. Returns the first tick whose hash differs from the recorded one, -1 if none.
+        */
+        int Run(std::vector<double>& tickTimes, std::vector<std::uint64_t>& hashes);
+
+        const std::vector<RecordedTick>& GetTicks();
+
+    private:
+        float                       gridLength;
+        float                       cellHalfWidth;
+        std::vector<char>           scene;
+        std::vector<RecordedTick>   ticks;
+};
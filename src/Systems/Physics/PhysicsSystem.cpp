@@ -1,12 +1,12 @@
 #include "PhysicsSystem.hpp"
 #include <iostream>
+#include <algorithm>
+#include "../../Log.hpp"
 #include "../../util.hpp"
 
-#include "../../Components/TransformComponent.hpp"
 #include "../Messaging/MoveData.hpp"
 #include "../Messaging/MouseMoveData.hpp"
-
-#include <GL/glew.h>
+#include "../Messaging/OverlapData.hpp"
 
 PhysicsSystem::PhysicsSystem(float gridLength, float cellHalfWidth) : grid(gridLength, cellHalfWidth)
 {
@@ -26,6 +26,16 @@ void PhysicsSystem::Insert(std::vector<std::shared_ptr<Collider>>& colliders)
     }
 }
 
+void PhysicsSystem::Insert(std::shared_ptr<Heightfield> heightfield)
+{
+    this->grid.Insert(heightfield);
+}
+
+void PhysicsSystem::Insert(std::shared_ptr<TriangleMesh> mesh)
+{
+    this->grid.Insert(mesh);
+}
+
 void PhysicsSystem::Update(float dt, std::vector<std::unique_ptr<Entity>>& entities, std::vector<Message>& messages, std::vector<Message>& globalQueue)
 {
     // build entity -> messages map
@@ -34,101 +44,160 @@ void PhysicsSystem::Update(float dt, std::vector<std::unique_ptr<Entity>>& entit
     {
         idToMessage[messages[i].senderID].push_back(messages[i]);
     }
-    std::unordered_map<int, int> idToIndexMap;
-    // Integration step
-    for (int i = 0; i < entities.size(); i++)
+    // 1. gather the dynamic bodies, messages first since they set velocities
+    this->GatherBodies(entities);
+    for (std::unordered_map<int, std::vector<Message>>::iterator it = idToMessage.begin(); it != idToMessage.end(); it++)
     {
-        if (entities[i]->IsEligibleForSystem(this->primaryBitset))
-        {
-            idToIndexMap[entities[i]->id] = i;
-
-            PhysicsComponent* component = entities[i]->GetComponent<PhysicsComponent>(ComponentType::Physics);
-            TransformComponent* transformComponent = entities[i]->GetComponent<TransformComponent>(ComponentType::Transform);
-
-            if (component->dynamicType != DynamicType::Static)
-            {
-                // handle messages for the current entity
-                if (idToMessage.find(entities[i]->id) != idToMessage.end())
-                    this->HandleMessages(idToMessage[entities[i]->id], component);
-
-                this->Integrate(dt, component);
-
-                // Transform Component Update
-                transformComponent->position = component->position;
-                transformComponent->orientation = component->orientation;
-
-                // clear accumulators
-                component->forceAccumulator = glm::vec3(0.f, 0.f, 0.f);
-                component->torqueAccumulator = glm::vec3(0.f, 0.f, 0.f);
-            }
-        }
-    } 
+        std::unordered_map<int, int>::iterator index = this->idToIndexMap.find(it->first);
+        if (index == this->idToIndexMap.end())
+            continue;
+        PhysicsComponent* component = entities[index->second]->GetComponent<PhysicsComponent>(ComponentType::Physics);
+        if (component->dynamicType != DynamicType::Static)
+            this->HandleMessages(it->second, component);
+    }
+    this->Integrate(dt);
+    // collider and grid maintenance runs after all bodies moved
+    for (int i = 0; i < this->bodies.size(); i++)
+    {
+        this->UpdateColliders(this->bodies[i]);
+    }
+    for (int i = 0; i < this->bullets.size(); i++)
+    {
+        PhysicsComponent* component = this->bodies[this->bullets[i].index];
+        this->SweepBullet(component, this->bullets[i].position, this->bullets[i].orientation);
+        this->transforms[this->bullets[i].index]->position = component->position;
+        this->transforms[this->bullets[i].index]->orientation = component->orientation;
+    }
     // 2. Check for collision
-    std::vector<std::shared_ptr<Collision>> collisions = this->grid.CheckCollisions();
+    this->grid.CheckCollisions();
     // 3. Resolve Collisions
-    this->Solve(entities, collisions, idToIndexMap);
+    this->Solve(entities, this->grid.GetContactArena(), this->idToIndexMap);
+    // sensors never reach the solver, they only report overlaps
+    this->UpdateOverlaps(globalQueue);
     // 4. Resolve Interpenetration
     // TO DO
 
-    this->DebugDraw(entities, collisions);
+    this->DebugDraw(entities, this->grid.GetContactArena());
 }
 
-void PhysicsSystem::Integrate(float dt, PhysicsComponent* component)
+void PhysicsSystem::GatherBodies(std::vector<std::unique_ptr<Entity>>& entities)
 {
-    // Component integration
-
-    // acceleration update
-    component->acceleration += component->forceAccumulator * component->inverseMass;
-    component->angularAcc += component->torqueAccumulator * component->invInertiaTensor;
-    // velocity update
-    component->velocity += component->acceleration * dt;
-    component->angularVel += component->angularAcc * dt;
-    // position update
-    component->position += component->velocity * dt;
-    component->orientation.x += 0.5f * component->orientation.x * component->angularVel.x * dt;
-    component->orientation.y += 0.5f * component->orientation.y * component->angularVel.y * dt;
-    component->orientation.z += 0.5f * component->orientation.z * component->angularVel.z * dt;
+    // entities are only added, the same physics entities in the same slots keep their bodies
+    bool isSame = entities.size() == this->gatheredEntities.size();
+    for (int i = 0; i < entities.size() && isSame; i++)
+    {
+        Entity* entity = entities[i]->IsEligibleForSystem(this->primaryBitset) ? entities[i].get() : nullptr;
+        isSame = entity == this->gatheredEntities[i];
+    }
+    if (isSame)
+        return;
 
-    // Colliders Integration
-    printVector(component->position, "component position");
-    // check if we need to move the object accross grid spaces
-    glm::vec3 velocityChange = component->velocity * dt;
-    for (int j = 0; j < component->colliders.size(); j++)
+    this->gatheredEntities.resize(entities.size());
+    this->idToIndexMap.clear();
+    this->bodies.clear();
+    this->transforms.clear();
+    for (int i = 0; i < entities.size(); i++)
     {
-        component->colliders[j]->Update(velocityChange);
-        int newRow = this->grid.GetInsertRow(component->colliders[j]->center);
-        int newCol = this->grid.GetInsertCol(component->colliders[j]->center);
-        int oldRow = component->colliders[j]->row;
-        int oldCol = component->colliders[j]->col;
-        if (oldRow != newRow || oldCol != newCol)
+        this->gatheredEntities[i] = nullptr;
+        if (!entities[i]->IsEligibleForSystem(this->primaryBitset))
+            continue;
+        this->gatheredEntities[i] = entities[i].get();
+        this->idToIndexMap[entities[i]->id] = i;
+
+        PhysicsComponent* component = entities[i]->GetComponent<PhysicsComponent>(ComponentType::Physics);
+        if (component->dynamicType != DynamicType::Static)
         {
-            this->grid.Remove(component->colliders[j]);
-            this->grid.Insert(component->colliders[j]);
+            this->bodies.push_back(component);
+            this->transforms.push_back(entities[i]->GetComponent<TransformComponent>(ComponentType::Transform));
         }
     }
+    this->bodyState.Resize(this->bodies.size());
+    for (int i = 0; i < this->bodies.size(); i++)
+    {
+        this->bodyState.Load(i, *this->bodies[i]);
+    }
 }
 
-void PhysicsSystem::Solve(std::vector<std::unique_ptr<Entity>>& entities, std::vector<std::shared_ptr<Collision>>& collisions, std::unordered_map<int, int>& idToIndexMap)
+void PhysicsSystem::Integrate(float dt)
+{
+    // what gameplay and the solver changed since the last step, the rest stays in bodyState
+    int count = this->bodies.size();
+    for (int i = 0; i < count; i++)
+    {
+        this->bodyState.LoadInputs(i, *this->bodies[i]);
+    }
+
+    this->bodyState.Integrate(dt);
+
+    // write back, bullets keep their start pose for the sweep
+    this->bullets.clear();
+    for (int i = 0; i < count; i++)
+    {
+        PhysicsComponent* component = this->bodies[i];
+        if (component->isBullet)
+            this->bullets.push_back({i, component->position, component->orientation});
+        this->bodyState.Store(i, *component);
+        LOG_TRACE(Physics, "body %d position %f %f %f", i, component->position.x, component->position.y, component->position.z);
+
+        // Transform Component Update
+        this->transforms[i]->position = component->position;
+        this->transforms[i]->orientation = component->orientation;
+    }
+}
+
+void PhysicsSystem::UpdateColliders(PhysicsComponent* component)
+{
+    // the grid moves the object accross grid spaces and levels if needed
+    for (int j = 0; j < component->colliders.size(); j++)
+    {
+        component->colliders[j]->Update(component->position, component->orientation);
+        this->grid.Update(component->colliders[j]);
+    }
+}
+
+void PhysicsSystem::SweepBullet(PhysicsComponent* component, glm::vec3 startPosition, glm::quat startOrientation)
+{
+    glm::vec3 endPosition = component->position;
+    glm::quat endOrientation = component->orientation;
+    float toi = 1.f;
+    for (int j = 0; j < component->colliders.size(); j++)
+    {
+        toi = std::min(toi, this->grid.Sweep(component->colliders[j], startPosition, startOrientation, endPosition, endOrientation));
+    }
+    if (toi >= 1.f)
+        return;
+
+    glm::vec3 displacement = endPosition - startPosition;
+    float distance = glm::length(displacement);
+    float t = std::min(toi + this->bulletSlop / std::max(distance, this->bulletSlop), 1.f);
+    component->position = glm::mix(startPosition, endPosition, t);
+    component->orientation = nlerp(startOrientation, endOrientation, t);
+    this->UpdateColliders(component);
+}
+
+void PhysicsSystem::Solve(std::vector<std::unique_ptr<Entity>>& entities, const ContactArena& contacts, std::unordered_map<int, int>& idToIndexMap)
 {
     float ELASTICITY = .1f;
+    const std::vector<Collision>& collisions = contacts.GetCollisions();
     for (int i = 0; i < collisions.size(); i++)
     {
-        std::shared_ptr<Collision> collision = collisions[i];
-        int firstEntityIndex = idToIndexMap[collision->first];
-        int secondEntityIndex = idToIndexMap[collision->second];
+        const Collision& collision = collisions[i];
+        int firstEntityIndex = idToIndexMap[collision.first];
+        int secondEntityIndex = idToIndexMap[collision.second];
 
         PhysicsComponent* first = entities[firstEntityIndex]->GetComponent<PhysicsComponent>(ComponentType::Physics);
         PhysicsComponent* second = entities[secondEntityIndex]->GetComponent<PhysicsComponent>(ComponentType::Physics);
 
-        std::shared_ptr<Collider> firstCollider = collision->firstCollider;
-        std::shared_ptr<Collider> secondCollider = collision->secondCollider;
+        const Collider& firstCollider = contacts.GetCollider(collision.firstCollider);
+        const Collider& secondCollider = contacts.GetCollider(collision.secondCollider);
+        const Contact* collisionContacts = contacts.GetContacts(collision);
 
-        for (int j = 0; j < collision->contacts.size(); j++)
+        for (int j = 0; j < collision.contactCount; j++)
         {
-            Contact contact = collision->contacts[j];
+            const Contact& contact = collisionContacts[j];
             glm::vec3 normal = contact.contactNormal;
-            glm::vec3 rA = contact.contactPoint - firstCollider->center;
-            glm::vec3 rB = contact.contactPoint - secondCollider->center;
+            glm::vec3 rA = contact.contactPoint - firstCollider.center;
+            glm::vec3 rB = contact.contactPoint - secondCollider.center;
             glm::vec3 vA = first->velocity;
             glm::vec3 wA = first->angularVel;
             glm::vec3 vB = second->velocity;
@@ -155,12 +224,12 @@ void PhysicsSystem::Solve(std::vector<std::unique_ptr<Entity>>& entities, std::v
             float angularFinal = glm::dot(angularPart1 + angularPart2, normal);
             float impulse = nominator / (invMassSum + angularFinal);
             
-            if (firstCollider->dynamicType != DynamicType::Static)
+            if (firstCollider.dynamicType != DynamicType::Static)
             {
                 first->velocity = vA + impulse * normal * invMassA;
                 first->angularVel = wA + invInertiaTensorA * glm::cross(rA, impulse * normal);
             }
-            if (secondCollider->dynamicType != DynamicType::Static)
+            if (secondCollider.dynamicType != DynamicType::Static)
             {
                 second->velocity = vB - impulse * normal * invMassB;
                 second->angularVel = wB - invInertiaTensorB * glm::cross(rB, impulse * normal);
@@ -169,6 +238,79 @@ void PhysicsSystem::Solve(std::vector<std::unique_ptr<Entity>>& entities, std::v
     }
 }
 
+const CollisionStats& PhysicsSystem::GetCollisionStats()
+{
+    return this->grid.GetCollisionStats();
+}
+
+void PhysicsSystem::ResetCollisionStats()
+{
+    this->grid.ResetCollisionStats();
+}
+
+Grid& PhysicsSystem::GetGrid()
+{
+    return this->grid;
+}
+
+int PhysicsSystem::Raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, std::vector<QueryHit>& hits)
+{
+    return this->grid.Raycast(origin, direction, maxDistance, hits);
+}
+
+int PhysicsSystem::SphereCast(glm::vec3 origin, glm::vec3 direction, float radius, float maxDistance, std::vector<QueryHit>& hits)
+{
+    return this->grid.SphereCast(origin, direction, radius, maxDistance, hits);
+}
+
+int PhysicsSystem::OverlapBox(glm::vec3 center, glm::vec3 halfExtents, glm::quat orientation, std::vector<QueryHit>& hits)
+{
+    return this->grid.OverlapBox(center, halfExtents, orientation, hits);
+}
+
+void PhysicsSystem::CastBatch(const std::vector<CastQuery>& queries, std::vector<QueryHit>& results, int threadCount)
+{
+    this->grid.CastBatch(queries, results, threadCount);
+}
+
+void PhysicsSystem::UpdateOverlaps(std::vector<Message>& globalQueue)
+{
+    const std::vector<std::pair<std::shared_ptr<Collider>, std::shared_ptr<Collider>>>& sensorOverlaps = this->grid.GetSensorOverlaps();
+    std::set<std::pair<int, int>> overlaps;
+    for (int i = 0; i < sensorOverlaps.size(); i++)
+    {
+        std::shared_ptr<Collider> sensor = sensorOverlaps[i].first;
+        std::shared_ptr<Collider> other = sensorOverlaps[i].second;
+        if (!sensor->isSensor)
+            std::swap(sensor, other);
+        // colliders of the same entity
+        if (sensor->entityID == other->entityID)
+            continue;
+        overlaps.insert(std::make_pair(sensor->entityID, other->entityID));
+        // two sensors, each one reports the other whatever order the pair was found in
+        if (other->isSensor)
+            overlaps.insert(std::make_pair(other->entityID, sensor->entityID));
+    }
+
+    for (std::set<std::pair<int, int>>::iterator it = overlaps.begin(); it != overlaps.end(); it++)
+    {
+        if (this->activeOverlaps.find(*it) != this->activeOverlaps.end())
+            continue;
+        Message message(it->first, it->second, MessageType::OverlapBegin);
+        message.data = std::make_shared<OverlapData>(it->first, it->second);
+        globalQueue.push_back(message);
+    }
+    for (std::set<std::pair<int, int>>::iterator it = this->activeOverlaps.begin(); it != this->activeOverlaps.end(); it++)
+    {
+        if (overlaps.find(*it) != overlaps.end())
+            continue;
+        Message message(it->first, it->second, MessageType::OverlapEnd);
+        message.data = std::make_shared<OverlapData>(it->first, it->second);
+        globalQueue.push_back(message);
+    }
+    this->activeOverlaps.swap(overlaps);
+}
+
 void PhysicsSystem::HandleMessages(std::vector<Message>& messages, PhysicsComponent* component)
 {
     for (int i = 0; i < messages.size(); i++)
@@ -186,7 +328,7 @@ void PhysicsSystem::HandleMessages(std::vector<Message>& messages, PhysicsCompon
                 result += glm::vec3(-1.f,0.f, 0.f);
             else if (moveData->right)
                 result += glm::vec3(1.f,0.f, 0.f);
-            printVector(result, "Setting vel to ");
+            LOG_DEBUG(Physics, "entity %d velocity set to %f %f %f", message.senderID, result.x, result.y, result.z);
             component->velocity = result;
         }
         else if (message.type == MessageType::MouseMove)
@@ -196,45 +338,51 @@ void PhysicsSystem::HandleMessages(std::vector<Message>& messages, PhysicsCompon
     }
 }
 
-void PhysicsSystem::DebugDraw( std::vector<std::unique_ptr<Entity>>& entities, std::vector<std::shared_ptr<Collision>>& collisions)
+void PhysicsSystem::SetDebugDraw(PhysicsDebugDraw debugDraw)
+{
+    this->debugDraw = debugDraw;
+}
+
+void PhysicsSystem::DebugDraw( std::vector<std::unique_ptr<Entity>>& entities, const ContactArena& contacts)
 {
     /*
-    1. iterate over entities and render physics
-    2. iterate over collisions and render contacts + normals
+    1. iterate over entities and draw the collider edges
+    2. iterate over collisions and draw contacts + normals
     */
+    if (!this->debugDraw.line && !this->debugDraw.point)
+        return;
 
-    for (int i = 0; i < entities.size(); i++)
+    for (int i = 0; i < entities.size() && this->debugDraw.line; i++)
     {
         if (entities[i]->IsEligibleForSystem(this->primaryBitset))
         {
             PhysicsComponent* component = entities[i]->GetComponent<PhysicsComponent>(ComponentType::Physics);
             for (int j = 0; j < component->colliders.size(); j++)
             {
-                const std::vector<glm::vec3>& points = component->colliders[j]->GetPoints();
-                const std::vector<std::pair<int, int>>& edges = component->colliders[j]->GetEdges();
+                std::shared_ptr<Collider> collider = component->colliders[j];
+                const std::vector<glm::vec3>& points = collider->GetPoints();
+                const std::vector<std::pair<int, int>>& edges = collider->GetEdges();
 
                 for (int k = 0; k < edges.size(); k++)
                 {
-                    glBegin(GL_LINES);
-                    glColor3f(1.f,0.f,0.f);
-                    glVertex3d(points[edges[k].first].x, points[edges[k].first].y, points[edges[k].first].z);
-                    glVertex3d(points[edges[k].second].x, points[edges[k].second].y, points[edges[k].second].z);
-                    glEnd();
+                    glm::vec3 first = collider->ToWorld(points[edges[k].first]);
+                    glm::vec3 second = collider->ToWorld(points[edges[k].second]);
+                    this->debugDraw.line(first, second, glm::vec3(1.f, 0.f, 0.f));
                 }
             }
         }
     }
+    const std::vector<Collision>& collisions = contacts.GetCollisions();
     for (int i = 0; i < collisions.size(); i++)
     {
-        std::shared_ptr<Collision> collision = collisions[i];
-        for (int j = 0; j < collision->contacts.size(); j++)
+        const Contact* collisionContacts = contacts.GetContacts(collisions[i]);
+        for (int j = 0; j < collisions[i].contactCount; j++)
         {
-            Contact contact = collision->contacts[j];
-            printVector(contact.contactPoint, "contact point is ");
-            glBegin(GL_POINTS);
-            glColor3f(0.f,1.f,0.f);
-            glVertex3d(contact.contactPoint.x, contact.contactPoint.y, contact.contactPoint.z);
-            glEnd();
+            const Contact& contact = collisionContacts[j];
+            if (this->debugDraw.point)
+                this->debugDraw.point(contact.contactPoint, glm::vec3(0.f, 1.f, 0.f));
+            if (this->debugDraw.line)
+                this->debugDraw.line(contact.contactPoint, contact.contactPoint + contact.contactNormal, glm::vec3(0.f, 1.f, 0.f));
         }
     }
-}
\ No newline at end of file
+}
@@ -1,14 +1,28 @@
 #pragma once
 
+#include <set>
 #include <vector>
 #include <memory>
 #include <cstdint>
+#include <functional>
 #include <unordered_map>
 
 #include "Grid.hpp"
+#include "BodyState.hpp"
 #include "../../Entity.hpp"
 #include "../Messaging/Message.hpp"
 #include "../../Components/PhysicsComponent.hpp"
+#include "../../Components/TransformComponent.hpp"
+
+/**
+PhysicsDebugDraw - receives the collider edges, contact points and normals of every step.
+The physics never draws anything itself, either function can be left empty.
+*/
+struct PhysicsDebugDraw
+{
+    std::function<void(glm::vec3 from, glm::vec3 to, glm::vec3 color)>  line;
+    std::function<void(glm::vec3 point, glm::vec3 color)>               point;
+};
 
 class PhysicsSystem
 {
@@ -17,11 +31,37 @@ class PhysicsSystem
         ~PhysicsSystem();
 
         void Insert(std::vector<std::shared_ptr<Collider>>& colliders);
+        void Insert(std::shared_ptr<Heightfield> heightfield);
+        void Insert(std::shared_ptr<TriangleMesh> mesh);
         void Update(float dt, 
                     std::vector<std::unique_ptr<Entity>>& entities,
                     std::vector<Message>& messages,
                     std::vector<Message>& globalQueue);
-        void Integrate(float dt, PhysicsComponent* component);
+
+        /**
+        GatherBodies rebuilds the dynamic body list and loads the bodies into bodyState, only when the
+        physics entities are not the ones of the last step.
+        */
+        void GatherBodies(std::vector<std::unique_ptr<Entity>>& entities);
+
+        /**
+        Integrate moves every gathered body by dt. The fields gameplay and the solver change are copied into
+        the BodyState arrays, integrated in SIMD batches and written back together with their transforms.
+        Colliders are not touched.
+        */
+        void Integrate(float dt);
+
+        /**
+        Moves the colliders of the component with its body and updates their grid cells.
+        */
+        void UpdateColliders(PhysicsComponent* component);
+
+        /**
+        SweepBullet - continuous collision for bodies flagged as bullets. If the motion of this step hits
+        static geometry, the body is stopped just past the time of impact so the discrete pass
+        generates the contact and the solver responds in the same step.
+        */
+        void SweepBullet(PhysicsComponent* component, glm::vec3 startPosition, glm::quat startOrientation);
         /**
         Method that iterates over all the collisions and resolves them one by one.
         Impulse based formula is used here. Check
@@ -29,17 +69,66 @@ class PhysicsSystem
         https://en.wikipedia.org/wiki/Collision_response#Impulse-based_reaction_model
         */
         void Solve(	std::vector<std::unique_ptr<Entity>>& entities, 
-        			std::vector<std::shared_ptr<Collision>>& collisions, 
+        			const ContactArena& contacts, 
         			std::unordered_map<int, int>& idToIndexMap);
 
+        /**
+        UpdateOverlaps compares the sensor overlaps of this step with the previous one and
+        pushes OverlapBegin / OverlapEnd messages for the pairs that changed. Two overlapping sensors both get them.
+        */
+        void UpdateOverlaps(std::vector<Message>& globalQueue);
+
         void HandleMessages(std::vector<Message>& messages, PhysicsComponent* component);
 
-        /** DEBUG MODE */
+        /**
+        Counters of pairs tested / rejected early / sent to full SAT. Cumulative until reset.
+        */
+        const CollisionStats& GetCollisionStats();
+        void ResetCollisionStats();
+
+        Grid& GetGrid();
+
+        /**
+        Scene queries, see Grid. Hits are sorted by distance.
+        */
+        int Raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, std::vector<QueryHit>& hits);
+        int SphereCast(glm::vec3 origin, glm::vec3 direction, float radius, float maxDistance, std::vector<QueryHit>& hits);
+        int OverlapBox(glm::vec3 center, glm::vec3 halfExtents, glm::quat orientation, std::vector<QueryHit>& hits);
+        void CastBatch(const std::vector<CastQuery>& queries, std::vector<QueryHit>& results, int threadCount = 0);
+
+        /**
+        Sets the debug draw callbacks called at the end of every Update. Empty callbacks (the default) skip debug drawing.
+        */
+        void SetDebugDraw(PhysicsDebugDraw debugDraw);
+
+        /**
+        Sends the collider edges, contact points and normals to the debug draw callbacks.
+        */
         void DebugDraw( std::vector<std::unique_ptr<Entity>>& entities,
-                        std::vector<std::shared_ptr<Collision>>& collisions);
+                        const ContactArena& contacts);
 
     private:
 
-        Grid                grid;\
+        Grid                grid;
         std::uint32_t       primaryBitset;
+        // how far past the time of impact a bullet is placed, has to be above the detector tolerance
+        float               bulletSlop = 0.02f;
+        // (sensor entity, other entity) pairs overlapping at the end of the last step
+        std::set<std::pair<int, int>> activeOverlaps;
+
+        struct BulletStart
+        {
+            int         index;
+            glm::vec3   position;
+            glm::quat   orientation;
+        };
+        // entities[i] if it was a physics entity at the last gather, nullptr otherwise
+        std::vector<Entity*>                gatheredEntities;
+        std::unordered_map<int, int>        idToIndexMap;
+        // dynamic bodies and their transforms, same order as bodyState
+        std::vector<PhysicsComponent*>      bodies;
+        std::vector<TransformComponent*>    transforms;
+        std::vector<BulletStart>            bullets;
+        BodyState                           bodyState;
+        PhysicsDebugDraw                    debugDraw;
 };
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "PhysicsWorld.hpp"
+
+PhysicsWorld::PhysicsWorld(float gridLength, float cellHalfWidth) : physicsSystem(gridLength, cellHalfWidth),
+                                                                    nextID(1)
+{
+
+}
+
+PhysicsWorld::~PhysicsWorld()
+{
+
+}
+
+int PhysicsWorld::AddBody(std::vector<std::shared_ptr<Collider>> colliders, float mass, glm::mat3 inertiaTensor, DynamicType dynamicType, glm::vec3 position, glm::quat orientation)
+{
+    int id = this->nextID++;
+    std::unique_ptr<PhysicsComponent> component = std::make_unique<PhysicsComponent>(mass, position, orientation, inertiaTensor, dynamicType);
+    if (dynamicType == DynamicType::Static)
+    {
+        component->inverseMass = 0.f;
+        component->invInertiaTensor = glm::mat3(0.f);
+        component->invInertiaTensorLocal = glm::mat3(0.f);
+    }
+    for (int i = 0; i < colliders.size(); i++)
+    {
+        colliders[i]->entityID = id;
+        colliders[i]->Attach(position, orientation);
+    }
+    component->colliders = colliders;
+    this->physicsSystem.Insert(component->colliders);
+
+    std::unique_ptr<Entity> entity = std::make_unique<Entity>(id);
+    entity->AddComponent(std::move(component));
+    entity->AddComponent(std::make_unique<TransformComponent>(position, orientation));
+    this->idToIndex[id] = this->entities.size();
+    this->entities.push_back(std::move(entity));
+    return id;
+}
+
+int PhysicsWorld::AddBody(std::shared_ptr<Collider> collider, float mass, glm::mat3 inertiaTensor, DynamicType dynamicType)
+{
+    return this->AddBody(std::vector<std::shared_ptr<Collider>>{collider}, mass, inertiaTensor, dynamicType, collider->center, glm::quat(1.f, 0.f, 0.f, 0.f));
+}
+
+int PhysicsWorld::AddBody(std::shared_ptr<const Hull> hull, float mass, glm::mat3 inertiaTensor, DynamicType dynamicType, glm::vec3 position, glm::quat orientation)
+{
+    std::shared_ptr<Collider> collider = std::make_shared<Collider>(0, position, hull, dynamicType == DynamicType::Static ? DynamicType::Static : DynamicType::Dynamic);
+    collider->orientation = orientation;
+    collider->UpdateBounds();
+    return this->AddBody(std::vector<std::shared_ptr<Collider>>{collider}, mass, inertiaTensor, dynamicType, position, orientation);
+}
+
+int PhysicsWorld::AddHeightfield(std::shared_ptr<Heightfield> heightfield)
+{
+    int id = this->AddStatic(heightfield->GetCollider());
+    this->physicsSystem.Insert(heightfield);
+    return id;
+}
+
+int PhysicsWorld::AddMesh(std::shared_ptr<TriangleMesh> mesh)
+{
+    int id = this->AddStatic(mesh->GetCollider());
+    this->physicsSystem.Insert(mesh);
+    return id;
+}
+
+int PhysicsWorld::AddStatic(std::shared_ptr<Collider> bounds)
+{
+    // the body holds no colliders, the shape is only renamed so its contacts find the body
+    int id = this->AddBody(std::vector<std::shared_ptr<Collider>>(), 1.f, glm::mat3(1.f), DynamicType::Static, bounds->center, glm::quat(1.f, 0.f, 0.f, 0.f));
+    bounds->entityID = id;
+    return id;
+}
+
+void PhysicsWorld::Step(float dt)
+{
+    this->Step(dt, this->noMessages);
+}
+
+void PhysicsWorld::Step(float dt, std::vector<Message>& messages)
+{
+    this->events.clear();
+    this->physicsSystem.Update(dt, this->entities, messages, this->events);
+}
+
+const std::vector<Message>& PhysicsWorld::GetEvents()
+{
+    return this->events;
+}
+
+PhysicsComponent* PhysicsWorld::GetBody(int id)
+{
+    std::unordered_map<int, int>::iterator it = this->idToIndex.find(id);
+    if (it == this->idToIndex.end())
+        return nullptr;
+    return this->entities[it->second]->GetComponent<PhysicsComponent>(ComponentType::Physics);
+}
+
+int PhysicsWorld::GetBodyCount()
+{
+    return this->entities.size();
+}
+
+std::vector<std::unique_ptr<Entity>>& PhysicsWorld::GetEntities()
+{
+    return this->entities;
+}
+
+PhysicsSystem& PhysicsWorld::GetSystem()
+{
+    return this->physicsSystem;
+}
+
+void PhysicsWorld::SetDebugDraw(PhysicsDebugDraw debugDraw)
+{
+    this->physicsSystem.SetDebugDraw(debugDraw);
+}
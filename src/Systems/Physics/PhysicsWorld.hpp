@@ -0,0 +1,86 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+#include "PhysicsSystem.hpp"
+
+/**
+PhysicsWorld - a physics scene that owns its bodies, for code running without a Game or a window
+(servers, tools, batch tests). Every body is an entity with a physics and a transform component,
+stepped by a PhysicsSystem exactly like the bodies of the game. Nothing here needs GL or GLFW.
+*/
+class PhysicsWorld
+{
+    public:
+        PhysicsWorld(float gridLength, float cellHalfWidth);
+        ~PhysicsWorld();
+
+        /**
+        AddBody creates a body at the given pose. The colliders are built in world space for that pose
+        (ColliderBuilder) and are given the id of the body. Static bodies get zero inverse mass and inertia.
+        Returns the id of the new body.
+        */
+        int AddBody(std::vector<std::shared_ptr<Collider>>  colliders,
+                    float                                   mass,
+                    glm::mat3                               inertiaTensor,
+                    DynamicType                             dynamicType,
+                    glm::vec3                               position,
+                    glm::quat                               orientation);
+
+        /**
+        Same as above for a single collider, the body sits at the collider center with no rotation.
+        */
+        int AddBody(std::shared_ptr<Collider> collider, float mass, glm::mat3 inertiaTensor, DynamicType dynamicType);
+
+        /**
+        AddBody with a single collider made from a shared hull (ColliderBuilder::BuildHull or Collider::GetHull).
+        The hull centroid sits at the body position, the hull is never copied.
+        */
+        int AddBody(std::shared_ptr<const Hull> hull, float mass, glm::mat3 inertiaTensor, DynamicType dynamicType, glm::vec3 position, glm::quat orientation);
+
+        /**
+        Terrain and static meshes become static bodies of their own so their contacts reach the solver.
+        Return the id given to them.
+        */
+        int AddHeightfield(std::shared_ptr<Heightfield> heightfield);
+        int AddMesh(std::shared_ptr<TriangleMesh> mesh);
+
+        /**
+        Step advances the world by dt. Messages (Move, MouseMove) are sent by body id and handled
+        as in PhysicsSystem::Update. Overlap events of the step replace the ones of the previous step.
+        */
+        void Step(float dt);
+        void Step(float dt, std::vector<Message>& messages);
+
+        /**
+        OverlapBegin / OverlapEnd messages of the last step.
+        */
+        const std::vector<Message>& GetEvents();
+
+        /**
+        Returns the physics component of the body, nullptr if there is no body with that id.
+        */
+        PhysicsComponent* GetBody(int id);
+        int GetBodyCount();
+
+        std::vector<std::unique_ptr<Entity>>& GetEntities();
+        PhysicsSystem& GetSystem();
+
+        /**
+        Debug geometry of every following step goes to the given callbacks, see PhysicsDebugDraw.
+        */
+        void SetDebugDraw(PhysicsDebugDraw debugDraw);
+
+    private:
+
+        int AddStatic(std::shared_ptr<Collider> bounds);
+
+        PhysicsSystem                           physicsSystem;
+        std::vector<std::unique_ptr<Entity>>    entities;
+        std::unordered_map<int, int>            idToIndex;
+        std::vector<Message>                    noMessages;
+        std::vector<Message>                    events;
+        int                                     nextID;
+};
@@ -0,0 +1,108 @@
+#include "PhysicsWorldBatch.hpp"
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
+PhysicsWorldBatch::PhysicsWorldBatch(int worldCount, float gridLength, float cellHalfWidth, int threadCount)
+{
+    for (int i = 0; i < worldCount; i++)
+        this->worlds.push_back(std::make_unique<PhysicsWorld>(gridLength, cellHalfWidth));
+    if (threadCount <= 0)
+        threadCount = std::max((int)std::thread::hardware_concurrency(), 1);
+    this->threadCount = threadCount;
+}
+
+PhysicsWorldBatch::~PhysicsWorldBatch()
+{
+
+}
+
+PhysicsWorld& PhysicsWorldBatch::GetWorld(int index)
+{
+    return *this->worlds[index];
+}
+
+int PhysicsWorldBatch::GetWorldCount()
+{
+    return this->worlds.size();
+}
+
+void PhysicsWorldBatch::Step(float dt, int steps)
+{
+    this->Run(dt, steps, nullptr);
+}
+
+void PhysicsWorldBatch::Step(float dt, std::vector<std::vector<Message>>& messages)
+{
+    messages.resize(this->worlds.size());
+    this->Run(dt, 1, &messages);
+}
+
+const PhysicsSnapshot& PhysicsWorldBatch::GetSnapshot()
+{
+    return this->snapshot;
+}
+
+void PhysicsWorldBatch::Run(float dt, int steps, std::vector<std::vector<Message>>* messages)
+{
+    // the layout is known up front, so every thread writes its worlds straight into the snapshot
+    int count = this->worlds.size();
+    this->snapshot.worldOffsets.resize(count + 1);
+    this->snapshot.worldOffsets[0] = 0;
+    for (int i = 0; i < count; i++)
+        this->snapshot.worldOffsets[i + 1] = this->snapshot.worldOffsets[i] + this->worlds[i]->GetBodyCount();
+    this->snapshot.ids.resize(this->snapshot.worldOffsets[count]);
+    for (int field = 0; field < PhysicsSnapshot::FieldCount; field++)
+        this->snapshot.fields[field].resize(this->snapshot.worldOffsets[count]);
+
+    // worlds differ in cost, threads take the next one until none is left
+    std::atomic<int> next(0);
+    auto work = [this, dt, steps, messages, count, &next]()
+    {
+        for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+        {
+            for (int step = 0; step < steps; step++)
+            {
+                if (messages != nullptr)
+                    this->worlds[i]->Step(dt, (*messages)[i]);
+                else
+                    this->worlds[i]->Step(dt);
+            }
+            this->WriteSnapshot(i);
+        }
+    };
+
+    int threadCount = std::min(this->threadCount, std::max(count, 1));
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; t++)
+        threads.emplace_back(work);
+    // the calling thread works as well
+    work();
+    for (int t = 0; t < threads.size(); t++)
+        threads[t].join();
+}
+
+void PhysicsWorldBatch::WriteSnapshot(int index)
+{
+    std::vector<std::unique_ptr<Entity>>& entities = this->worlds[index]->GetEntities();
+    int offset = this->snapshot.worldOffsets[index];
+    for (int i = 0; i < entities.size(); i++)
+    {
+        PhysicsComponent* component = entities[i]->GetComponent<PhysicsComponent>(ComponentType::Physics);
+        int slot = offset + i;
+        this->snapshot.ids[slot] = entities[i]->id;
+        this->snapshot.fields[PhysicsSnapshot::PositionX][slot] = component->position.x;
+        this->snapshot.fields[PhysicsSnapshot::PositionY][slot] = component->position.y;
+        this->snapshot.fields[PhysicsSnapshot::PositionZ][slot] = component->position.z;
+        this->snapshot.fields[PhysicsSnapshot::OrientationX][slot] = component->orientation.x;
+        this->snapshot.fields[PhysicsSnapshot::OrientationY][slot] = component->orientation.y;
+        this->snapshot.fields[PhysicsSnapshot::OrientationZ][slot] = component->orientation.z;
+        this->snapshot.fields[PhysicsSnapshot::OrientationW][slot] = component->orientation.w;
+        this->snapshot.fields[PhysicsSnapshot::VelocityX][slot] = component->velocity.x;
+        this->snapshot.fields[PhysicsSnapshot::VelocityY][slot] = component->velocity.y;
+        this->snapshot.fields[PhysicsSnapshot::VelocityZ][slot] = component->velocity.z;
+        this->snapshot.fields[PhysicsSnapshot::AngularVelX][slot] = component->angularVel.x;
+        this->snapshot.fields[PhysicsSnapshot::AngularVelY][slot] = component->angularVel.y;
+        this->snapshot.fields[PhysicsSnapshot::AngularVelZ][slot] = component->angularVel.z;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "PhysicsWorld.hpp"
+
+/**
+PhysicsSnapshot - the bodies of every world of a batch after a step, one float array per component.
+Body i of world w is at index worldOffsets[w] + i, in the order the bodies were added to the world.
+worldOffsets has one more entry than there are worlds, the last one is the total body count.
+*/
+struct PhysicsSnapshot
+{
+    enum Field
+    {
+        PositionX, PositionY, PositionZ,
+        OrientationX, OrientationY, OrientationZ, OrientationW,
+        VelocityX, VelocityY, VelocityZ,
+        AngularVelX, AngularVelY, AngularVelZ,
+        FieldCount
+    };
+
+    std::vector<int>    worldOffsets;
+    std::vector<int>    ids;
+    std::vector<float>  fields[FieldCount];
+};
+
+/**
+PhysicsWorldBatch owns many independent worlds of the same size and steps them in parallel. Every world
+has its own grid, bodies and contact state, so the worlds are split between the threads with no locking.
+Build the hulls once with ColliderBuilder and add them to every world with PhysicsWorld::AddBody, the
+worlds then share the immutable hull data.
+*/
+class PhysicsWorldBatch
+{
+    public:
+        /**
+        threadCount - 0 for one thread per core.
+        */
+        PhysicsWorldBatch(int worldCount, float gridLength, float cellHalfWidth, int threadCount = 0);
+        ~PhysicsWorldBatch();
+
+        PhysicsWorld& GetWorld(int index);
+        int GetWorldCount();
+
+        /**
+        Step advances every world steps times by dt, then fills the snapshot. A thread runs all the steps of
+        a world before it takes the next one, worlds are only synchronized at the end of the call.
+        */
+        void Step(float dt, int steps = 1);
+
+        /**
+        One step where messages[w] are the messages of world w (Move, MouseMove sent by body id).
+        */
+        void Step(float dt, std::vector<std::vector<Message>>& messages);
+
+        /**
+        State of all the bodies after the last Step.
+        */
+        const PhysicsSnapshot& GetSnapshot();
+
+    private:
+
+        void Run(float dt, int steps, std::vector<std::vector<Message>>* messages);
+
+        /**
+        Writes the bodies of one world into the snapshot, the offsets have to be set.
+        */
+        void WriteSnapshot(int index);
+
+        std::vector<std::unique_ptr<PhysicsWorld>>  worlds;
+        int                                         threadCount;
+        PhysicsSnapshot                             snapshot;
+};
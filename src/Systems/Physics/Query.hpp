@@ -0,0 +1,31 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+class Collider;
+
+/**
+CastQuery - a ray (radius 0) or a sphere swept from origin along direction.
+direction has to be normalized.
+*/
+struct CastQuery
+{
+    glm::vec3   origin;
+    glm::vec3   direction;
+    float       maxDistance;
+    float       radius;
+};
+
+/**
+QueryHit - result of a scene query, all in world space.
+The collider is owned by the grid, the pointer is only valid until the collider is removed.
+*/
+struct QueryHit
+{
+    Collider*   collider;
+    int         entityID;
+    // distance along the cast, 0 for overlaps and casts starting inside a collider
+    float       distance;
+    glm::vec3   point;
+    glm::vec3   normal;
+};
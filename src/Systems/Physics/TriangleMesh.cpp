@@ -0,0 +1,306 @@
+#include "TriangleMesh.hpp"
+#include <cmath>
+#include <cfloat>
+#include <cassert>
+#include <algorithm>
+#include "ColliderBuilder.hpp"
+
+namespace
+{
+    const int binCount = 12;
+    // a node at depth d leaves at most d entries below its two children
+    const int stackSize = TriangleMesh::maxDepth + 1;
+
+    float SurfaceArea(glm::vec3 min, glm::vec3 max)
+    {
+        glm::vec3 extent = max - min;
+        return 2.f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+
+    /**
+    Slab test, returns the entry distance or -1 if the ray misses the bounds within maxDistance.
+    */
+    float RayBounds(glm::vec3 origin, glm::vec3 inverseDirection, glm::vec3 min, glm::vec3 max, float maxDistance)
+    {
+        glm::vec3 t1 = (min - origin) * inverseDirection;
+        glm::vec3 t2 = (max - origin) * inverseDirection;
+        glm::vec3 tMin = glm::min(t1, t2);
+        glm::vec3 tMax = glm::max(t1, t2);
+        float tEnter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.f));
+        float tExit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+        return tEnter <= tExit ? tEnter : -1.f;
+    }
+}
+
+const int TriangleMesh::maxLeafSize;
+const int TriangleMesh::maxDepth;
+
+TriangleMesh::TriangleMesh(int entityID, const std::vector<glm::vec3>& vertices, const std::vector<int>& indices) : \
+                            vertices(vertices)
+{
+    int triangleCount = indices.size() / 3;
+    assert(triangleCount > 0);
+    std::vector<glm::vec3> boundsMin(triangleCount);
+    std::vector<glm::vec3> boundsMax(triangleCount);
+    std::vector<glm::vec3> centroids(triangleCount);
+    std::vector<int> order(triangleCount);
+    for (int i = 0; i < triangleCount; i++)
+    {
+        glm::vec3 a = vertices[indices[3 * i]];
+        glm::vec3 b = vertices[indices[3 * i + 1]];
+        glm::vec3 c = vertices[indices[3 * i + 2]];
+        boundsMin[i] = glm::min(a, glm::min(b, c));
+        boundsMax[i] = glm::max(a, glm::max(b, c));
+        centroids[i] = (a + b + c) / 3.f;
+        order[i] = i;
+    }
+    this->nodes.reserve(2 * triangleCount);
+    this->BuildNode(order, boundsMin, boundsMax, centroids, 0, triangleCount, 0);
+
+    // triangles in leaf order
+    this->indices.resize(3 * triangleCount);
+    for (int i = 0; i < triangleCount; i++)
+    {
+        for (int k = 0; k < 3; k++)
+            this->indices[3 * i + k] = indices[3 * order[i] + k];
+    }
+    this->aabbMin = this->nodes[0].min;
+    this->aabbMax = this->nodes[0].max;
+    this->collider = ColliderBuilder::BuildBox(entityID, DynamicType::Static, this->aabbMin, this->aabbMax);
+}
+
+TriangleMesh::TriangleMesh(int entityID, const std::vector<glm::vec3>& vertices, const std::vector<int>& indices, const std::vector<BVHNode>& nodes) : \
+                            vertices(vertices),
+                            indices(indices),
+                            nodes(nodes)
+{
+    assert(!nodes.empty() && indices.size() % 3 == 0);
+    this->aabbMin = this->nodes[0].min;
+    this->aabbMax = this->nodes[0].max;
+    this->collider = ColliderBuilder::BuildBox(entityID, DynamicType::Static, this->aabbMin, this->aabbMax);
+}
+
+int TriangleMesh::BuildNode(std::vector<int>& order,
+                            const std::vector<glm::vec3>& boundsMin,
+                            const std::vector<glm::vec3>& boundsMax,
+                            const std::vector<glm::vec3>& centroids,
+                            int begin,
+                            int end,
+                            int depth)
+{
+    int index = this->nodes.size();
+    this->nodes.emplace_back();
+    glm::vec3 nodeMin = boundsMin[order[begin]];
+    glm::vec3 nodeMax = boundsMax[order[begin]];
+    glm::vec3 centroidMin = centroids[order[begin]];
+    glm::vec3 centroidMax = centroidMin;
+    for (int i = begin + 1; i < end; i++)
+    {
+        nodeMin = glm::min(nodeMin, boundsMin[order[i]]);
+        nodeMax = glm::max(nodeMax, boundsMax[order[i]]);
+        centroidMin = glm::min(centroidMin, centroids[order[i]]);
+        centroidMax = glm::max(centroidMax, centroids[order[i]]);
+    }
+    this->nodes[index].min = nodeMin;
+    this->nodes[index].max = nodeMax;
+    this->nodes[index].offset = begin;
+    this->nodes[index].count = end - begin;
+
+    // binned SAH over the centroid bounds, traversal and triangle tests cost the same
+    int count = end - begin;
+    int bestAxis = -1;
+    int bestSplit = 0;
+    float leafCost = count * SurfaceArea(nodeMin, nodeMax);
+    float bestCost = FLT_MAX;
+    for (int axis = 0; axis < 3 && count > 1 && depth < TriangleMesh::maxDepth; axis++)
+    {
+        float extent = centroidMax[axis] - centroidMin[axis];
+        if (extent <= 0.f)
+            continue;
+        int binTriangles[binCount] = {0};
+        glm::vec3 binMin[binCount];
+        glm::vec3 binMax[binCount];
+        for (int i = begin; i < end; i++)
+        {
+            int bin = std::min(binCount - 1, (int)(binCount * (centroids[order[i]][axis] - centroidMin[axis]) / extent));
+            binMin[bin] = binTriangles[bin] == 0 ? boundsMin[order[i]] : glm::min(binMin[bin], boundsMin[order[i]]);
+            binMax[bin] = binTriangles[bin] == 0 ? boundsMax[order[i]] : glm::max(binMax[bin], boundsMax[order[i]]);
+            binTriangles[bin]++;
+        }
+        // area * count of everything left of each split, then sweep from the right
+        float leftCost[binCount];
+        int leftCount = 0;
+        glm::vec3 leftMin, leftMax;
+        for (int bin = 0; bin < binCount - 1; bin++)
+        {
+            if (binTriangles[bin] > 0)
+            {
+                leftMin = leftCount == 0 ? binMin[bin] : glm::min(leftMin, binMin[bin]);
+                leftMax = leftCount == 0 ? binMax[bin] : glm::max(leftMax, binMax[bin]);
+                leftCount += binTriangles[bin];
+            }
+            leftCost[bin] = leftCount == 0 ? 0.f : leftCount * SurfaceArea(leftMin, leftMax);
+        }
+        int rightCount = 0;
+        glm::vec3 rightMin, rightMax;
+        for (int bin = binCount - 1; bin > 0; bin--)
+        {
+            if (binTriangles[bin] > 0)
+            {
+                rightMin = rightCount == 0 ? binMin[bin] : glm::min(rightMin, binMin[bin]);
+                rightMax = rightCount == 0 ? binMax[bin] : glm::max(rightMax, binMax[bin]);
+                rightCount += binTriangles[bin];
+            }
+            if (rightCount == 0 || rightCount == count)
+                continue;
+            float cost = leftCost[bin - 1] + rightCount * SurfaceArea(rightMin, rightMax);
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = bin;
+            }
+        }
+    }
+
+    // splitting costs one more box test, keep small leaves when it does not pay off
+    float splitCost = SurfaceArea(nodeMin, nodeMax) + bestCost;
+    if (bestAxis == -1 || (count <= TriangleMesh::maxLeafSize && splitCost >= leafCost))
+        return index;
+
+    float extent = centroidMax[bestAxis] - centroidMin[bestAxis];
+    std::vector<int>::iterator middle = std::partition(order.begin() + begin, order.begin() + end, [&](int triangle)
+    {
+        int bin = std::min(binCount - 1, (int)(binCount * (centroids[triangle][bestAxis] - centroidMin[bestAxis]) / extent));
+        return bin < bestSplit;
+    });
+    int split = middle - order.begin();
+
+    this->BuildNode(order, boundsMin, boundsMax, centroids, begin, split, depth + 1);
+    int right = this->BuildNode(order, boundsMin, boundsMax, centroids, split, end, depth + 1);
+    this->nodes[index].offset = right;
+    this->nodes[index].count = 0;
+    return index;
+}
+
+void TriangleMesh::Query(glm::vec3 min, glm::vec3 max, std::vector<int>& triangles)
+{
+    int stack[stackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        int index = stack[--top];
+        const BVHNode& node = this->nodes[index];
+        if (!glm::all(glm::lessThanEqual(min, node.max)) || !glm::all(glm::lessThanEqual(node.min, max)))
+            continue;
+        if (node.count > 0)
+        {
+            for (int i = node.offset; i < node.offset + node.count; i++)
+                triangles.push_back(i);
+            continue;
+        }
+        assert(top + 2 <= stackSize);
+        stack[top++] = node.offset;
+        stack[top++] = index + 1;
+    }
+}
+
+bool TriangleMesh::Raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, float& distance, glm::vec3& normal)
+{
+    glm::vec3 inverseDirection = 1.f / direction;
+    float closest = maxDistance;
+    int closestTriangle = -1;
+    int stack[stackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        int index = stack[--top];
+        const BVHNode& node = this->nodes[index];
+        if (RayBounds(origin, inverseDirection, node.min, node.max, closest) < 0.f)
+            continue;
+        if (node.count > 0)
+        {
+            for (int i = node.offset; i < node.offset + node.count; i++)
+            {
+                // Moller-Trumbore
+                glm::vec3 a, b, c;
+                this->GetTriangle(i, a, b, c);
+                glm::vec3 edge1 = b - a;
+                glm::vec3 edge2 = c - a;
+                glm::vec3 p = glm::cross(direction, edge2);
+                float determinant = glm::dot(edge1, p);
+                if (std::abs(determinant) < 1e-8f)
+                    continue;
+                float inverseDeterminant = 1.f / determinant;
+                glm::vec3 s = origin - a;
+                float u = glm::dot(s, p) * inverseDeterminant;
+                if (u < 0.f || u > 1.f)
+                    continue;
+                glm::vec3 q = glm::cross(s, edge1);
+                float v = glm::dot(direction, q) * inverseDeterminant;
+                if (v < 0.f || u + v > 1.f)
+                    continue;
+                float t = glm::dot(edge2, q) * inverseDeterminant;
+                if (t < 0.f || t > closest)
+                    continue;
+                closest = t;
+                closestTriangle = i;
+            }
+            continue;
+        }
+        // near child on top of the stack
+        int left = index + 1;
+        int right = node.offset;
+        float leftDistance = RayBounds(origin, inverseDirection, this->nodes[left].min, this->nodes[left].max, closest);
+        float rightDistance = RayBounds(origin, inverseDirection, this->nodes[right].min, this->nodes[right].max, closest);
+        assert(top + 2 <= stackSize);
+        if (leftDistance >= 0.f && rightDistance >= 0.f && rightDistance < leftDistance)
+            std::swap(left, right);
+        stack[top++] = right;
+        stack[top++] = left;
+    }
+    if (closestTriangle == -1)
+        return false;
+
+    glm::vec3 a, b, c;
+    this->GetTriangle(closestTriangle, a, b, c);
+    normal = glm::normalize(glm::cross(b - a, c - a));
+    if (glm::dot(normal, direction) > 0.f)
+        normal = -normal;
+    distance = closest;
+    return true;
+}
+
+void TriangleMesh::GetTriangle(int triangle, glm::vec3& a, glm::vec3& b, glm::vec3& c)
+{
+    a = this->vertices[this->indices[3 * triangle]];
+    b = this->vertices[this->indices[3 * triangle + 1]];
+    c = this->vertices[this->indices[3 * triangle + 2]];
+}
+
+std::shared_ptr<Collider> TriangleMesh::GetCollider()
+{
+    return this->collider;
+}
+
+int TriangleMesh::GetTriangleCount()
+{
+    return this->indices.size() / 3;
+}
+
+const std::vector<BVHNode>& TriangleMesh::GetNodes()
+{
+    return this->nodes;
+}
+
+const std::vector<glm::vec3>& TriangleMesh::GetVertices()
+{
+    return this->vertices;
+}
+
+const std::vector<int>& TriangleMesh::GetIndices()
+{
+    return this->indices;
+}
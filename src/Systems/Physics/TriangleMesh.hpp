@@ -0,0 +1,90 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Collider.hpp"
+
+/**
+BVHNode - a node of the flattened BVH, 32 bytes. Nodes are stored depth first so the left child of an
+interior node is the next node, offset holds the index of the right child.
+*/
+struct BVHNode
+{
+    glm::vec3   min;
+    // leaf - index of the first triangle, interior - index of the right child
+    int         offset;
+    glm::vec3   max;
+    // triangles in the leaf, 0 for interior nodes
+    int         count;
+};
+
+/**
+TriangleMesh - static concave geometry in world space. The triangles are ordered so every leaf of the
+BVH references a contiguous range of them. The BVH is built with the surface area heuristic.
+*/
+class TriangleMesh
+{
+    public:
+        /**
+        indices - 3 per triangle, pointing into vertices.
+        */
+        TriangleMesh(int entityID, const std::vector<glm::vec3>& vertices, const std::vector<int>& indices);
+
+        /**
+        Restores a mesh with its BVH, indices have to be in the leaf order of the nodes (see GetIndices).
+        */
+        TriangleMesh(int entityID, const std::vector<glm::vec3>& vertices, const std::vector<int>& indices, const std::vector<BVHNode>& nodes);
+
+        /**
+        Query appends the triangles whose bounds overlap the given bounds to triangles.
+        */
+        void Query(glm::vec3 min, glm::vec3 max, std::vector<int>& triangles);
+
+        /**
+        Raycast returns the closest triangle hit within maxDistance. The normal faces the ray.
+        direction has to be normalized.
+        */
+        bool Raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, float& distance, glm::vec3& normal);
+
+        void GetTriangle(int triangle, glm::vec3& a, glm::vec3& b, glm::vec3& c);
+
+        /**
+        Static collider spanning the bounds of the mesh, see Heightfield::GetCollider.
+        */
+        std::shared_ptr<Collider> GetCollider();
+
+        int GetTriangleCount();
+        const std::vector<BVHNode>& GetNodes();
+        const std::vector<glm::vec3>& GetVertices();
+        const std::vector<int>& GetIndices();
+
+        // world bounds
+        glm::vec3   aabbMin;
+        glm::vec3   aabbMax;
+
+        // triangles per leaf above which the builder always splits, unless the node is maxDepth deep
+        static const int maxLeafSize = 8;
+        // deepest node the builder makes, bounds the fixed traversal stack of Query and Raycast
+        static const int maxDepth = 63;
+
+    private:
+        /**
+        BuildNode creates the node for order[begin, end) and its children, returns its index.
+        A node at maxDepth is a leaf whatever its size.
+        */
+        int BuildNode(  std::vector<int>& order,
+                        const std::vector<glm::vec3>& boundsMin,
+                        const std::vector<glm::vec3>& boundsMax,
+                        const std::vector<glm::vec3>& centroids,
+                        int begin,
+                        int end,
+                        int depth);
+
+        std::vector<glm::vec3>      vertices;
+        // 3 per triangle, in BVH leaf order
+        std::vector<int>            indices;
+        std::vector<BVHNode>        nodes;
+        std::shared_ptr<Collider>   collider;
+};
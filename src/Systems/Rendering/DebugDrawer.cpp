@@ -0,0 +1,64 @@
+#include "DebugDrawer.hpp"
+
+#ifndef NDEBUG
+
+bool                            DebugDrawer::enabled = true;
+std::vector<DebugDrawer::Vertex> DebugDrawer::lines;
+std::vector<DebugDrawer::Vertex> DebugDrawer::points;
+
+void DebugDrawer::Line(glm::vec3 first, glm::vec3 second, glm::vec3 color)
+{
+    if (!DebugDrawer::enabled)
+        return;
+    DebugDrawer::lines.push_back({first, color});
+    DebugDrawer::lines.push_back({second, color});
+}
+
+void DebugDrawer::Point(glm::vec3 point, glm::vec3 color)
+{
+    if (!DebugDrawer::enabled)
+        return;
+    DebugDrawer::points.push_back({point, color});
+}
+
+void DebugDrawer::Axes(const glm::mat4& transform, float size)
+{
+    glm::vec3 origin = glm::vec3(transform[3]);
+    for (int i = 0; i < 3; i++)
+    {
+        glm::vec3 color = glm::vec3(0.f, 0.f, 0.f);
+        color[i] = 1.f;
+        DebugDrawer::Line(origin, origin + glm::normalize(glm::vec3(transform[i])) * size, color);
+    }
+}
+
+void DebugDrawer::SetEnabled(bool enabled)
+{
+    DebugDrawer::enabled = enabled;
+    if (!enabled)
+        DebugDrawer::Clear();
+}
+
+bool DebugDrawer::IsEnabled()
+{
+    return DebugDrawer::enabled;
+}
+
+const std::vector<DebugDrawer::Vertex>& DebugDrawer::GetLines()
+{
+    return DebugDrawer::lines;
+}
+
+const std::vector<DebugDrawer::Vertex>& DebugDrawer::GetPoints()
+{
+    return DebugDrawer::points;
+}
+
+void DebugDrawer::Clear()
+{
+    // keeps the capacity, drawing does not allocate once warm
+    DebugDrawer::lines.clear();
+    DebugDrawer::points.clear();
+}
+
+#endif
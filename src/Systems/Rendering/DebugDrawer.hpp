@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+/**
+DebugDrawer collects debug lines and points during the frame, any system can add to it.
+The RenderingSystem uploads them in one dynamic vertex buffer at the end of the frame and clears them.
+Builds with NDEBUG compile it out, every call is an empty inline.
+*/
+class DebugDrawer
+{
+    public:
+        struct Vertex
+        {
+            glm::vec3 position;
+            glm::vec3 color;
+        };
+
+#ifndef NDEBUG
+        static void Line(glm::vec3 first, glm::vec3 second, glm::vec3 color);
+        static void Point(glm::vec3 point, glm::vec3 color);
+        /**
+        Draws the three axes of a transform, x red, y green, z blue.
+        */
+        static void Axes(const glm::mat4& transform, float size);
+
+        /**
+        Disabled drawing drops everything added to it. Enabled by default.
+        */
+        static void SetEnabled(bool enabled);
+        static bool IsEnabled();
+
+        /** vertex pairs */
+        static const std::vector<Vertex>& GetLines();
+        static const std::vector<Vertex>& GetPoints();
+        static void Clear();
+
+    private:
+        static bool                 enabled;
+        static std::vector<Vertex>  lines;
+        static std::vector<Vertex>  points;
+#else
+        static void Line(glm::vec3 first, glm::vec3 second, glm::vec3 color) {}
+        static void Point(glm::vec3 point, glm::vec3 color) {}
+        static void Axes(const glm::mat4& transform, float size) {}
+        static void SetEnabled(bool enabled) {}
+        static bool IsEnabled() { return false; }
+        static void Clear() {}
+#endif
+};
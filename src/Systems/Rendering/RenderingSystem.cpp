@@ -1,13 +1,16 @@
 #include <vector>
 #include <iostream>
+#include <algorithm>
 #include <GL/glew.h>
 
 #include "RenderingSystem.hpp"
+#include "DebugDrawer.hpp"
 #include "../../Components/RenderingComponent.hpp"
 #include "../../Components/TransformComponent.hpp"
 #include "../../Entity.hpp"
 #include "../../External/stb_image.hpp"
 #include "../Messaging/MouseMoveData.hpp"
+#include "../../Log.hpp"
 
 RenderingSystem::RenderingSystem() : camera(glm::vec3(0.f,0.f,0.f), glm::vec3(1.0f,0.f,0.f), (float)800/(float)600)
 {
@@ -17,6 +20,9 @@ RenderingSystem::RenderingSystem() : camera(glm::vec3(0.f,0.f,0.f), glm::vec3(1.
     this->ambient = 0.3f;
     this->diffuse = 0.5f;
     this->lightDirection = glm::vec3(-48.f,-128.f,0.f);
+    this->debugVertexArray = 0;
+    this->debugVertexBuffer = 0;
+    this->debugBufferCapacity = 0;
 }
 
 RenderingSystem::~RenderingSystem()
@@ -33,6 +39,11 @@ void RenderingSystem::AddShaders(std::vector<std::string> shaders, std::vector<s
     }
 }
 
+void RenderingSystem::AddDebugShader(std::string vertexPath, std::string fragmentPath)
+{
+    this->debugShader = std::make_unique<Shader>(vertexPath, fragmentPath);
+}
+
 void RenderingSystem::Update(std::vector<std::unique_ptr<Entity>>& entities, int playerID, std::vector<Message>& messages, std::vector<Message>& globalQueue)
 {
     // build entity -> messages map
@@ -92,9 +103,56 @@ void RenderingSystem::Update(std::vector<std::unique_ptr<Entity>>& entities, int
             }
         }
     }
+    this->DrawDebug(projectionMatrix, viewMatrix);
     this->camera.Update(newCameraPosition);
 }
 
+void RenderingSystem::DrawDebug(const glm::mat4& projectionMatrix, const glm::mat4& viewMatrix)
+{
+#ifndef NDEBUG
+    const std::vector<DebugDrawer::Vertex>& lines = DebugDrawer::GetLines();
+    const std::vector<DebugDrawer::Vertex>& points = DebugDrawer::GetPoints();
+    int count = lines.size() + points.size();
+    if (count == 0 || !this->debugShader)
+    {
+        DebugDrawer::Clear();
+        return;
+    }
+
+    if (this->debugVertexArray == 0)
+    {
+        glGenVertexArrays(1, &this->debugVertexArray);
+        glBindVertexArray(this->debugVertexArray);
+        glGenBuffers(1, &this->debugVertexBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, this->debugVertexBuffer);
+
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DebugDrawer::Vertex), (void*)0);
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(DebugDrawer::Vertex), (void*)(sizeof(float)*3));
+    }
+    glBindVertexArray(this->debugVertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, this->debugVertexBuffer);
+    // orphan the old storage so the upload does not wait for the previous frame
+    if (count > this->debugBufferCapacity)
+        this->debugBufferCapacity = std::max(count, 2 * this->debugBufferCapacity);
+    glBufferData(GL_ARRAY_BUFFER, this->debugBufferCapacity * sizeof(DebugDrawer::Vertex), nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, lines.size() * sizeof(DebugDrawer::Vertex), lines.data());
+    glBufferSubData(GL_ARRAY_BUFFER, lines.size() * sizeof(DebugDrawer::Vertex), points.size() * sizeof(DebugDrawer::Vertex), points.data());
+
+    this->debugShader->Use();
+    this->debugShader->SetMat4("projection", projectionMatrix);
+    this->debugShader->SetMat4("view", viewMatrix);
+    glDrawArrays(GL_LINES, 0, lines.size());
+    glPointSize(4.f);
+    glDrawArrays(GL_POINTS, lines.size(), points.size());
+    glBindVertexArray(0);
+
+    DebugDrawer::Clear();
+#endif
+}
+
 void RenderingSystem::HandleMessages(std::vector<Message>& messages)
 {
     for (int i = 0; i < messages.size(); i++)
@@ -176,7 +234,7 @@ unsigned int RenderingSystem::CreateTexture(std::string filename)
     }
     else
     {
-        std::cout << "Cannot load texture : " << filename << std::endl;
+        LOG_WARNING(Rendering, "cannot load texture %s", filename.c_str());
     }
     stbi_image_free(data);
     glBindTexture(GL_TEXTURE_2D, 0);
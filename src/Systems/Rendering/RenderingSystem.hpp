@@ -16,6 +16,7 @@ class RenderingSystem
         RenderingSystem();
         ~RenderingSystem();
         void AddShaders(std::vector<std::string> shaders, std::vector<std::string> shadowShaders);
+        void AddDebugShader(std::string vertexPath, std::string fragmentPath);
         void Update(std::vector<std::unique_ptr<Entity>>& entities,
                     int playerID,
                     std::vector<Message>& messages,
@@ -24,6 +25,12 @@ class RenderingSystem
         void HandleMessages(std::vector<Message>& messages);
         static std::pair<unsigned int, unsigned int> BufferData(float* data, int size, bool animated);
 
+        /**
+        DrawDebug uploads the lines and points of the DebugDrawer into the debug vertex buffer,
+        draws them over the scene and clears the DebugDrawer for the next frame.
+        */
+        void DrawDebug(const glm::mat4& projectionMatrix, const glm::mat4& viewMatrix);
+
     private:
 
         std::uint32_t primaryBitset;
@@ -31,6 +38,12 @@ class RenderingSystem
         // Shaders
         std::vector<Shader> shaders;
         std::vector<Shader> shadowShaders;
+        std::unique_ptr<Shader> debugShader;
+
+        // debug lines, the buffer only grows
+        unsigned int debugVertexArray;
+        unsigned int debugVertexBuffer;
+        int          debugBufferCapacity;
 
         // shadows
         unsigned int frameBuffer;
@@ -1,5 +1,5 @@
 #include "Shader.hpp"
-#include <iostream>
+#include "../../Log.hpp"
 #include <fstream>
 #include <sstream>
 #include <glm/glm.hpp>
@@ -45,7 +45,7 @@ unsigned int Shader::Load(std::string vertexPath, std::string fragmentPath)
     if (!success)
     {
         glGetShaderInfoLog(vertexID,512,NULL,infoLog);
-        std::cout << "VERTEX SHADER :: COMPILE ERROR :: " << vertexPath << " " << infoLog << std::endl;
+        LOG_ERROR(Rendering, "vertex shader compile error %s: %s", vertexPath.c_str(), infoLog);
     }
     unsigned int fragmentID;
     fragmentID = glCreateShader(GL_FRAGMENT_SHADER);
@@ -55,7 +55,7 @@ unsigned int Shader::Load(std::string vertexPath, std::string fragmentPath)
     if (!success)
     {
         glGetShaderInfoLog(fragmentID,512,NULL, infoLog);
-        std::cout << "FRAGMENT SHADER :: COMPILE ERROR :: " << fragmentPath << " " << infoLog << std::endl;
+        LOG_ERROR(Rendering, "fragment shader compile error %s: %s", fragmentPath.c_str(), infoLog);
     }
     // program
     unsigned int id = glCreateProgram();
@@ -66,7 +66,7 @@ unsigned int Shader::Load(std::string vertexPath, std::string fragmentPath)
     if (!success)
     {
         glGetProgramInfoLog(id, 512,NULL, infoLog);
-        std::cout << "PROGRAM SHADER :: LINK ERROR :: " << infoLog << std::endl;
+        LOG_ERROR(Rendering, "shader link error: %s", infoLog);
     }
     glDeleteShader(vertexID);
     glDeleteShader(fragmentID);
@@ -1,10 +1,20 @@
 #include <iostream>
+#include <cstring>
 
+#include "Log.hpp"
 #include "Game.hpp"
 
 int main(int argc, char *argv[])
 {
+    Log::Start();
     Game game = Game(800,600);
+    // --record <file> writes the physics scene and input of the session for tools/Replay
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--record") == 0)
+            game.StartRecording(argv[i + 1]);
+    }
     game.Run();
+    Log::Stop();
     return 0;
 }
\ No newline at end of file
@@ -14,4 +14,11 @@ void print2DVector(std::vector<glm::vec3>& vector, std::string name)
 		printVector(vector[i]);
 	}
 	std::cout << "---------------------" << std::endl;
+}
+
+glm::quat nlerp(glm::quat from, glm::quat to, float t)
+{
+	if (glm::dot(from, to) < 0.f)
+		to = to * -1.f;
+	return glm::normalize(from * (1.f - t) + to * t);
 }
\ No newline at end of file
@@ -1,7 +1,13 @@
 #pragma once
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <string>
 #include <vector>
 
 void printVector(glm::vec3 vector, std::string name = "Vector");
-void print2DVector(std::vector<glm::vec3>& vector, std::string name = "Vector");
\ No newline at end of file
+void print2DVector(std::vector<glm::vec3>& vector, std::string name = "Vector");
+
+/**
+Normalized linear interpolation between two orientations, takes the shortest arc.
+*/
+glm::quat nlerp(glm::quat from, glm::quat to, float t);
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "catch.hpp"
+#include <cstdlib>
+#include "../src/Systems/Physics/BodyState.hpp"
+
+static float RandomFloat(float min, float max)
+{
+	return min + (max - min) * (std::rand() / (float)RAND_MAX);
+}
+
+static void FillBodies(BodyState& state, int count)
+{
+	state.Resize(count);
+	for (int field = 0; field < BodyState::FieldCount; field++)
+	{
+		float* values = state.Get((BodyState::Field)field);
+		for (int i = 0; i < count; i++)
+			values[i] = RandomFloat(-2.f, 2.f);
+	}
+}
+
+TEST_CASE("Body state")
+{
+	std::srand(7);
+
+	SECTION("Load and Store round trip a component")
+	{
+		glm::mat3 inertia(2.f, 0.f, 0.f, 0.f, 4.f, 0.f, 0.f, 0.f, 8.f);
+		PhysicsComponent component(2.f, glm::vec3(1.f, 2.f, 3.f), glm::quat(1.f, 0.f, 0.f, 0.f), inertia, DynamicType::Dynamic);
+		component.velocity = glm::vec3(1.f, 0.f, -1.f);
+		component.forceAccumulator = glm::vec3(0.f, 4.f, 0.f);
+
+		BodyState state;
+		state.Resize(3);
+		state.Load(1, component);
+		REQUIRE(state.Get(BodyState::PositionZ)[1] == 3.f);
+		REQUIRE(state.Get(BodyState::InverseMass)[1] == component.inverseMass);
+		REQUIRE(state.Get(BodyState::InvInertia11)[1] == component.invInertiaTensor[1][1]);
+
+		state.Store(1, component);
+		REQUIRE(component.position == glm::vec3(1.f, 2.f, 3.f));
+		REQUIRE(component.velocity == glm::vec3(1.f, 0.f, -1.f));
+		REQUIRE(component.forceAccumulator == glm::vec3(0.f, 0.f, 0.f));
+	}
+
+	SECTION("Integrate matches the component integration")
+	{
+		glm::mat3 inertia(1.f, 0.2f, 0.f, 0.2f, 2.f, 0.1f, 0.f, 0.1f, 3.f);
+		PhysicsComponent component(3.f, glm::vec3(1.f, 2.f, 3.f), glm::quat(0.9f, 0.1f, 0.3f, 0.2f), inertia, DynamicType::Dynamic);
+		component.velocity = glm::vec3(1.f, -2.f, 0.5f);
+		component.angularVel = glm::vec3(0.1f, 0.2f, -0.3f);
+		component.forceAccumulator = glm::vec3(0.f, -9.f, 1.f);
+		component.torqueAccumulator = glm::vec3(0.5f, 0.f, -1.f);
+
+		float dt = 0.016f;
+		glm::vec3 acceleration = component.acceleration + component.forceAccumulator * component.inverseMass;
+		glm::vec3 angularAcc = component.angularAcc + component.torqueAccumulator * component.invInertiaTensor;
+		glm::vec3 velocity = component.velocity + acceleration * dt;
+		glm::vec3 angularVel = component.angularVel + angularAcc * dt;
+		glm::vec3 position = component.position + velocity * dt;
+
+		BodyState state;
+		state.Resize(1);
+		state.Load(0, component);
+		state.Integrate(dt);
+		state.Store(0, component);
+
+		for (int k = 0; k < 3; k++)
+		{
+			REQUIRE(component.angularVel[k] == Approx(angularVel[k]));
+			REQUIRE(component.position[k] == Approx(position[k]));
+		}
+	}
+
+	SECTION("Orientation follows the angular velocity")
+	{
+		glm::mat3 inertia(1.f, 0.f, 0.f, 0.f, 2.f, 0.f, 0.f, 0.f, 4.f);
+		PhysicsComponent component(1.f, glm::vec3(0.f, 0.f, 0.f), glm::quat(1.f, 0.f, 0.f, 0.f), inertia, DynamicType::Dynamic);
+		// half a turn around z in one second
+		component.angularVel = glm::vec3(0.f, 0.f, 3.14159265f);
+
+		BodyState state;
+		state.Resize(1);
+		for (int step = 0; step < 1000; step++)
+		{
+			state.Load(0, component);
+			state.Integrate(0.001f);
+			state.Store(0, component);
+			REQUIRE(glm::length(component.orientation) == Approx(1.f));
+		}
+		REQUIRE(std::abs(component.orientation.z) == Approx(1.f).epsilon(0.001));
+		REQUIRE(std::abs(component.orientation.x) < 0.001f);
+		REQUIRE(std::abs(component.orientation.y) < 0.001f);
+		// a quarter turn later the world tensor has its x and y axes swapped
+		for (int step = 0; step < 500; step++)
+		{
+			state.Load(0, component);
+			state.Integrate(0.001f);
+			state.Store(0, component);
+		}
+		REQUIRE(component.invInertiaTensor[0][0] == Approx(0.5f).epsilon(0.01));
+		REQUIRE(component.invInertiaTensor[1][1] == Approx(1.f).epsilon(0.01));
+		REQUIRE(component.invInertiaTensor[2][2] == Approx(0.25f));
+		REQUIRE(component.invInertiaTensorLocal[0][0] == Approx(1.f));
+	}
+
+	SECTION("SIMD batches match the scalar path")
+	{
+		// counts that are not a multiple of the batch size use the padding bodies
+		int counts[] = {1, 3, 4, 13, 100000};
+		for (int c = 0; c < 5; c++)
+		{
+			BodyState batched;
+			FillBodies(batched, counts[c]);
+			BodyState scalar = batched;
+
+			for (int step = 0; step < 4; step++)
+			{
+				batched.Integrate(0.01f);
+				scalar.IntegrateScalar(0.01f, 0, scalar.Size());
+			}
+
+			for (int field = 0; field < BodyState::FieldCount; field++)
+			{
+				float* a = batched.Get((BodyState::Field)field);
+				float* b = scalar.Get((BodyState::Field)field);
+				for (int i = 0; i < counts[c]; i++)
+				{
+					if (a[i] != Approx(b[i]))
+						FAIL("field " << field << " body " << i << ": " << a[i] << " != " << b[i]);
+				}
+			}
+			REQUIRE(batched.Size() == counts[c]);
+		}
+	}
+}
@@ -2,6 +2,7 @@
 #include "../src/Systems/Physics/ColliderBuilder.hpp"
 #include "../src/util.hpp"
 #include <chrono>
+#include <cmath>
 #include <iostream>
 
 TEST_CASE("Test Collider Builder - normal box")
@@ -415,4 +416,165 @@ TEST_CASE("Deformed box produces 6 faces and 12 edges")
 
 	REQUIRE(faces.size() == 6);
 	REQUIRE(edges.size() == 12);
-}
\ No newline at end of file
+}
+TEST_CASE("Edges know their adjacent faces")
+{
+	std::vector<glm::vec3> points;
+	points.push_back(glm::vec3(0.f, 0.f, 0.f)); // 0 A
+	points.push_back(glm::vec3(2.f, 0.f, 0.f)); // 1 B
+	points.push_back(glm::vec3(0.f, 1.f, 0.f)); // 2 C
+	points.push_back(glm::vec3(2.f, 2.f, 0.f)); // 3 D
+	points.push_back(glm::vec3(0.f, 0.f, 0.7f)); // 4 E
+	points.push_back(glm::vec3(2.f, 0.f, 2.f)); // 5 F
+	points.push_back(glm::vec3(2.f, 2.f, 2.f)); // 6 G
+	points.push_back(glm::vec3(0.f, 1.f, 1.f)); // 7 H
+	std::shared_ptr<Collider> collider = ColliderBuilder::Build(1, DynamicType::Static, points);
+
+	const std::vector<std::pair<int, int>>& edges = collider->GetEdges();
+	const std::vector<std::pair<int, int>>& edgeFaces = collider->GetEdgeFaces();
+	const std::vector<ColliderFace>& faces = collider->GetFaces();
+
+	REQUIRE(edgeFaces.size() == edges.size());
+	for (int i = 0; i < edges.size(); i++)
+	{
+		REQUIRE(edgeFaces[i].first != -1);
+		REQUIRE(edgeFaces[i].second != -1);
+		REQUIRE(edgeFaces[i].first != edgeFaces[i].second);
+		// the edge is perpendicular to both face normals
+		glm::vec3 edge = glm::normalize(collider->GetPoints()[edges[i].second] - collider->GetPoints()[edges[i].first]);
+		REQUIRE(std::abs(glm::dot(edge, faces[edgeFaces[i].first].normal)) < 0.005f);
+		REQUIRE(std::abs(glm::dot(edge, faces[edgeFaces[i].second].normal)) < 0.005f);
+	}
+}
+
+TEST_CASE("Duplicate and interior points are dropped")
+{
+	std::vector<glm::vec3> points;
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec3 corner = glm::vec3(i & 1 ? 2.f : 0.f, i & 2 ? 2.f : 0.f, i & 4 ? 2.f : 0.f);
+		points.push_back(corner);
+		points.push_back(corner + glm::vec3(0.00001f, 0.f, 0.f));
+	}
+	points.push_back(glm::vec3(1.f, 1.f, 1.f));
+	points.push_back(glm::vec3(1.f, 0.f, 1.f));
+
+	std::shared_ptr<Hull> hull = ColliderBuilder::BuildHull(points);
+	REQUIRE(hull->points.size() == 8);
+	REQUIRE(hull->faces.size() == 6);
+	REQUIRE(hull->edges.size() == 12);
+	for (int i = 0; i < hull->faces.size(); i++)
+	{
+		REQUIRE(hull->faces[i].points.size() == 4);
+	}
+}
+
+TEST_CASE("Quickhull matches the brute force builder")
+{
+	// rings of points on a sphere, the quads between rings and the two caps all need merging
+	std::vector<glm::vec3> points;
+	for (int i = 0; i < 6; i++)
+	{
+		for (int j = 0; j < 8; j++)
+		{
+			float theta = 3.14159265f * (i + 0.5f) / 6.f;
+			float phi = 2.f * 3.14159265f * j / 8.f;
+			points.push_back(glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+		}
+	}
+
+	std::shared_ptr<Hull> quick = ColliderBuilder::BuildHull(points);
+	std::shared_ptr<Hull> brute = ColliderBuilder::BuildHullBruteForce(points);
+	REQUIRE(quick->faces.size() == brute->faces.size());
+	REQUIRE(quick->edges.size() == brute->edges.size());
+	for (int i = 0; i < quick->faces.size(); i++)
+	{
+		REQUIRE(glm::all(glm::epsilonEqual(quick->faces[i].normal, brute->faces[i].normal, 0.005f)));
+		REQUIRE(quick->faces[i].points == brute->faces[i].points);
+	}
+}
+
+TEST_CASE("Mass properties from the hull volume")
+{
+	SECTION("Box")
+	{
+		std::shared_ptr<Collider> box = ColliderBuilder::BuildBox(1, DynamicType::Dynamic, glm::vec3(-1.f, -2.f, -3.f), glm::vec3(1.f, 2.f, 3.f));
+		MassProperties properties = ColliderBuilder::ComputeMassProperties(*box->GetHull(), 0.5f);
+		REQUIRE(properties.volume == Approx(48.f));
+		REQUIRE(properties.mass == Approx(24.f));
+		REQUIRE(glm::all(glm::epsilonEqual(properties.centerOfMass, glm::vec3(0.f, 0.f, 0.f), 0.001f)));
+		// m * (b^2 + c^2) / 12 with the full side lengths
+		REQUIRE(properties.inertiaTensor[0][0] == Approx(104.f));
+		REQUIRE(properties.inertiaTensor[1][1] == Approx(80.f));
+		REQUIRE(properties.inertiaTensor[2][2] == Approx(40.f));
+		REQUIRE(std::abs(properties.inertiaTensor[0][1]) < 0.001f);
+		REQUIRE(std::abs(properties.inertiaTensor[1][2]) < 0.001f);
+
+		// a quarter turn around z swaps the x and y axes
+		box->Attach(box->center, glm::quat(1.f, 0.f, 0.f, 0.f));
+		box->Update(box->center, glm::angleAxis(glm::radians(90.f), glm::vec3(0.f, 0.f, 1.f)));
+		MassProperties turned = ColliderBuilder::ComputeMassProperties(box, 0.5f);
+		REQUIRE(turned.inertiaTensor[0][0] == Approx(80.f));
+		REQUIRE(turned.inertiaTensor[1][1] == Approx(104.f));
+		REQUIRE(turned.inertiaTensor[2][2] == Approx(40.f));
+	}
+	SECTION("Tetrahedron, the center of mass is not the centroid of the points")
+	{
+		std::vector<glm::vec3> points{glm::vec3(0.f, 0.f, 0.f), glm::vec3(1.f, 0.f, 0.f), glm::vec3(0.f, 1.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec3(0.1f, 0.1f, 0.1f)};
+		MassProperties properties = ColliderBuilder::ComputeMassProperties(*ColliderBuilder::BuildHull(points));
+		REQUIRE(properties.volume == Approx(1.f / 6.f));
+		REQUIRE(glm::all(glm::epsilonEqual(properties.centerOfMass, glm::vec3(0.25f, 0.25f, 0.25f), 0.001f)));
+		REQUIRE(properties.inertiaTensor[0][0] == Approx(1.f / 80.f));
+		REQUIRE(properties.inertiaTensor[0][1] == Approx(1.f / 480.f));
+		REQUIRE(properties.inertiaTensor[1][2] == Approx(1.f / 480.f));
+	}
+	SECTION("A compound of two boxes is one long box")
+	{
+		std::vector<std::shared_ptr<Collider>> children;
+		children.push_back(ColliderBuilder::BuildBox(1, DynamicType::Dynamic, glm::vec3(0.f, 0.f, 0.f), glm::vec3(1.f, 1.f, 1.f)));
+		children.push_back(ColliderBuilder::BuildBox(1, DynamicType::Dynamic, glm::vec3(1.f, 0.f, 0.f), glm::vec3(3.f, 1.f, 1.f)));
+		MassProperties compound = ColliderBuilder::ComputeMassProperties(ColliderBuilder::BuildCompound(1, DynamicType::Dynamic, children));
+		MassProperties box = ColliderBuilder::ComputeMassProperties(ColliderBuilder::BuildBox(1, DynamicType::Dynamic, glm::vec3(0.f, 0.f, 0.f), glm::vec3(3.f, 1.f, 1.f)));
+		REQUIRE(compound.mass == Approx(3.f));
+		REQUIRE(glm::all(glm::epsilonEqual(compound.centerOfMass, glm::vec3(1.5f, 0.5f, 0.5f), 0.001f)));
+		for (int i = 0; i < 3; i++)
+			REQUIRE(glm::all(glm::epsilonEqual(compound.inertiaTensor[i], box.inertiaTensor[i], 0.001f)));
+
+		MassProperties separate = ColliderBuilder::ComputeMassProperties(children);
+		REQUIRE(separate.mass == Approx(3.f));
+		for (int i = 0; i < 3; i++)
+			REQUIRE(glm::all(glm::epsilonEqual(separate.inertiaTensor[i], box.inertiaTensor[i], 0.001f)));
+	}
+	SECTION("A unit box about its corner")
+	{
+		MassProperties properties = ColliderBuilder::ComputeMassProperties(ColliderBuilder::BuildBox(1, DynamicType::Dynamic, glm::vec3(0.f, 0.f, 0.f), glm::vec3(1.f, 1.f, 1.f)));
+		glm::mat3 aboutCorner = ColliderBuilder::ShiftInertia(properties.inertiaTensor, properties.mass, glm::vec3(0.f, 0.f, 0.f) - properties.centerOfMass);
+		// m * (b^2 + c^2) / 3 on the diagonal, -m * a * b / 4 off it
+		REQUIRE(aboutCorner[0][0] == Approx(2.f / 3.f));
+		REQUIRE(aboutCorner[2][2] == Approx(2.f / 3.f));
+		REQUIRE(aboutCorner[0][1] == Approx(-0.25f));
+		REQUIRE(aboutCorner[2][1] == Approx(-0.25f));
+	}
+}
+
+TEST_CASE("Collider builder benchmark", "[.][benchmark]")
+{
+	std::vector<glm::vec3> points;
+	for (int i = 0; i < 64; i++)
+	{
+		// points on a sphere, spread with the golden angle
+		float y = 1.f - 2.f * (i + 0.5f) / 64.f;
+		float r = std::sqrt(1.f - y * y);
+		float phi = 2.39996323f * i;
+		points.push_back(glm::vec3(r * std::cos(phi), y, r * std::sin(phi)));
+	}
+
+	BENCHMARK("Quickhull - 64 points")
+	{
+		ColliderBuilder::BuildHull(points);
+	}
+	BENCHMARK("Brute force - 64 points")
+	{
+		ColliderBuilder::BuildHullBruteForce(points);
+	}
+}
@@ -1,6 +1,7 @@
 #include "catch.hpp"
 #include <memory>
 #include <iostream>
+#include <cmath>
 #include "../src/Systems/Physics/Collider.hpp"
 #include "../src/Systems/Physics/CollisionDetector.hpp"
 #include "../src/Systems/Physics/ColliderBuilder.hpp"
@@ -9,6 +10,7 @@
 TEST_CASE("CollisionDetector Test")
 {
 	CollisionDetector detector = CollisionDetector();
+	ContactArena arena;
 
 	/*
 		types of collisions - Currently we are only able to work with BOXES
@@ -103,17 +105,19 @@ TEST_CASE("CollisionDetector Test")
 		expectedPoints.push_back(glm::vec3(1.5f, 1.f, 0.5f));
 		expectedPoints.push_back(glm::vec3(2.f, 2.f, 2.f));
 		expectedPoints.push_back(glm::vec3(1.5f, 2.f, 0.5f));
-		std::shared_ptr<Collision> collision1 = detector.Collide(collider1, collider2);
+		expectedPoints.push_back(glm::vec3(2.f, 1.f, 2.f));
+		const Collision* collision1 = detector.Collide(collider1, collider2, arena);
 		REQUIRE(collision1 != nullptr);
-		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(-1.f, 0.f, 0.f), collision1->contacts[0].contactNormal, detector.tolerance)));
-		REQUIRE(collision1->contacts.size() == 3);
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(-1.f, 0.f, 0.f), arena.GetContacts(*collision1)[0].contactNormal, detector.tolerance)));
+		// the whole clipped incident face, (2, 1, 2) lies on the border of the reference face
+		REQUIRE(collision1->contactCount == 4);
 
 		for (int i = 0; i < expectedPoints.size(); i++)
 		{
 			bool found = false;
-			for (int j = 0; j < collision1->contacts.size(); j++)
+			for (int j = 0; j < collision1->contactCount; j++)
 			{
-				if (glm::all(glm::epsilonEqual(expectedPoints[i], collision1->contacts[j].contactPoint, detector.tolerance)))
+				if (glm::all(glm::epsilonEqual(expectedPoints[i], arena.GetContacts(*collision1)[j].contactPoint, detector.tolerance)))
 					found = true;
 			}
 			REQUIRE(found == true);
@@ -125,56 +129,73 @@ TEST_CASE("CollisionDetector Test")
 		expectedPoints.push_back(glm::vec3(1.5f, 1.f, 0.5f));
 		expectedPoints.push_back(glm::vec3(2.f, 2.f, 2.f));
 		expectedPoints.push_back(glm::vec3(1.5f, 2.f, 0.5f));
-		std::shared_ptr<Collision> collision1 = detector.Collide(collider2, collider1);
+		expectedPoints.push_back(glm::vec3(2.f, 1.f, 2.f));
+		const Collision* collision1 = detector.Collide(collider2, collider1, arena);
 		REQUIRE(collision1 != nullptr);
-		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(1.f, 0.f, 0.f), collision1->contacts[0].contactNormal, detector.tolerance)));
-		REQUIRE(collision1->contacts.size() == 3);
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(1.f, 0.f, 0.f), arena.GetContacts(*collision1)[0].contactNormal, detector.tolerance)));
+		// the whole clipped incident face, (2, 1, 2) lies on the border of the reference face
+		REQUIRE(collision1->contactCount == 4);
 		for (int i = 0; i < expectedPoints.size(); i++)
 		{
 			bool found = false;
-			for (int j = 0; j < collision1->contacts.size(); j++)
+			for (int j = 0; j < collision1->contactCount; j++)
 			{
-				if (glm::all(glm::epsilonEqual(expectedPoints[i], collision1->contacts[j].contactPoint, detector.tolerance)))
+				if (glm::all(glm::epsilonEqual(expectedPoints[i], arena.GetContacts(*collision1)[j].contactPoint, detector.tolerance)))
 					found = true;
 			}
 			REQUIRE(found == true);
 		}
 	}
+	SECTION("Generic SAT drops the contacts on the reference face border")
+	{
+		// the box fast path keeps them, the generic clipper loses points lying on a side plane
+		detector.useBoxNarrowphase = false;
+		const Collision* collision1 = detector.Collide(collider1, collider2, arena);
+		REQUIRE(collision1 != nullptr);
+		REQUIRE(collision1->contactCount == 3);
+		const Collision* collision4 = detector.Collide(collider1, collider4, arena);
+		REQUIRE(collision4 != nullptr);
+		REQUIRE(collision4->contactCount == 2);
+		REQUIRE(detector.GetStats().pairsBox == 0);
+	}
 	SECTION("Collider 1/3 - face/edge")
 	{
-		std::shared_ptr<Collision> collision2 = detector.Collide(collider1, collider3);
+		const Collision* collision2 = detector.Collide(collider1, collider3, arena);
 		REQUIRE(collision2 != nullptr);
-		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(0.f, -1.f, 0.f), collision2->contacts[0].contactNormal, detector.tolerance)));
-		REQUIRE(collision2->contacts.size() == 2);
-		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(1.f, 1.75f, 1.5f), collision2->contacts[1].contactPoint, detector.tolerance)));
-		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(1.f, 1.75f, .5f), collision2->contacts[0].contactPoint, detector.tolerance)));
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(0.f, -1.f, 0.f), arena.GetContacts(*collision2)[0].contactNormal, detector.tolerance)));
+		REQUIRE(collision2->contactCount == 2);
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(1.f, 1.75f, 1.5f), arena.GetContacts(*collision2)[1].contactPoint, detector.tolerance)));
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(1.f, 1.75f, .5f), arena.GetContacts(*collision2)[0].contactPoint, detector.tolerance)));
 	}
 	SECTION("Collider 3/1 - face/edge")
 	{
-		std::shared_ptr<Collision> collision2 = detector.Collide(collider3, collider1);
+		const Collision* collision2 = detector.Collide(collider3, collider1, arena);
 		REQUIRE(collision2 != nullptr);
-		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(0.f, 1.f, 0.f), collision2->contacts[0].contactNormal, detector.tolerance)));
-		REQUIRE(collision2->contacts.size() == 2);
-		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(1.f, 1.75f, 1.5f), collision2->contacts[1].contactPoint, detector.tolerance)));
-		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(1.f, 1.75f, .5f), collision2->contacts[0].contactPoint, detector.tolerance)));
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(0.f, 1.f, 0.f), arena.GetContacts(*collision2)[0].contactNormal, detector.tolerance)));
+		REQUIRE(collision2->contactCount == 2);
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(1.f, 1.75f, 1.5f), arena.GetContacts(*collision2)[1].contactPoint, detector.tolerance)));
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(1.f, 1.75f, .5f), arena.GetContacts(*collision2)[0].contactPoint, detector.tolerance)));
 	}
 
 	SECTION("Collider 1/4 - face/face")
 	{
-		std::shared_ptr<Collision> collision = detector.Collide(collider1, collider4);
+		const Collision* collision = detector.Collide(collider1, collider4, arena);
 		REQUIRE(collision != nullptr);
-		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(0.f, -1.f, 0.f), collision->contacts[0].contactNormal, detector.tolerance)));
-		REQUIRE(collision->contacts.size() == 2);
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(0.f, -1.f, 0.f), arena.GetContacts(*collision)[0].contactNormal, detector.tolerance)));
+		// the overlap is a 2 x 1.5 rectangle, one contact per corner
+		REQUIRE(collision->contactCount == 4);
 		std::vector<glm::vec3> expectedPoints;
 		expectedPoints.push_back(glm::vec3(2.f, 2.f, 2.f));
 		expectedPoints.push_back(glm::vec3(0.f, 2.f, 0.5f));
+		expectedPoints.push_back(glm::vec3(2.f, 2.f, 0.5f));
+		expectedPoints.push_back(glm::vec3(0.f, 2.f, 2.f));
 
 		for (int i = 0; i < expectedPoints.size(); i++)
 		{
 			bool found = false;
-			for (int j = 0; j < collision->contacts.size(); j++)
+			for (int j = 0; j < collision->contactCount; j++)
 			{
-				if (glm::all(glm::epsilonEqual(expectedPoints[i], collision->contacts[j].contactPoint, detector.tolerance)))
+				if (glm::all(glm::epsilonEqual(expectedPoints[i], arena.GetContacts(*collision)[j].contactPoint, detector.tolerance)))
 					found = true;
 			}
 			REQUIRE(found == true);
@@ -182,23 +203,23 @@ TEST_CASE("CollisionDetector Test")
 	}
 	SECTION("Collider 1/5 - edge/edge")
 	{
-		std::shared_ptr<Collision> collision = detector.Collide(collider1, collider5);
+		const Collision* collision = detector.Collide(collider1, collider5, arena);
 		REQUIRE(collision != nullptr);
-		REQUIRE(collision->contacts.size() == 1);
+		REQUIRE(collision->contactCount == 1);
 		glm::vec3 expectedNormal = glm::normalize(glm::cross(points1[1] - points1[5], points5[1] - points5[0]));
-		REQUIRE(glm::all(glm::epsilonEqual(-expectedNormal, collision->contacts[0].contactNormal, detector.tolerance)));
-		float penetrationCheck = collision->contacts[0].penetration - 0.174f;
+		REQUIRE(glm::all(glm::epsilonEqual(-expectedNormal, arena.GetContacts(*collision)[0].contactNormal, detector.tolerance)));
+		float penetrationCheck = arena.GetContacts(*collision)[0].penetration - 0.174f;
 		REQUIRE(penetrationCheck >= 0.f);
 		REQUIRE(penetrationCheck < 0.005f);
 	}
 	SECTION("Collider 5/1 - edge/edge")
 	{
-		std::shared_ptr<Collision> collision = detector.Collide(collider1, collider5);
+		const Collision* collision = detector.Collide(collider1, collider5, arena);
 		REQUIRE(collision != nullptr);
-		REQUIRE(collision->contacts.size() == 1);
+		REQUIRE(collision->contactCount == 1);
 		glm::vec3 expectedNormal = glm::normalize(glm::cross(points1[1] - points1[5], points5[1] - points5[0]));
-		REQUIRE(glm::all(glm::epsilonEqual(-expectedNormal, collision->contacts[0].contactNormal, detector.tolerance)));
-		float penetrationCheck = collision->contacts[0].penetration - 0.174f;
+		REQUIRE(glm::all(glm::epsilonEqual(-expectedNormal, arena.GetContacts(*collision)[0].contactNormal, detector.tolerance)));
+		float penetrationCheck = arena.GetContacts(*collision)[0].penetration - 0.174f;
 		REQUIRE(penetrationCheck >= 0.f);
 		REQUIRE(penetrationCheck < 0.005f);
 	}
@@ -209,16 +230,16 @@ TEST_CASE("CollisionDetector Test")
 		expectedPoints.push_back(glm::vec3(1.f, 2.f, 1.f));
 		expectedPoints.push_back(glm::vec3(1.6f, 2.f, 1.6f));
 		expectedPoints.push_back(glm::vec3(1.6f, 2.f, 1.6f));
-		std::shared_ptr<Collision> collision = detector.Collide(collider1, collider6);
+		const Collision* collision = detector.Collide(collider1, collider6, arena);
 		REQUIRE(collision != nullptr);
-		REQUIRE(collision->contacts.size() == 4);
+		REQUIRE(collision->contactCount == 4);
 
 		for (int i = 0; i < expectedPoints.size(); i++)
 		{
 			bool found = false;
-			for (int j = 0; j < collision->contacts.size(); j++)
+			for (int j = 0; j < collision->contactCount; j++)
 			{
-				if (glm::all(glm::epsilonEqual(expectedPoints[i], collision->contacts[j].contactPoint, detector.tolerance)))
+				if (glm::all(glm::epsilonEqual(expectedPoints[i], arena.GetContacts(*collision)[j].contactPoint, detector.tolerance)))
 					found = true;
 			}
 			REQUIRE(found == true);
@@ -231,16 +252,16 @@ TEST_CASE("CollisionDetector Test")
 		expectedPoints.push_back(glm::vec3(1.f, 1.9f, 1.f));
 		expectedPoints.push_back(glm::vec3(1.6f, 1.9f, 1.6f));
 		expectedPoints.push_back(glm::vec3(1.6f, 1.9f, 1.6f));
-		std::shared_ptr<Collision> collision = detector.Collide(collider6, collider1);
+		const Collision* collision = detector.Collide(collider6, collider1, arena);
 		REQUIRE(collision != nullptr);
-		REQUIRE(collision->contacts.size() == 4);
+		REQUIRE(collision->contactCount == 4);
 
 		for (int i = 0; i < expectedPoints.size(); i++)
 		{
 			bool found = false;
-			for (int j = 0; j < collision->contacts.size(); j++)
+			for (int j = 0; j < collision->contactCount; j++)
 			{
-				if (glm::all(glm::epsilonEqual(expectedPoints[i], collision->contacts[j].contactPoint, detector.tolerance)))
+				if (glm::all(glm::epsilonEqual(expectedPoints[i], arena.GetContacts(*collision)[j].contactPoint, detector.tolerance)))
 					found = true;
 			}
 			REQUIRE(found == true);
@@ -254,16 +275,16 @@ TEST_CASE("CollisionDetector Test")
 		expectedPoints.push_back(glm::vec3(0.f, 1.f, 2.f));
 		expectedPoints.push_back(glm::vec3(2.f, 1.f, 2.f));
 		expectedPoints.push_back(glm::vec3(2.f, 1.5f, 2.f));
-		std::shared_ptr<Collision> collision = detector.Collide(collider1, collider7);
+		const Collision* collision = detector.Collide(collider1, collider7, arena);
 		REQUIRE(collision != nullptr);
-		REQUIRE(collision->contacts.size() == 4);
+		REQUIRE(collision->contactCount == 4);
 
 		for (int i = 0; i < expectedPoints.size(); i++)
 		{
 			bool found = false;
-			for (int j = 0; j < collision->contacts.size(); j++)
+			for (int j = 0; j < collision->contactCount; j++)
 			{
-				if (glm::all(glm::epsilonEqual(expectedPoints[i], collision->contacts[j].contactPoint, detector.tolerance)))
+				if (glm::all(glm::epsilonEqual(expectedPoints[i], arena.GetContacts(*collision)[j].contactPoint, detector.tolerance)))
 					found = true;
 			}
 			REQUIRE(found == true);
@@ -276,19 +297,426 @@ TEST_CASE("CollisionDetector Test")
 		expectedPoints.push_back(glm::vec3(0.f, 1.f, 1.95f));
 		expectedPoints.push_back(glm::vec3(2.f, 1.f, 1.95f));
 		expectedPoints.push_back(glm::vec3(2.f, 1.5f, 1.95f));
-		std::shared_ptr<Collision> collision = detector.Collide(collider7, collider1);
+		const Collision* collision = detector.Collide(collider7, collider1, arena);
 		REQUIRE(collision != nullptr);
-		REQUIRE(collision->contacts.size() == 4);
+		REQUIRE(collision->contactCount == 4);
 
 		for (int i = 0; i < expectedPoints.size(); i++)
 		{
 			bool found = false;
-			for (int j = 0; j < collision->contacts.size(); j++)
+			for (int j = 0; j < collision->contactCount; j++)
 			{
-				if (glm::all(glm::epsilonEqual(expectedPoints[i], collision->contacts[j].contactPoint, detector.tolerance)))
+				if (glm::all(glm::epsilonEqual(expectedPoints[i], arena.GetContacts(*collision)[j].contactPoint, detector.tolerance)))
 					found = true;
 			}
 			REQUIRE(found == true);
 		}
 	}
-}
\ No newline at end of file
+}
+TEST_CASE("CollisionDetector Test - rotated colliders sharing a hull")
+{
+	CollisionDetector detector = CollisionDetector();
+	ContactArena arena;
+
+	std::vector<glm::vec3> points;
+	points.push_back(glm::vec3(-1.f, -1.f, -1.f));
+	points.push_back(glm::vec3(1.f, -1.f, -1.f));
+	points.push_back(glm::vec3(1.f, 1.f, -1.f));
+	points.push_back(glm::vec3(-1.f, 1.f, -1.f));
+	points.push_back(glm::vec3(-1.f, -1.f, 1.f));
+	points.push_back(glm::vec3(1.f, -1.f, 1.f));
+	points.push_back(glm::vec3(1.f, 1.f, 1.f));
+	points.push_back(glm::vec3(-1.f, 1.f, 1.f));
+	std::shared_ptr<const Hull> hull = ColliderBuilder::BuildHull(points);
+
+	glm::quat identity(1.f, 0.f, 0.f, 0.f);
+	std::shared_ptr<Collider> collider1 = std::make_shared<Collider>(1, glm::vec3(0.f, 0.f, 0.f), hull, DynamicType::Static);
+	std::shared_ptr<Collider> collider2 = std::make_shared<Collider>(2, glm::vec3(2.2f, 0.5f, 0.f), hull, DynamicType::Dynamic);
+	collider2->Attach(glm::vec3(2.2f, 0.5f, 0.f), identity);
+
+	REQUIRE(collider1->GetHull() == collider2->GetHull());
+	REQUIRE(detector.Collide(collider1, collider2, arena) == nullptr);
+
+	SECTION("rotating the body rotates the collider without touching the hull")
+	{
+		glm::quat rotation = glm::angleAxis(glm::radians(45.f), glm::vec3(0.f, 1.f, 0.f));
+		collider2->Update(glm::vec3(2.2f, 0.5f, 0.f), rotation);
+		REQUIRE(glm::all(glm::epsilonEqual(points[0], collider2->GetPoints()[0], detector.tolerance)));
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(2.2f, 0.5f, 0.f), collider2->center, detector.tolerance)));
+
+		const Collision* collision = detector.Collide(collider1, collider2, arena);
+		REQUIRE(collision != nullptr);
+		REQUIRE(collision->contactCount == 2);
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(-1.f, 0.f, 0.f), arena.GetContacts(*collision)[0].contactNormal, detector.tolerance)));
+		float tip = 2.2f - std::sqrt(2.f);
+		for (int i = 0; i < collision->contactCount; i++)
+		{
+			REQUIRE(std::abs(arena.GetContacts(*collision)[i].contactPoint.x - tip) < 0.005f);
+			REQUIRE(std::abs(arena.GetContacts(*collision)[i].contactPoint.z) < 0.005f);
+			REQUIRE(std::abs(arena.GetContacts(*collision)[i].penetration - (1.f - tip)) < 0.005f);
+		}
+	}
+	SECTION("the first collider frame can be rotated as well")
+	{
+		glm::quat rotation = glm::angleAxis(glm::radians(45.f), glm::vec3(0.f, 1.f, 0.f));
+		collider1->Update(glm::vec3(0.f, 0.f, 0.f), rotation);
+		const Collision* collision = detector.Collide(collider1, collider2, arena);
+		REQUIRE(collision != nullptr);
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(-1.f, 0.f, 0.f), arena.GetContacts(*collision)[0].contactNormal, detector.tolerance)));
+	}
+}
+
+TEST_CASE("CollisionDetector Test - bounds early out and stats")
+{
+	CollisionDetector detector = CollisionDetector();
+	ContactArena arena;
+
+	std::vector<glm::vec3> points;
+	points.push_back(glm::vec3(0.f, 0.f, 0.f));
+	points.push_back(glm::vec3(2.f, 0.f, 0.f));
+	points.push_back(glm::vec3(2.f, 2.f, 0.f));
+	points.push_back(glm::vec3(0.f, 2.f, 0.f));
+	points.push_back(glm::vec3(0.f, 0.f, 2.f));
+	points.push_back(glm::vec3(2.f, 0.f, 2.f));
+	points.push_back(glm::vec3(2.f, 2.f, 2.f));
+	points.push_back(glm::vec3(0.f, 2.f, 2.f));
+	std::shared_ptr<Collider> collider1 = ColliderBuilder::Build(1, DynamicType::Static, points);
+
+	REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(0.f, 0.f, 0.f), collider1->aabbMin, detector.tolerance)));
+	REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(2.f, 2.f, 2.f), collider1->aabbMax, detector.tolerance)));
+	REQUIRE(std::abs(collider1->radius - std::sqrt(3.f)) < detector.tolerance);
+
+	for (int i = 0; i < points.size(); i++)
+		points[i] += glm::vec3(1.5f, 0.5f, 0.5f);
+	std::shared_ptr<Collider> collider2 = ColliderBuilder::Build(2, DynamicType::Dynamic, points);
+
+	for (int i = 0; i < points.size(); i++)
+		points[i] += glm::vec3(10.f, 0.f, 0.f);
+	std::shared_ptr<Collider> collider3 = ColliderBuilder::Build(3, DynamicType::Dynamic, points);
+
+	// spheres overlap, boxes do not
+	for (int i = 0; i < points.size(); i++)
+		points[i] = points[i] - glm::vec3(11.5f, 0.5f, 0.5f) + glm::vec3(2.3f, 2.3f, 0.f);
+	std::shared_ptr<Collider> collider4 = ColliderBuilder::Build(4, DynamicType::Dynamic, points);
+
+	REQUIRE(detector.Collide(collider1, collider2, arena) != nullptr);
+	REQUIRE(detector.Collide(collider1, collider3, arena) == nullptr);
+	REQUIRE(detector.Collide(collider1, collider4, arena) == nullptr);
+
+	const CollisionStats& stats = detector.GetStats();
+	REQUIRE(stats.pairsTested == 3);
+	REQUIRE(stats.pairsRejectedEarly == 2);
+	REQUIRE(stats.pairsBox == 1);
+	REQUIRE(stats.pairsFullSAT == 0);
+
+	SECTION("moving a collider updates its bounds")
+	{
+		glm::quat identity(1.f, 0.f, 0.f, 0.f);
+		collider3->Attach(collider3->center, identity);
+		collider3->Update(collider2->center, identity);
+		REQUIRE(glm::all(glm::epsilonEqual(collider2->aabbMin, collider3->aabbMin, detector.tolerance)));
+		REQUIRE(detector.Collide(collider1, collider3, arena) != nullptr);
+		REQUIRE(detector.GetStats().pairsBox == 2);
+	}
+	SECTION("reset")
+	{
+		detector.ResetStats();
+		REQUIRE(detector.GetStats().pairsTested == 0);
+	}
+}
+
+TEST_CASE("CollisionDetector Test - Minkowski face test")
+{
+	CollisionDetector detector = CollisionDetector();
+	ContactArena arena;
+	glm::vec3 x(1.f, 0.f, 0.f);
+	glm::vec3 y(0.f, 1.f, 0.f);
+	glm::vec3 z(0.f, 0.f, 1.f);
+	// edge of A between the +x and +y faces against an edge of B between its -x and -z faces (negated: +x, +z)
+	REQUIRE(detector.IsMinkowskiFace(x, y, glm::normalize(x + z + 0.5f * y), glm::normalize(x - z + 0.5f * y)) == true);
+	// arcs on opposite sides of the sphere
+	REQUIRE(detector.IsMinkowskiFace(x, y, -x, -z) == false);
+	REQUIRE(detector.IsMinkowskiFace(x, y, -y, z) == false);
+}
+
+TEST_CASE("CollisionDetector Test - GJK/EPA backend")
+{
+	CollisionDetector detector = CollisionDetector();
+	ContactArena arena;
+
+	std::vector<glm::vec3> points1;
+	points1.push_back(glm::vec3(0.f, 0.f, 0.f));
+	points1.push_back(glm::vec3(2.f, 0.f, 0.f));
+	points1.push_back(glm::vec3(2.f, 2.f, 0.f));
+	points1.push_back(glm::vec3(0.f, 2.f, 0.f));
+	points1.push_back(glm::vec3(0.f, 0.f, 2.f));
+	points1.push_back(glm::vec3(2.f, 0.f, 2.f));
+	points1.push_back(glm::vec3(2.f, 2.f, 2.f));
+	points1.push_back(glm::vec3(0.f, 2.f, 2.f));
+	std::shared_ptr<Collider> collider1 = ColliderBuilder::Build(1, DynamicType::Static, points1);
+
+	std::vector<glm::vec3> points2;
+	for (int i = 0; i < points1.size(); i++)
+		points2.push_back(points1[i] + glm::vec3(3.5f, 0.5f, 0.5f));
+	std::shared_ptr<Collider> collider2 = ColliderBuilder::Build(2, DynamicType::Dynamic, points2);
+
+	std::vector<glm::vec3> points3;
+	for (int i = 0; i < points1.size(); i++)
+		points3.push_back(points1[i] + glm::vec3(1.5f, 0.5f, 0.5f));
+	std::shared_ptr<Collider> collider3 = ColliderBuilder::Build(3, DynamicType::Dynamic, points3);
+
+	// 12-sided prism
+	std::vector<glm::vec3> prism;
+	for (int i = 0; i < 12; i++)
+	{
+		float angle = glm::radians(30.f * i);
+		prism.push_back(glm::vec3(1.f + std::cos(angle), 1.f, 1.f + std::sin(angle)));
+		prism.push_back(glm::vec3(1.f + std::cos(angle), 3.f, 1.f + std::sin(angle)));
+	}
+	for (int i = 0; i < prism.size(); i++)
+		prism[i] += glm::vec3(0.f, 0.8f, 0.f);
+	std::shared_ptr<Collider> collider4 = ColliderBuilder::Build(4, DynamicType::Dynamic, prism);
+
+	SECTION("distance query")
+	{
+		glm::vec3 closest1, closest2;
+		float distance = detector.Distance(collider1, collider2, closest1, closest2);
+		REQUIRE(std::abs(distance - 1.5f) < 0.005f);
+		REQUIRE(std::abs(closest1.x - 2.f) < 0.005f);
+		REQUIRE(std::abs(closest2.x - 3.5f) < 0.005f);
+		REQUIRE(detector.Distance(collider1, collider3, closest1, closest2) == 0.f);
+	}
+	SECTION("policy")
+	{
+		REQUIRE(detector.SelectNarrowphase(*collider1, *collider3) == NarrowphaseType::BoxNarrowphase);
+		REQUIRE(detector.SelectNarrowphase(*collider1, *collider4) == NarrowphaseType::GJKNarrowphase);
+	}
+	SECTION("EPA agrees with SAT")
+	{
+		const Collision* satCollision = detector.Collide(collider1, collider3, arena);
+		detector.gjkThreshold = 0;
+		const Collision* gjkCollision = detector.Collide(collider1, collider3, arena);
+		REQUIRE(gjkCollision != nullptr);
+		REQUIRE(gjkCollision->contactCount == 1);
+		REQUIRE(glm::all(glm::epsilonEqual(arena.GetContacts(*satCollision)[0].contactNormal, arena.GetContacts(*gjkCollision)[0].contactNormal, 0.005f)));
+		REQUIRE(std::abs(arena.GetContacts(*satCollision)[0].penetration - arena.GetContacts(*gjkCollision)[0].penetration) < 0.005f);
+		REQUIRE(detector.Collide(collider1, collider2, arena) == nullptr);
+		REQUIRE(detector.GetStats().pairsGJK == 1);
+		REQUIRE(detector.GetStats().pairsRejectedEarly == 1);
+	}
+	SECTION("complex hull goes through GJK")
+	{
+		const Collision* collision = detector.Collide(collider1, collider4, arena);
+		REQUIRE(collision != nullptr);
+		REQUIRE(detector.GetStats().pairsGJK == 1);
+		REQUIRE(detector.GetStats().pairsFullSAT == 0);
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(0.f, -1.f, 0.f), arena.GetContacts(*collision)[0].contactNormal, 0.005f)));
+		REQUIRE(std::abs(arena.GetContacts(*collision)[0].penetration - 0.2f) < 0.005f);
+	}
+}
+
+TEST_CASE("CollisionDetector Test - box fast path")
+{
+	CollisionDetector boxDetector = CollisionDetector();
+	CollisionDetector satDetector = CollisionDetector();
+	satDetector.useBoxNarrowphase = false;
+	ContactArena boxArena;
+	ContactArena satArena;
+
+	std::vector<glm::vec3> points;
+	for (int i = 0; i < 8; i++)
+		points.push_back(glm::vec3(i & 1 ? 1.f : -1.f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.75f : -0.75f));
+	std::shared_ptr<Collider> collider1 = ColliderBuilder::Build(1, DynamicType::Static, points);
+	std::shared_ptr<Collider> collider2 = ColliderBuilder::Build(2, DynamicType::Dynamic, points);
+
+	SECTION("boxes are detected")
+	{
+		std::shared_ptr<const Hull> hull = collider1->GetHull();
+		REQUIRE(hull->isBox == true);
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(1.f, 0.5f, 0.75f), glm::abs(hull->boxAxes * hull->boxHalfExtents), 0.005f)));
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(0.f, 0.f, 0.f), hull->boxCenter, 0.005f)));
+
+		std::vector<glm::vec3> wedge = points;
+		wedge[7].y = 0.f;
+		REQUIRE(ColliderBuilder::Build(3, DynamicType::Static, wedge)->GetHull()->isBox == false);
+	}
+	SECTION("same result as the generic SAT")
+	{
+		glm::quat identity(1.f, 0.f, 0.f, 0.f);
+		collider2->Attach(collider2->center, identity);
+		int collisions = 0;
+		for (int i = 0; i < 40; i++)
+		{
+			glm::vec3 axis = glm::normalize(glm::vec3(std::sin(1.3f * i), std::cos(0.7f * i), 0.5f + std::sin(0.3f * i)));
+			glm::quat rotation = glm::angleAxis(0.37f * i, axis);
+			glm::vec3 position = glm::vec3(1.2f * std::cos(0.9f * i), 0.8f * std::sin(1.7f * i), 0.9f * std::sin(0.5f * i));
+			collider2->Update(position, rotation);
+
+			const Collision* box = boxDetector.Collide(collider1, collider2, boxArena);
+			const Collision* sat = satDetector.Collide(collider1, collider2, satArena);
+			REQUIRE((box == nullptr) == (sat == nullptr));
+			if (box == nullptr)
+				continue;
+			collisions++;
+			REQUIRE(std::abs(boxArena.GetContacts(*box)[0].penetration - satArena.GetContacts(*sat)[0].penetration) < 0.005f);
+			REQUIRE(glm::all(glm::epsilonEqual(boxArena.GetContacts(*box)[0].contactNormal, satArena.GetContacts(*sat)[0].contactNormal, 0.005f)));
+			// edge/edge - the generic SAT may pick any of the parallel edges, only check the point is in both boxes
+			if (sat->contactCount == 1)
+			{
+				glm::vec3 point = boxArena.GetContacts(*box)[0].contactPoint;
+				REQUIRE(glm::all(glm::lessThanEqual(collider1->aabbMin - 0.005f, point)));
+				REQUIRE(glm::all(glm::lessThanEqual(point, collider1->aabbMax + 0.005f)));
+				REQUIRE(glm::all(glm::lessThanEqual(collider2->aabbMin - 0.005f, point)));
+				REQUIRE(glm::all(glm::lessThanEqual(point, collider2->aabbMax + 0.005f)));
+				continue;
+			}
+			for (int j = 0; j < sat->contactCount; j++)
+			{
+				bool found = false;
+				for (int k = 0; k < box->contactCount; k++)
+				{
+					if (glm::all(glm::epsilonEqual(satArena.GetContacts(*sat)[j].contactPoint, boxArena.GetContacts(*box)[k].contactPoint, 0.005f)))
+						found = true;
+				}
+				REQUIRE(found == true);
+			}
+		}
+		REQUIRE(collisions > 0);
+		REQUIRE(boxDetector.GetStats().pairsBox == boxDetector.GetStats().pairsTested - boxDetector.GetStats().pairsRejectedEarly);
+		REQUIRE(boxDetector.GetStats().pairsFullSAT == 0);
+	}
+	SECTION("grazing boxes meet edge to edge")
+	{
+		// rotated boxes from the pile benchmark. They overlap on all 15 axes, the face axis wins through the face/edge
+		// tolerance but its clipped incident face misses the reference face, the contact comes from the best edge axis
+		std::vector<glm::vec3> pointsA = {
+			glm::vec3(86.0389786f, 6.28426123f, 89.8360443f),
+			glm::vec3(85.8539581f, 6.28198195f, 91.3183517f),
+			glm::vec3(85.9708252f, 6.9080267f, 89.8284988f),
+			glm::vec3(85.7858047f, 6.90574741f, 91.3108063f),
+			glm::vec3(85.0326462f, 6.17279148f, 89.7102661f),
+			glm::vec3(84.8476257f, 6.1705122f, 91.1925735f),
+			glm::vec3(84.9644928f, 6.79655695f, 89.7027206f),
+			glm::vec3(84.7794724f, 6.79427767f, 91.1850281f)
+		};
+		std::vector<glm::vec3> pointsB = {
+			glm::vec3(85.8360825f, 6.90822983f, 90.8796234f),
+			glm::vec3(86.4127655f, 6.91404629f, 90.1645203f),
+			glm::vec3(86.3528366f, 7.94374275f, 91.3047714f),
+			glm::vec3(86.9295197f, 7.94955873f, 90.5896606f),
+			glm::vec3(86.6779785f, 6.21167707f, 91.5529022f),
+			glm::vec3(87.2546616f, 6.21749306f, 90.8377914f),
+			glm::vec3(87.1947327f, 7.24718952f, 91.9780426f),
+			glm::vec3(87.7714157f, 7.25300598f, 91.2629395f)
+		};
+		std::shared_ptr<Collider> grazingA = ColliderBuilder::Build(3, DynamicType::Dynamic, pointsA);
+		std::shared_ptr<Collider> grazingB = ColliderBuilder::Build(4, DynamicType::Dynamic, pointsB);
+		glm::quat identity(1.f, 0.f, 0.f, 0.f);
+		grazingA->Attach(grazingA->center, identity);
+		grazingB->Attach(grazingB->center, identity);
+
+		const Collision* box = boxDetector.Collide(grazingA, grazingB, boxArena);
+		REQUIRE(box != nullptr);
+		REQUIRE(box->contactCount == 1);
+		REQUIRE(boxArena.GetContacts(*box)[0].penetration > 0.f);
+		REQUIRE(boxDetector.GetStats().pairsBox == 1);
+		REQUIRE(boxDetector.GetStats().pairsFullSAT == 0);
+
+		const Collision* sat = satDetector.Collide(grazingA, grazingB, satArena);
+		REQUIRE(sat != nullptr);
+		REQUIRE(sat->contactCount == 1);
+		REQUIRE(satArena.GetContacts(*sat)[0].penetration > 0.f);
+		REQUIRE(glm::all(glm::epsilonEqual(boxArena.GetContacts(*box)[0].contactPoint, satArena.GetContacts(*sat)[0].contactPoint, 0.005f)));
+		REQUIRE(glm::all(glm::epsilonEqual(boxArena.GetContacts(*box)[0].contactNormal, satArena.GetContacts(*sat)[0].contactNormal, 0.005f)));
+	}
+}
+
+TEST_CASE("CollisionDetector benchmark - boxes", "[.][benchmark]")
+{
+	CollisionDetector boxDetector = CollisionDetector();
+	CollisionDetector satDetector = CollisionDetector();
+	satDetector.useBoxNarrowphase = false;
+	ContactArena boxArena;
+	ContactArena satArena;
+
+	std::vector<glm::vec3> points;
+	for (int i = 0; i < 8; i++)
+		points.push_back(glm::vec3(i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, i & 4 ? 1.f : -1.f));
+	std::shared_ptr<Collider> collider1 = ColliderBuilder::Build(1, DynamicType::Static, points);
+	std::shared_ptr<Collider> collider2 = ColliderBuilder::Build(2, DynamicType::Dynamic, points);
+	collider2->Attach(collider2->center, glm::quat(1.f, 0.f, 0.f, 0.f));
+	collider2->Update(glm::vec3(0.5f, 1.7f, 0.3f), glm::angleAxis(0.4f, glm::normalize(glm::vec3(1.f, 1.f, 0.f))));
+
+	BENCHMARK("Box/box - 15 axis SAT")
+	{
+		boxArena.Clear();
+		for (int i = 0; i < 1000; i++)
+			boxDetector.Collide(collider1, collider2, boxArena);
+	}
+	BENCHMARK("Box/box - generic SAT")
+	{
+		satArena.Clear();
+		for (int i = 0; i < 1000; i++)
+			satDetector.Collide(collider1, collider2, satArena);
+	}
+}
+
+TEST_CASE("CollisionDetector Test - time of impact")
+{
+	CollisionDetector detector = CollisionDetector();
+	ContactArena arena;
+	std::vector<glm::vec3> wallPoints;
+	std::vector<glm::vec3> boxPoints;
+	for (int i = 0; i < 8; i++)
+	{
+		wallPoints.push_back(glm::vec3(i & 1 ? 5.1f : 5.f, i & 2 ? 2.f : -2.f, i & 4 ? 2.f : -2.f));
+		boxPoints.push_back(glm::vec3(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f));
+	}
+	std::shared_ptr<Collider> wall = ColliderBuilder::Build(1, DynamicType::Static, wallPoints);
+	std::shared_ptr<Collider> box = ColliderBuilder::Build(2, DynamicType::Dynamic, boxPoints);
+	glm::quat identity(1.f, 0.f, 0.f, 0.f);
+	box->Attach(box->center, identity);
+
+	float toi = 0.f;
+	SECTION("hit through the wall")
+	{
+		REQUIRE(detector.TimeOfImpact(box, glm::vec3(0.f, 0.f, 0.f), identity, glm::vec3(10.f, 0.f, 0.f), identity, wall, toi) == true);
+		// the box face reaches x = 5 after 4.5 units
+		REQUIRE(std::abs(toi - 0.45f) < detector.toiTolerance);
+		// left at the end pose
+		REQUIRE(std::abs(box->center.x - 10.f) < 0.005f);
+	}
+	SECTION("rotating while moving")
+	{
+		glm::quat spin = glm::angleAxis(1.5f, glm::vec3(0.f, 1.f, 0.f));
+		REQUIRE(detector.TimeOfImpact(box, glm::vec3(0.f, 0.f, 0.f), identity, glm::vec3(10.f, 0.f, 0.f), spin, wall, toi) == true);
+		REQUIRE(toi < 0.45f);
+	}
+	SECTION("miss beside the wall")
+	{
+		REQUIRE(detector.TimeOfImpact(box, glm::vec3(0.f, 0.f, 3.f), identity, glm::vec3(10.f, 0.f, 3.f), identity, wall, toi) == false);
+	}
+	SECTION("touching the wall at the start")
+	{
+		// the box face rests on the wall at x = 5
+		REQUIRE(detector.TimeOfImpact(box, glm::vec3(4.5f, 0.f, 0.f), identity, glm::vec3(14.5f, 0.f, 0.f), identity, wall, toi) == true);
+		REQUIRE(toi == 0.f);
+		// sliding along it or leaving it is not a hit
+		REQUIRE(detector.TimeOfImpact(box, glm::vec3(4.5f, 0.f, 0.f), identity, glm::vec3(4.5f, 0.f, 3.f), identity, wall, toi) == false);
+		REQUIRE(detector.TimeOfImpact(box, glm::vec3(4.5f, 0.f, 0.f), identity, glm::vec3(-5.5f, 0.f, 0.f), identity, wall, toi) == false);
+		// slightly inside it, like a bullet placed past its impact by the last sweep
+		REQUIRE(detector.TimeOfImpact(box, glm::vec3(4.52f, 0.f, 0.f), identity, glm::vec3(14.52f, 0.f, 0.f), identity, wall, toi) == true);
+		REQUIRE(toi == 0.f);
+	}
+	SECTION("touching a triangle at the start")
+	{
+		glm::vec3 a(5.f, -2.f, -2.f);
+		glm::vec3 b(5.f, 2.f, -2.f);
+		glm::vec3 c(5.f, 0.f, 2.f);
+		REQUIRE(detector.TimeOfImpact(box, glm::vec3(0.f, 0.f, 0.f), identity, glm::vec3(10.f, 0.f, 0.f), identity, a, b, c, toi) == true);
+		REQUIRE(std::abs(toi - 0.45f) < detector.toiTolerance);
+		REQUIRE(detector.TimeOfImpact(box, glm::vec3(4.52f, 0.f, 0.f), identity, glm::vec3(14.52f, 0.f, 0.f), identity, a, b, c, toi) == true);
+		REQUIRE(toi == 0.f);
+		REQUIRE(detector.TimeOfImpact(box, glm::vec3(4.52f, 0.f, 0.f), identity, glm::vec3(-5.48f, 0.f, 0.f), identity, a, b, c, toi) == false);
+	}
+}
@@ -0,0 +1,94 @@
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "catch.hpp"
+#include "../src/Systems/Physics/Grid.hpp"
+#include "../src/Systems/Physics/ColliderBuilder.hpp"
+#include "../src/Systems/Physics/CompoundCollider.hpp"
+
+TEST_CASE("CompoundCollider Test")
+{
+	// L shaped body - a long bar along x and a post going up at its end, they overlap at the corner
+	std::vector<std::shared_ptr<Collider>> children;
+	children.push_back(ColliderBuilder::BuildBox(1, DynamicType::Dynamic, glm::vec3(40.f, 0.f, 40.f), glm::vec3(50.f, 2.f, 42.f)));
+	children.push_back(ColliderBuilder::BuildBox(1, DynamicType::Dynamic, glm::vec3(48.f, 0.f, 40.f), glm::vec3(50.f, 10.f, 42.f)));
+	for (int i = 0; i < 6; i++)
+		children.push_back(ColliderBuilder::BuildBox(1, DynamicType::Dynamic, glm::vec3(40.f + i, 2.f, 40.f), glm::vec3(41.f + i, 3.f, 41.f)));
+	std::shared_ptr<CompoundCollider> compound = ColliderBuilder::BuildCompound(1, DynamicType::Dynamic, children);
+	REQUIRE(compound->isCompound);
+	REQUIRE(compound->GetChildren().size() == 8);
+	REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(40.f, 0.f, 40.f), compound->aabbMin, 0.001f)));
+	REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(50.f, 10.f, 42.f), compound->aabbMax, 0.001f)));
+
+	SECTION("query only returns the children under the bounds")
+	{
+		std::vector<std::shared_ptr<Collider>> parts;
+		compound->Query(glm::vec3(49.f, 8.f, 41.f), glm::vec3(51.f, 9.f, 41.5f), parts);
+		REQUIRE(parts.size() == 1);
+		REQUIRE(parts[0] == children[1]);
+
+		parts.clear();
+		compound->Query(glm::vec3(41.5f, 5.f, 40.f), glm::vec3(43.f, 9.f, 42.f), parts);
+		REQUIRE(parts.size() == 0);
+	}
+
+	SECTION("children move with the body")
+	{
+		glm::vec3 position = compound->center;
+		glm::quat orientation(1.f, 0.f, 0.f, 0.f);
+		compound->Attach(position, orientation);
+		compound->entityID = 9;
+		compound->Attach(position, orientation);
+		REQUIRE(children[3]->entityID == 9);
+
+		compound->Update(position + glm::vec3(0.f, 5.f, 0.f), orientation);
+		REQUIRE(std::abs(children[1]->aabbMax.y - 15.f) < 0.001f);
+		REQUIRE(std::abs(compound->aabbMax.y - 15.f) < 0.001f);
+
+		// a quarter turn around y, the post ends up at the far end along -z
+		glm::quat turn = glm::angleAxis(glm::radians(90.f), glm::vec3(0.f, 1.f, 0.f));
+		compound->Update(position, turn);
+		std::vector<std::shared_ptr<Collider>> parts;
+		compound->Query(children[1]->aabbMin, children[1]->aabbMax, parts);
+		REQUIRE(std::find(parts.begin(), parts.end(), children[1]) != parts.end());
+		REQUIRE(std::abs(compound->aabbMax.z - compound->aabbMin.z - 10.f) < 0.001f);
+	}
+
+	SECTION("grid uses a single proxy")
+	{
+		Grid grid(200.f, 5.f);
+		grid.Insert(compound);
+		int inserted = 0;
+		for (int row = 0; row < grid.cells.size(); row++)
+		{
+			for (int col = 0; col < grid.cells[row].size(); col++)
+				inserted += grid.cells[row][col].GetDynamicColliders().size();
+		}
+		REQUIRE(inserted == 1);
+
+		// overlapping children of the same body never collide with each other
+		REQUIRE(grid.CheckCollisions().size() == 0);
+
+		// inside the bounds of the proxy but above the bar, next to the post
+		std::shared_ptr<Collider> hovering = ColliderBuilder::BuildBox(2, DynamicType::Static, glm::vec3(44.f, 5.f, 40.5f), glm::vec3(45.f, 6.f, 41.5f));
+		grid.Insert(hovering);
+		REQUIRE(grid.CheckCollisions().size() == 0);
+
+		// touching the post only
+		std::shared_ptr<Collider> touching = ColliderBuilder::BuildBox(3, DynamicType::Static, glm::vec3(49.5f, 7.f, 40.5f), glm::vec3(51.f, 8.f, 41.5f));
+		grid.Insert(touching);
+		grid.ResetCollisionStats();
+		const std::vector<Collision>& collisions = grid.CheckCollisions();
+		REQUIRE(collisions.size() == 1);
+		REQUIRE(&grid.GetContactArena().GetCollider(collisions[0].firstCollider) == children[1].get());
+		REQUIRE(collisions[0].second == 3);
+		REQUIRE(grid.GetCollisionStats().pairsTested == 1);
+
+		std::vector<QueryHit> hits;
+		REQUIRE(grid.Raycast(glm::vec3(44.5f, 20.f, 40.5f), glm::vec3(0.f, -1.f, 0.f), 30.f, hits) == 3);
+		REQUIRE(std::abs(hits[0].distance - 14.f) < 0.001f);
+		REQUIRE(hits[0].entityID == 2);
+		REQUIRE(std::abs(hits[1].distance - 17.f) < 0.001f);
+		REQUIRE(hits[1].entityID == 1);
+	}
+}
@@ -0,0 +1,34 @@
+#include "catch.hpp"
+#include "../src/Systems/Rendering/DebugDrawer.hpp"
+
+TEST_CASE("Debug drawer")
+{
+	DebugDrawer::Clear();
+	DebugDrawer::SetEnabled(true);
+
+	SECTION("Lines and points are collected until cleared")
+	{
+		DebugDrawer::Line(glm::vec3(0.f, 0.f, 0.f), glm::vec3(1.f, 0.f, 0.f), glm::vec3(1.f, 0.f, 0.f));
+		DebugDrawer::Point(glm::vec3(0.f, 2.f, 0.f), glm::vec3(0.f, 1.f, 0.f));
+		DebugDrawer::Axes(glm::mat4(1.f), 2.f);
+
+		REQUIRE(DebugDrawer::GetLines().size() == 8);
+		REQUIRE(DebugDrawer::GetLines()[1].position == glm::vec3(1.f, 0.f, 0.f));
+		REQUIRE(DebugDrawer::GetLines()[7].position == glm::vec3(0.f, 0.f, 2.f));
+		REQUIRE(DebugDrawer::GetPoints().size() == 1);
+
+		DebugDrawer::Clear();
+		REQUIRE(DebugDrawer::GetLines().empty());
+		REQUIRE(DebugDrawer::GetPoints().empty());
+	}
+
+	SECTION("Disabled drawing drops everything")
+	{
+		DebugDrawer::Line(glm::vec3(0.f, 0.f, 0.f), glm::vec3(1.f, 0.f, 0.f), glm::vec3(1.f, 0.f, 0.f));
+		DebugDrawer::SetEnabled(false);
+		REQUIRE(DebugDrawer::GetLines().empty());
+		DebugDrawer::Point(glm::vec3(0.f, 2.f, 0.f), glm::vec3(0.f, 1.f, 0.f));
+		REQUIRE(DebugDrawer::GetPoints().empty());
+		DebugDrawer::SetEnabled(true);
+	}
+}
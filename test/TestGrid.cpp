@@ -1,5 +1,6 @@
 #include <iostream>
 #include <cmath>
+#include <set>
 #include "catch.hpp"
 #include "../src/Systems/Physics/Grid.hpp"
 #include "../src/Systems/Physics/ColliderBuilder.hpp"
@@ -87,11 +88,14 @@ TEST_CASE("Grid Test")
 		REQUIRE(dynamicColliders1.size() == 1);
 		REQUIRE(staticColliders1.size() == 1);
 
+		// collider2 is wider than a cell, it goes one level up
 		Cell& cell2 = grid.cells[1][0];
 		const std::vector<std::shared_ptr<Collider>> dynamicColliders2 = cell2.GetDynamicColliders();
 		const std::vector<std::shared_ptr<Collider>> staticColliders2 = cell2.GetStaticColliders();
 		REQUIRE(dynamicColliders2.size() == 0);
-		REQUIRE(staticColliders2.size() == 1);
+		REQUIRE(staticColliders2.size() == 0);
+		REQUIRE(collider2->level == 1);
+		REQUIRE(grid.GetCells(1)[0][0].GetStaticColliders().size() == 1);
 
 		Cell& cell3 = grid.cells[0][1];
 		const std::vector<std::shared_ptr<Collider>> dynamicColliders3 = cell3.GetDynamicColliders();
@@ -129,4 +133,173 @@ TEST_CASE("Grid Test")
 		std::vector<std::pair<int, int>> eligibleCells3 = grid.GetEligibleCells(19, 0);
 		REQUIRE(eligibleCells3.size() == 4);
 	}
-}
\ No newline at end of file
+
+	SECTION("Test layer filtering")
+	{
+		int unfiltered = grid.CheckCollisions().size();
+		REQUIRE(grid.GetCollisionStats().pairsFiltered == 0);
+
+		// projectiles ignore each other
+		collider4->layer = CollisionLayer::Projectile;
+		collider4->mask = CollisionLayer::All & ~CollisionLayer::Projectile;
+		collider5->layer = CollisionLayer::Projectile;
+		collider5->mask = CollisionLayer::All & ~CollisionLayer::Projectile;
+		// props only collide with the player
+		collider3->layer = CollisionLayer::Prop;
+		collider3->mask = CollisionLayer::Player;
+
+		grid.ResetCollisionStats();
+		int filtered = grid.CheckCollisions().size();
+		REQUIRE(filtered == unfiltered - 2);
+		REQUIRE(grid.GetCollisionStats().pairsFiltered >= 2);
+
+		collider1->layer = CollisionLayer::Player;
+		REQUIRE(grid.CheckCollisions().size() == filtered + 1);
+	}
+
+	SECTION("Test sensors")
+	{
+		int unfiltered = grid.CheckCollisions().size();
+		REQUIRE(grid.GetSensorOverlaps().size() == 0);
+
+		// 1 overlaps 3, the pair is reported as an overlap only
+		collider1->isSensor = true;
+		REQUIRE(grid.CheckCollisions().size() == unfiltered - 1);
+		REQUIRE(grid.GetSensorOverlaps().size() == 1);
+		REQUIRE(grid.GetCollisionStats().pairsSensor == 1);
+	}
+}
+TEST_CASE("Grid Test - scene queries")
+{
+	Grid grid(200.f, 5.f);
+
+	// three unit boxes in a row along x, at x = 10, 20 and 30
+	std::vector<std::shared_ptr<Collider>> colliders;
+	for (int k = 0; k < 3; k++)
+	{
+		std::vector<glm::vec3> points;
+		for (int i = 0; i < 8; i++)
+			points.push_back(glm::vec3(10.f * (k + 1) + (i & 1 ? 1.f : -1.f), i & 2 ? 2.f : 0.f, 50.f + (i & 4 ? 1.f : -1.f)));
+		std::shared_ptr<Collider> collider = ColliderBuilder::Build(k + 1, k == 1 ? DynamicType::Dynamic : DynamicType::Static, points);
+		grid.Insert(collider);
+		colliders.push_back(collider);
+	}
+
+	std::vector<QueryHit> hits;
+	glm::vec3 direction = glm::vec3(1.f, 0.f, 0.f);
+	SECTION("raycast hits are sorted")
+	{
+		REQUIRE(grid.Raycast(glm::vec3(0.f, 1.f, 50.f), direction, 100.f, hits) == 3);
+		REQUIRE(hits[0].entityID == 1);
+		REQUIRE(hits[1].entityID == 2);
+		REQUIRE(hits[2].entityID == 3);
+		REQUIRE(std::abs(hits[0].distance - 9.f) < 0.005f);
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(-1.f, 0.f, 0.f), hits[0].normal, 0.005f)));
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(9.f, 1.f, 50.f), hits[0].point, 0.005f)));
+
+		REQUIRE(grid.Raycast(glm::vec3(0.f, 1.f, 50.f), direction, 15.f, hits) == 1);
+		REQUIRE(grid.Raycast(glm::vec3(0.f, 3.f, 50.f), direction, 100.f, hits) == 0);
+	}
+	SECTION("sphere cast")
+	{
+		// passes over the boxes, but the sphere reaches down to them
+		REQUIRE(grid.SphereCast(glm::vec3(0.f, 2.5f, 50.f), direction, 0.75f, 100.f, hits) == 3);
+		REQUIRE(hits[0].entityID == 1);
+		// first touch on the top front edge of the first box
+		float reach = std::sqrt(0.75f * 0.75f - 0.5f * 0.5f);
+		REQUIRE(std::abs(hits[0].distance - (9.f - reach)) < 0.02f);
+		REQUIRE(glm::all(glm::epsilonEqual(glm::vec3(9.f, 2.f, 50.f), hits[0].point, 0.02f)));
+		REQUIRE(glm::all(glm::epsilonEqual(glm::normalize(glm::vec3(-reach, 0.5f, 0.f)), hits[0].normal, 0.02f)));
+		REQUIRE(grid.SphereCast(glm::vec3(0.f, 2.5f, 50.f), direction, 0.25f, 100.f, hits) == 0);
+	}
+	SECTION("overlap box")
+	{
+		glm::quat rotation = glm::angleAxis(0.78f, glm::vec3(0.f, 1.f, 0.f));
+		REQUIRE(grid.OverlapBox(glm::vec3(15.f, 1.f, 50.f), glm::vec3(4.5f, 0.5f, 0.5f), glm::quat(1.f, 0.f, 0.f, 0.f), hits) == 2);
+		REQUIRE(grid.OverlapBox(glm::vec3(15.f, 1.f, 50.f), glm::vec3(3.f, 0.5f, 0.5f), rotation, hits) == 0);
+	}
+	SECTION("batch")
+	{
+		std::vector<CastQuery> queries;
+		for (int i = 0; i < 1000; i++)
+		{
+			CastQuery query;
+			query.origin = glm::vec3(0.f, 0.001f * i, 50.f);
+			query.direction = direction;
+			query.maxDistance = i % 2 == 0 ? 100.f : 5.f;
+			query.radius = i % 3 == 0 ? 0.1f : 0.f;
+			queries.push_back(query);
+		}
+		std::vector<QueryHit> results;
+		grid.CastBatch(queries, results, 4);
+		REQUIRE(results.size() == queries.size());
+		for (int i = 0; i < results.size(); i++)
+		{
+			if (i % 2 == 0)
+			{
+				REQUIRE(results[i].collider == colliders[0].get());
+				REQUIRE(results[i].distance < 9.f + 0.005f);
+			}
+			else
+				REQUIRE(results[i].collider == nullptr);
+		}
+	}
+}
+
+TEST_CASE("Hierarchical grid")
+{
+	Grid grid(70.f, 5.f);
+	// cells of 10, 20, 40 and 80
+	REQUIRE(grid.GetLevelCount() == 4);
+	REQUIRE(grid.GetCells(1).size() == 4);
+	REQUIRE(grid.GetCells(3).size() == 1);
+	REQUIRE(grid.GetLevel(glm::vec3(0.f), glm::vec3(10.f)) == 0);
+	REQUIRE(grid.GetLevel(glm::vec3(0.f), glm::vec3(10.5f, 50.f, 1.f)) == 1);
+	REQUIRE(grid.GetLevel(glm::vec3(0.f), glm::vec3(30.f)) == 2);
+	REQUIRE(grid.GetLevel(glm::vec3(0.f), glm::vec3(500.f)) == 3);
+
+	// a 30 unit building, small props touching it far from its center
+	std::shared_ptr<Collider> building = ColliderBuilder::BuildBox(1, DynamicType::Static, glm::vec3(10.f, 0.f, 10.f), glm::vec3(40.f, 20.f, 40.f));
+	std::shared_ptr<Collider> prop1 = ColliderBuilder::BuildBox(2, DynamicType::Dynamic, glm::vec3(39.5f, 1.f, 12.f), glm::vec3(40.5f, 2.f, 13.f));
+	std::shared_ptr<Collider> prop2 = ColliderBuilder::BuildBox(3, DynamicType::Dynamic, glm::vec3(11.f, 19.5f, 39.f), glm::vec3(12.f, 20.5f, 40.5f));
+	// a wall one level below the building, against prop1 and the building
+	std::shared_ptr<Collider> wall = ColliderBuilder::BuildBox(4, DynamicType::Dynamic, glm::vec3(39.8f, 0.f, 5.f), glm::vec3(42.f, 9.f, 20.f));
+	// far away, only a candidate of the building whose coarse cell is next to its own
+	std::shared_ptr<Collider> prop3 = ColliderBuilder::BuildBox(5, DynamicType::Dynamic, glm::vec3(65.f, 0.f, 65.f), glm::vec3(66.f, 1.f, 66.f));
+	grid.Insert(building);
+	grid.Insert(prop1);
+	grid.Insert(prop2);
+	grid.Insert(wall);
+	grid.Insert(prop3);
+	REQUIRE(building->level == 2);
+	REQUIRE(wall->level == 1);
+	REQUIRE(prop1->level == 0);
+
+	const std::vector<Collision>& collisions = grid.CheckCollisions();
+	std::set<std::pair<int, int>> pairs;
+	for (int i = 0; i < collisions.size(); i++)
+		pairs.insert(std::make_pair(std::min(collisions[i].first, collisions[i].second), std::max(collisions[i].first, collisions[i].second)));
+	REQUIRE(pairs.count(std::make_pair(1, 2)) == 1);
+	REQUIRE(pairs.count(std::make_pair(1, 3)) == 1);
+	REQUIRE(pairs.count(std::make_pair(1, 4)) == 1);
+	REQUIRE(pairs.count(std::make_pair(2, 4)) == 1);
+	REQUIRE(pairs.size() == 4);
+	// no pair is tested twice, and only pairs with overlapping bounds reach the narrowphase
+	REQUIRE(grid.GetCollisionStats().pairsTested == 4);
+
+	SECTION("Colliders change level when their bounds change")
+	{
+		grid.Remove(wall);
+		REQUIRE(grid.GetCells(1)[0][2].GetDynamicColliders().empty());
+		grid.Insert(wall);
+		// turned, the wall is 15 units wide on x as well
+		wall->Update(wall->center, glm::angleAxis(glm::radians(45.f), glm::vec3(0.f, 1.f, 0.f)));
+		grid.Update(wall);
+		REQUIRE(wall->level == 1);
+		wall->Update(glm::vec3(15.f, 5.f, 60.f), glm::angleAxis(glm::radians(90.f), glm::vec3(1.f, 0.f, 0.f)));
+		grid.Update(wall);
+		// standing up it is only 9 wide
+		REQUIRE(wall->level == 0);
+		REQUIRE(grid.GetCells(0)[6][1].GetDynamicColliders().size() == 1);
+	}
+}
@@ -0,0 +1,133 @@
+#include <vector>
+#include <cmath>
+#include "catch.hpp"
+#include "../src/Systems/Physics/Grid.hpp"
+#include "../src/Systems/Physics/Heightfield.hpp"
+#include "../src/Systems/Physics/ColliderBuilder.hpp"
+#include "../src/Systems/Physics/CollisionDetector.hpp"
+
+TEST_CASE("Heightfield Test")
+{
+	// 11 x 11 samples, 1 unit apart, a slope rising along x: height = 0.5 * x
+	std::vector<float> heights;
+	for (int row = 0; row < 11; row++)
+	{
+		for (int col = 0; col < 11; col++)
+			heights.push_back(0.5f * col);
+	}
+	Heightfield heightfield(7, glm::vec3(10.f, 0.f, 10.f), 11, 11, 1.f, heights);
+	REQUIRE(heightfield.GetCollider()->entityID == 7);
+	REQUIRE(heightfield.aabbMax.x == 20.f);
+	REQUIRE(heightfield.aabbMax.y == 5.f);
+
+	SECTION("surface")
+	{
+		float height;
+		glm::vec3 normal;
+		REQUIRE(heightfield.GetSurface(12.25f, 13.75f, height, normal));
+		REQUIRE(std::abs(height - 1.125f) < 0.001f);
+		REQUIRE(glm::all(glm::epsilonEqual(glm::normalize(glm::vec3(-0.5f, 1.f, 0.f)), normal, 0.001f)));
+		REQUIRE(!heightfield.GetSurface(9.f, 15.f, height, normal));
+
+		int minRow, maxRow, minCol, maxCol;
+		REQUIRE(heightfield.GetCellRange(glm::vec3(12.5f, 0.f, 13.5f), glm::vec3(13.5f, 3.f, 14.5f), minRow, maxRow, minCol, maxCol));
+		REQUIRE(minCol == 2);
+		REQUIRE(maxCol == 3);
+		REQUIRE(minRow == 3);
+		REQUIRE(maxRow == 4);
+		REQUIRE(!heightfield.GetCellRange(glm::vec3(0.f), glm::vec3(5.f), minRow, maxRow, minCol, maxCol));
+	}
+
+	SECTION("built from a terrain mesh")
+	{
+		// triangle soup of the same slope, every inner vertex is repeated
+		std::vector<glm::vec3> points;
+		for (int row = 0; row < 10; row++)
+		{
+			for (int col = 0; col < 10; col++)
+			{
+				glm::vec3 corner(10.f + col, 0.5f * col, 10.f + row);
+				points.push_back(corner);
+				points.push_back(corner + glm::vec3(1.f, 0.5f, 0.f));
+				points.push_back(corner + glm::vec3(1.f, 0.5f, 1.f));
+				points.push_back(corner);
+				points.push_back(corner + glm::vec3(1.f, 0.5f, 1.f));
+				points.push_back(corner + glm::vec3(0.f, 0.f, 1.f));
+			}
+		}
+		std::shared_ptr<Heightfield> built = ColliderBuilder::BuildHeightfield(3, points);
+		REQUIRE(built != nullptr);
+		REQUIRE(built->GetRows() == 11);
+		REQUIRE(built->GetCols() == 11);
+		REQUIRE(std::abs(built->GetHeight(4, 6) - 3.f) < 0.001f);
+
+		// a missing vertex is not a heightfield
+		points.push_back(glm::vec3(25.f, 0.f, 10.f));
+		REQUIRE(ColliderBuilder::BuildHeightfield(3, points) == nullptr);
+	}
+
+	SECTION("box on the slope")
+	{
+		// unit box around (15, y, 15), the terrain is at 2.25 under its low corners and 2.75 under the high ones
+		std::vector<glm::vec3> boxPoints;
+		for (int i = 0; i < 8; i++)
+			boxPoints.push_back(glm::vec3(i & 1 ? 15.5f : 14.5f, i & 2 ? 3.f : 2.f, i & 4 ? 15.5f : 14.5f));
+		std::shared_ptr<Collider> box = ColliderBuilder::Build(1, DynamicType::Dynamic, boxPoints);
+
+		CollisionDetector detector;
+		ContactArena arena;
+		const Collision* collision = detector.CollideHeightfield(box, heightfield, arena);
+		REQUIRE(collision != nullptr);
+		REQUIRE(collision->first == 1);
+		REQUIRE(collision->second == 7);
+		// the four bottom corners plus the terrain sample at (15, 2.5, 15) inside the box
+		REQUIRE(collision->contactCount == 5);
+		for (int i = 0; i < collision->contactCount; i++)
+		{
+			REQUIRE(arena.GetContacts(*collision)[i].contactNormal.y > 0.8f);
+			REQUIRE(arena.GetContacts(*collision)[i].penetration > 0.f);
+		}
+		REQUIRE(detector.GetStats().pairsHeightfield == 1);
+
+		// lifted clear of the terrain
+		box->Update(box->center + glm::vec3(0.f, 1.f, 0.f), glm::quat(1.f, 0.f, 0.f, 0.f));
+		REQUIRE(detector.CollideHeightfield(box, heightfield, arena) == nullptr);
+	}
+
+	SECTION("grid")
+	{
+		Grid grid(200.f, 5.f);
+		grid.Insert(std::make_shared<Heightfield>(heightfield));
+
+		std::vector<glm::vec3> boxPoints;
+		for (int i = 0; i < 8; i++)
+			boxPoints.push_back(glm::vec3(i & 1 ? 12.5f : 11.5f, i & 2 ? 1.5f : 0.5f, i & 4 ? 12.5f : 11.5f));
+		std::shared_ptr<Collider> box = ColliderBuilder::Build(1, DynamicType::Dynamic, boxPoints);
+		grid.Insert(box);
+		REQUIRE(grid.CheckCollisions().size() == 1);
+
+		box->layer = CollisionLayer::Prop;
+		box->mask = CollisionLayer::Player;
+		REQUIRE(grid.CheckCollisions().size() == 0);
+	}
+
+	SECTION("sweep")
+	{
+		Grid grid(200.f, 5.f);
+		grid.Insert(std::make_shared<Heightfield>(heightfield));
+
+		// dropped through the slope in one step, the lower corner at x = 15.25 meets the terrain
+		// at y = 2.625 once the center is down at 2.875, 7.125 units out of 15
+		glm::quat identity(1.f, 0.f, 0.f, 0.f);
+		std::shared_ptr<Collider> bullet = ColliderBuilder::BuildBox(1, DynamicType::Dynamic, glm::vec3(14.75f, 9.75f, 14.75f), glm::vec3(15.25f, 10.25f, 15.25f));
+		bullet->Attach(bullet->center, identity);
+		float toi = grid.Sweep(bullet, glm::vec3(15.f, 10.f, 15.f), identity, glm::vec3(15.f, -5.f, 15.f), identity);
+		REQUIRE(std::abs(toi - 0.475f) < 0.01f);
+		// above the top of the slope
+		REQUIRE(grid.Sweep(bullet, glm::vec3(11.f, 6.f, 15.f), identity, glm::vec3(19.f, 6.f, 15.f), identity) == 1.f);
+
+		bullet->layer = CollisionLayer::Prop;
+		bullet->mask = CollisionLayer::Player;
+		REQUIRE(grid.Sweep(bullet, glm::vec3(15.f, 10.f, 15.f), identity, glm::vec3(15.f, -5.f, 15.f), identity) == 1.f);
+	}
+}
@@ -0,0 +1,71 @@
+#include "catch.hpp"
+#include <cstdio>
+#include <fstream>
+#include "../src/Systems/Physics/ColliderBuilder.hpp"
+#include "../src/Systems/Physics/HullCache.hpp"
+
+TEST_CASE("Hull cache")
+{
+	std::string filename = "test_hull_cache.hulls";
+	std::remove(filename.c_str());
+
+	std::vector<glm::vec3> points;
+	points.push_back(glm::vec3(0.f, 0.f, 0.f));
+	points.push_back(glm::vec3(2.f, 0.f, 0.f));
+	points.push_back(glm::vec3(0.f, 1.f, 0.f));
+	points.push_back(glm::vec3(2.f, 2.f, 0.f));
+	points.push_back(glm::vec3(0.f, 0.f, 0.7f));
+	points.push_back(glm::vec3(2.f, 0.f, 2.f));
+	points.push_back(glm::vec3(2.f, 2.f, 2.f));
+	points.push_back(glm::vec3(0.f, 1.f, 1.f));
+
+	HullCache cache(filename);
+	REQUIRE(cache.Load() == false);
+	std::shared_ptr<Collider> built = ColliderBuilder::Build(1, DynamicType::Static, points, cache);
+	REQUIRE(cache.Size() == 1);
+	REQUIRE(cache.Save() == true);
+
+	SECTION("Hulls are read back unchanged")
+	{
+		HullCache loaded(filename);
+		REQUIRE(loaded.Load() == true);
+		REQUIRE(loaded.Size() == 1);
+		std::shared_ptr<const Hull> hull = loaded.Find(HullCache::Hash(points));
+		REQUIRE(hull != nullptr);
+		std::shared_ptr<const Hull> expected = built->GetHull();
+		REQUIRE(hull->points.size() == expected->points.size());
+		REQUIRE(hull->edges == expected->edges);
+		REQUIRE(hull->edgeFaces == expected->edgeFaces);
+		REQUIRE(hull->faces.size() == expected->faces.size());
+		for (int i = 0; i < hull->faces.size(); i++)
+		{
+			REQUIRE(hull->faces[i].points == expected->faces[i].points);
+			REQUIRE(hull->faces[i].normal == expected->faces[i].normal);
+		}
+		REQUIRE(hull->radius == expected->radius);
+
+		// a cached build gives the same collider and shares the hull
+		std::shared_ptr<Collider> cached = ColliderBuilder::Build(2, DynamicType::Static, points, loaded);
+		REQUIRE(cached->GetHull() == hull);
+		REQUIRE(cached->center == built->center);
+	}
+	SECTION("Different points have a different key")
+	{
+		std::vector<glm::vec3> moved = points;
+		moved[3].x += 0.001f;
+		REQUIRE(HullCache::Hash(moved) != HullCache::Hash(points));
+		REQUIRE(cache.Find(HullCache::Hash(moved)) == nullptr);
+	}
+	SECTION("Corrupted file is rejected")
+	{
+		std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+		file.seekp(40);
+		file.put(0x7f);
+		file.close();
+
+		HullCache loaded(filename);
+		REQUIRE(loaded.Load() == false);
+		REQUIRE(loaded.Size() == 0);
+	}
+	std::remove(filename.c_str());
+}
@@ -0,0 +1,100 @@
+#include "catch.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/Log.hpp"
+
+static int Evaluate(int& counter)
+{
+	return ++counter;
+}
+
+static std::vector<std::string> ReadLines(std::FILE* file)
+{
+	std::vector<std::string> lines;
+	std::rewind(file);
+	char line[512];
+	while (std::fgets(line, sizeof(line), file))
+		lines.push_back(line);
+	return lines;
+}
+
+TEST_CASE("Log")
+{
+	std::FILE* file = std::tmpfile();
+	REQUIRE(file != nullptr);
+	Log::Flush();
+
+	SECTION("Records are written by the background thread")
+	{
+		Log::Start(file);
+		LOG_INFO(Physics, "body %d at %.1f", 3, 2.5f);
+		LOG_ERROR(Rendering, "failed");
+		Log::Stop();
+
+		std::vector<std::string> lines = ReadLines(file);
+		REQUIRE(lines.size() == 2);
+		REQUIRE(lines[0].find("INFO") != std::string::npos);
+		REQUIRE(lines[0].find("physics") != std::string::npos);
+		REQUIRE(lines[0].find("body 3 at 2.5") != std::string::npos);
+		REQUIRE(lines[1].find("rendering") != std::string::npos);
+	}
+
+	SECTION("Compiled out calls do not evaluate their arguments")
+	{
+		int counter = 0;
+		LOG(LogTrace, Physics, "%d", Evaluate(counter));
+		REQUIRE(LogEnabled<LogTrace, LogCategory::Physics>::value == (LOG_LEVEL <= 0));
+		REQUIRE(counter == (LOG_LEVEL <= 0 ? 1 : 0));
+	}
+
+	SECTION("Runtime level filters records")
+	{
+		Log::SetLevel(LogError);
+		Log::Start(file);
+		LOG_WARNING(General, "skipped");
+		LOG_ERROR(General, "kept");
+		Log::Stop();
+		Log::SetLevel((LogLevel)LOG_LEVEL);
+
+		std::vector<std::string> lines = ReadLines(file);
+		REQUIRE(lines.size() == 1);
+		REQUIRE(lines[0].find("kept") != std::string::npos);
+	}
+
+	SECTION("A full ring drops records instead of blocking")
+	{
+		std::uint64_t dropped = Log::GetDropped();
+		for (int i = 0; i < Log::capacity + 10; i++)
+			LOG_WARNING(General, "record %d", i);
+		REQUIRE(Log::GetDropped() == dropped + 10);
+		Log::Start(file);
+		Log::Stop();
+		REQUIRE(ReadLines(file).size() == Log::capacity);
+	}
+
+	SECTION("Concurrent writers")
+	{
+		std::uint64_t dropped = Log::GetDropped();
+		Log::Start(file);
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; t++)
+		{
+			threads.push_back(std::thread([t]()
+			{
+				for (int i = 0; i < 100; i++)
+					LOG_INFO(General, "thread %d record %d", t, i);
+			}));
+		}
+		for (int t = 0; t < 4; t++)
+			threads[t].join();
+		Log::Stop();
+
+		std::uint64_t lines = ReadLines(file).size();
+		REQUIRE(lines + Log::GetDropped() - dropped == 400);
+	}
+
+	std::fclose(file);
+}
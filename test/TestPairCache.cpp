@@ -0,0 +1,105 @@
+#include "catch.hpp"
+#include "../src/Systems/Physics/Grid.hpp"
+#include "../src/Systems/Physics/PairCache.hpp"
+#include "../src/Systems/Physics/ColliderBuilder.hpp"
+
+TEST_CASE("Pair cache")
+{
+	std::shared_ptr<Collider> a = ColliderBuilder::BuildBox(1, DynamicType::Dynamic, glm::vec3(0.f), glm::vec3(1.f));
+	std::shared_ptr<Collider> b = ColliderBuilder::BuildBox(2, DynamicType::Dynamic, glm::vec3(0.5f), glm::vec3(1.5f));
+	std::shared_ptr<Collider> c = ColliderBuilder::BuildBox(3, DynamicType::Dynamic, glm::vec3(0.5f), glm::vec3(1.5f));
+	REQUIRE(a->id != b->id);
+	REQUIRE(PairCache::Key(*a, *b) == PairCache::Key(*b, *a));
+	REQUIRE(PairCache::Key(*a, *b) != PairCache::Key(*a, *c));
+
+	PairCache cache;
+	cache.BeginFrame();
+	cache.Report(a, b);
+	cache.Report(b, a);
+	cache.Report(a, c);
+	cache.EndFrame();
+	REQUIRE(cache.GetPairs().size() == 2);
+	REQUIRE(cache.GetEvents().size() == 2);
+	REQUIRE(cache.GetEvents()[0].type == PairEvent::Added);
+	REQUIRE(cache.Find(*b, *a) != nullptr);
+	REQUIRE(cache.Find(*b, *a)->age == 0);
+	REQUIRE(cache.Find(*b, *c) == nullptr);
+
+	SECTION("Pairs reported again persist without events")
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			cache.BeginFrame();
+			cache.Report(b, a);
+			cache.Report(a, c);
+			cache.EndFrame();
+			REQUIRE(cache.GetEvents().size() == 0);
+		}
+		REQUIRE(cache.Find(*a, *b)->age == 3);
+		// the order of the first report is kept
+		REQUIRE(cache.Find(*a, *b)->first == a);
+	}
+
+	SECTION("Pairs not reported are removed")
+	{
+		cache.BeginFrame();
+		cache.Report(a, c);
+		cache.EndFrame();
+		REQUIRE(cache.GetPairs().size() == 1);
+		REQUIRE(cache.GetEvents().size() == 1);
+		REQUIRE(cache.GetEvents()[0].type == PairEvent::Removed);
+		REQUIRE(cache.GetEvents()[0].first == a);
+		REQUIRE(cache.GetEvents()[0].second == b);
+		REQUIRE(cache.Find(*a, *b) == nullptr);
+		// the moved pair is still found
+		REQUIRE(cache.Find(*a, *c) != nullptr);
+		REQUIRE(cache.Find(*a, *c)->second == c);
+	}
+}
+
+TEST_CASE("Pair cache - grid events")
+{
+	Grid grid(100.f, 5.f);
+	std::shared_ptr<Collider> ground = ColliderBuilder::BuildBox(1, DynamicType::Static, glm::vec3(20.f, 0.f, 20.f), glm::vec3(24.f, 1.f, 24.f));
+	std::shared_ptr<Collider> box = ColliderBuilder::BuildBox(2, DynamicType::Dynamic, glm::vec3(21.f, 0.5f, 21.f), glm::vec3(22.f, 1.5f, 22.f));
+	glm::quat orientation(1.f, 0.f, 0.f, 0.f);
+	box->Attach(box->center, orientation);
+	grid.Insert(ground);
+	grid.Insert(box);
+
+	// the boxes start overlapping
+	REQUIRE(grid.CheckCollisions().size() == 1);
+	REQUIRE(grid.GetPairCache().GetPairs().size() == 1);
+	REQUIRE(grid.GetPairCache().GetEvents().size() == 1);
+	REQUIRE(grid.GetPairCache().GetEvents()[0].type == PairEvent::Added);
+	REQUIRE(grid.GetPairCache().GetPairs()[0].collision != -1);
+
+	// resting, the pair stays without events
+	for (int i = 0; i < 5; i++)
+	{
+		REQUIRE(grid.CheckCollisions().size() == 1);
+		REQUIRE(grid.GetPairCache().GetEvents().size() == 0);
+	}
+	REQUIRE(grid.GetPairCache().Find(*ground, *box)->age == 5);
+
+	// turned and moved past the corner, the bounds still overlap without contact
+	glm::quat turned = glm::angleAxis(glm::radians(45.f), glm::vec3(0.f, 1.f, 0.f));
+	box->Update(glm::vec3(24.6f, 0.5f, 24.6f), turned);
+	grid.Update(box);
+	REQUIRE(grid.CheckCollisions().size() == 0);
+	REQUIRE(grid.GetPairCache().GetEvents().size() == 0);
+	REQUIRE(grid.GetPairCache().GetPairs().size() == 1);
+	REQUIRE(grid.GetPairCache().GetPairs()[0].collision == -1);
+
+	// lifted off, the pair is removed
+	box->Update(glm::vec3(21.5f, 5.f, 21.5f), orientation);
+	grid.Update(box);
+	REQUIRE(grid.CheckCollisions().size() == 0);
+	REQUIRE(grid.GetPairCache().GetPairs().size() == 0);
+	REQUIRE(grid.GetPairCache().GetEvents().size() == 1);
+	REQUIRE(grid.GetPairCache().GetEvents()[0].type == PairEvent::Removed);
+	REQUIRE((grid.GetPairCache().GetEvents()[0].first == box || grid.GetPairCache().GetEvents()[0].second == box));
+
+	grid.CheckCollisions();
+	REQUIRE(grid.GetPairCache().GetEvents().size() == 0);
+}
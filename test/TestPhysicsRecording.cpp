@@ -0,0 +1,117 @@
+#include "catch.hpp"
+#include <cstdio>
+#include <fstream>
+#include "../src/Systems/Physics/PhysicsRecording.hpp"
+#include "../src/Systems/Physics/ColliderBuilder.hpp"
+#include "../src/Components/TransformComponent.hpp"
+#include "../src/Systems/Messaging/MoveData.hpp"
+
+static void AddBody(std::vector<std::unique_ptr<Entity>>& entities, PhysicsSystem& physicsSystem, int id, std::shared_ptr<Collider> collider, DynamicType type, glm::vec3 velocity)
+{
+	glm::quat orientation(1.f, 0.f, 0.f, 0.f);
+	std::unique_ptr<PhysicsComponent> component = std::make_unique<PhysicsComponent>(2.f, collider->center, orientation, glm::mat3(1.f), type);
+	component->velocity = velocity;
+	component->colliders.push_back(collider);
+	collider->Attach(collider->center, orientation);
+	physicsSystem.Insert(component->colliders);
+	std::unique_ptr<Entity> entity = std::make_unique<Entity>(id);
+	entity->AddComponent(std::move(component));
+	entity->AddComponent(std::make_unique<TransformComponent>(collider->center, orientation));
+	entities.push_back(std::move(entity));
+}
+
+TEST_CASE("Physics recording")
+{
+	std::string filename = "test_physics_recording.rec";
+	PhysicsSystem physicsSystem(100.f, 10.f);
+	std::vector<std::unique_ptr<Entity>> entities;
+
+	AddBody(entities, physicsSystem, 1, ColliderBuilder::BuildBox(1, DynamicType::Static, glm::vec3(20.f, 0.f, 20.f), glm::vec3(30.f, 1.f, 30.f)), DynamicType::Static, glm::vec3(0.f));
+	AddBody(entities, physicsSystem, 2, ColliderBuilder::BuildBox(2, DynamicType::Dynamic, glm::vec3(24.f, 2.f, 24.f), glm::vec3(25.f, 3.f, 25.f)), DynamicType::Dynamic, glm::vec3(0.3f, -4.f, 0.1f));
+	std::vector<std::shared_ptr<Collider>> parts;
+	parts.push_back(ColliderBuilder::BuildBox(3, DynamicType::Dynamic, glm::vec3(27.f, 2.f, 27.f), glm::vec3(28.f, 3.f, 28.f)));
+	parts.push_back(ColliderBuilder::BuildBox(3, DynamicType::Dynamic, glm::vec3(28.f, 2.f, 27.f), glm::vec3(29.f, 2.5f, 28.f)));
+	AddBody(entities, physicsSystem, 3, ColliderBuilder::BuildCompound(3, DynamicType::Dynamic, parts), DynamicType::WithPhysics, glm::vec3(0.f, -3.f, 0.f));
+	AddBody(entities, physicsSystem, 4, ColliderBuilder::BuildBox(4, DynamicType::Dynamic, glm::vec3(52.f, 2.f, 52.f), glm::vec3(53.f, 3.f, 53.f)), DynamicType::WithPhysics, glm::vec3(0.f, -5.f, 0.f));
+	AddBody(entities, physicsSystem, 5, ColliderBuilder::BuildBox(5, DynamicType::Dynamic, glm::vec3(72.f, 2.f, 72.f), glm::vec3(73.f, 3.f, 73.f)), DynamicType::WithPhysics, glm::vec3(0.f, -5.f, 0.f));
+
+	// terrain under body 4, a mesh under body 5
+	std::vector<float> heights;
+	for (int r = 0; r < 5; r++)
+		for (int c = 0; c < 5; c++)
+			heights.push_back(0.3f * r + 0.1f * c);
+	physicsSystem.Insert(std::make_shared<Heightfield>(6, glm::vec3(50.f, 0.f, 50.f), 5, 5, 1.f, heights));
+	std::vector<glm::vec3> vertices{glm::vec3(70.f, 0.f, 70.f), glm::vec3(76.f, 0.f, 70.f), glm::vec3(70.f, 1.f, 76.f), glm::vec3(76.f, 1.f, 76.f)};
+	std::vector<int> indices{0, 2, 1, 1, 2, 3};
+	physicsSystem.Insert(std::make_shared<TriangleMesh>(7, vertices, indices));
+
+	PhysicsRecorder recorder;
+	REQUIRE(recorder.Open(filename, entities, physicsSystem));
+	std::vector<std::uint64_t> recorded;
+	std::vector<Message> globalQueue;
+	for (int tick = 0; tick < 60; tick++)
+	{
+		std::vector<Message> messages;
+		if (tick % 7 == 3)
+		{
+			Message message(2, 0, MessageType::Move);
+			message.data = std::make_shared<MoveData>(false, false, tick % 2 == 0, tick % 2 == 1);
+			messages.push_back(message);
+		}
+		physicsSystem.Update(1.f / 60.f, entities, messages, globalQueue);
+		globalQueue.clear();
+		recorder.WriteTick(1.f / 60.f, messages, entities);
+		recorded.push_back(PhysicsRecorder::HashState(entities));
+	}
+	recorder.Close();
+	// every kind of shape took part
+	REQUIRE(physicsSystem.GetCollisionStats().pairsHeightfield > 0);
+	REQUIRE(physicsSystem.GetCollisionStats().pairsMesh > 0);
+
+	SECTION("Replay reproduces every recorded state")
+	{
+		PhysicsReplay replay;
+		REQUIRE(replay.Load(filename));
+		REQUIRE(replay.GetTicks().size() == 60);
+		REQUIRE(replay.GetTicks()[3].messages.size() == 1);
+
+		std::vector<double> times;
+		std::vector<std::uint64_t> hashes;
+		REQUIRE(replay.Run(times, hashes) == -1);
+		REQUIRE(times.size() == 60);
+		REQUIRE(hashes == recorded);
+		// the scene moved, so the hashes are not trivially equal
+		REQUIRE(hashes.front() != hashes.back());
+
+		// and a second run gives the same states again
+		std::vector<std::uint64_t> again;
+		REQUIRE(replay.Run(times, again) == -1);
+		REQUIRE(again == hashes);
+	}
+
+	SECTION("A truncated recording keeps its complete ticks")
+	{
+		std::ifstream file(filename, std::ios::binary);
+		std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		file.close();
+		std::ofstream truncated(filename, std::ios::binary | std::ios::trunc);
+		truncated.write(data.data(), data.size() - 5);
+		truncated.close();
+
+		PhysicsReplay replay;
+		REQUIRE(replay.Load(filename));
+		REQUIRE(replay.GetTicks().size() == 59);
+	}
+
+	SECTION("Invalid files are rejected")
+	{
+		PhysicsReplay replay;
+		REQUIRE(replay.Load("missing.rec") == false);
+		std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+		file << "not a recording at all";
+		file.close();
+		REQUIRE(replay.Load(filename) == false);
+	}
+
+	std::remove(filename.c_str());
+}
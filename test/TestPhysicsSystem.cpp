@@ -6,6 +6,7 @@
 #include "../src/Systems/Physics/ColliderBuilder.hpp"
 #include "../src/Components/PhysicsComponent.hpp"
 #include "../src/Components/TransformComponent.hpp"
+#include "../src/Systems/Messaging/OverlapData.hpp"
 #include "../src/util.hpp"
 
 TEST_CASE("PhysicsSystem Test")
@@ -88,4 +89,317 @@ TEST_CASE("PhysicsSystem Test")
 	printVector(component->position, "POST UPDATE Position");
 	printVector(component->velocity, "POSTUPDATE VEL");
 
-}
\ No newline at end of file
+}
+TEST_CASE("PhysicsSystem Test - bullets do not tunnel")
+{
+	// thin static wall at x = 10, a small box flying at it fast enough to skip it in one step
+	std::vector<glm::vec3> wallPoints;
+	std::vector<glm::vec3> bulletPoints;
+	for (int i = 0; i < 8; i++)
+	{
+		wallPoints.push_back(glm::vec3(i & 1 ? 10.05f : 9.95f, i & 2 ? 4.f : 0.f, i & 4 ? 14.f : 6.f));
+		bulletPoints.push_back(glm::vec3(i & 1 ? 5.2f : 4.8f, i & 2 ? 2.2f : 1.8f, i & 4 ? 10.2f : 9.8f));
+	}
+
+	glm::quat orientation(1.f, 0.f, 0.f, 0.f);
+	float dt = 0.1f;
+	for (int isBullet = 0; isBullet < 2; isBullet++)
+	{
+		PhysicsSystem physicsSystem(200.f, 10.f);
+		std::shared_ptr<Collider> wall = ColliderBuilder::Build(1, DynamicType::Static, wallPoints);
+		std::shared_ptr<Collider> bullet = ColliderBuilder::Build(2, DynamicType::Dynamic, bulletPoints);
+
+		std::unique_ptr<PhysicsComponent> wallComponent = std::make_unique<PhysicsComponent>(1000.f, wall->center, orientation, glm::mat3(1.f), DynamicType::Static);
+		wallComponent->colliders.push_back(wall);
+		std::unique_ptr<Entity> wallEntity = std::make_unique<Entity>(1);
+		wallEntity->AddComponent(std::move(wallComponent));
+		wallEntity->AddComponent(std::make_unique<TransformComponent>(wall->center, orientation));
+
+		std::unique_ptr<PhysicsComponent> bulletComponent = std::make_unique<PhysicsComponent>(1.f, bullet->center, orientation, glm::mat3(1.f), DynamicType::WithPhysics);
+		bulletComponent->velocity = glm::vec3(80.f, 0.f, 0.f);
+		bulletComponent->isBullet = isBullet == 1;
+		bulletComponent->colliders.push_back(bullet);
+		std::unique_ptr<Entity> bulletEntity = std::make_unique<Entity>(2);
+		bulletEntity->AddComponent(std::move(bulletComponent));
+		bulletEntity->AddComponent(std::make_unique<TransformComponent>(bullet->center, orientation));
+
+		std::vector<std::shared_ptr<Collider>> colliders{wall, bullet};
+		physicsSystem.Insert(colliders);
+		std::vector<std::unique_ptr<Entity>> entities;
+		entities.push_back(std::move(wallEntity));
+		entities.push_back(std::move(bulletEntity));
+		std::vector<Message> messages;
+		std::vector<Message> globalQueue;
+
+		PhysicsComponent* component = entities[1]->GetComponent<PhysicsComponent>(ComponentType::Physics);
+		physicsSystem.Update(dt, entities, messages, globalQueue);
+		if (isBullet == 0)
+		{
+			// 8 units in one step, straight through the wall
+			REQUIRE(component->position.x > 10.05f);
+		}
+		else
+		{
+			// stopped at the wall and bounced back by the solver
+			REQUIRE(component->position.x < 10.f);
+			REQUIRE(component->position.x > 9.5f);
+			REQUIRE(component->velocity.x < 0.f);
+		}
+	}
+}
+
+TEST_CASE("PhysicsSystem Test - bullets slide on the floor")
+{
+	// a box resting on a static floor and sliding along it, the resting contact must not stop the sweep
+	std::vector<glm::vec3> floorPoints;
+	std::vector<glm::vec3> boxPoints;
+	for (int i = 0; i < 8; i++)
+	{
+		floorPoints.push_back(glm::vec3(i & 1 ? 40.f : 0.f, i & 2 ? 1.f : 0.f, i & 4 ? 14.f : 6.f));
+		boxPoints.push_back(glm::vec3(i & 1 ? 5.5f : 4.5f, i & 2 ? 2.f : 1.f, i & 4 ? 10.5f : 9.5f));
+	}
+
+	glm::quat orientation(1.f, 0.f, 0.f, 0.f);
+	float dt = 0.1f;
+	for (int isBullet = 0; isBullet < 2; isBullet++)
+	{
+		PhysicsSystem physicsSystem(200.f, 10.f);
+		std::shared_ptr<Collider> floor = ColliderBuilder::Build(1, DynamicType::Static, floorPoints);
+		std::shared_ptr<Collider> box = ColliderBuilder::Build(2, DynamicType::Dynamic, boxPoints);
+
+		std::unique_ptr<PhysicsComponent> floorComponent = std::make_unique<PhysicsComponent>(1000.f, floor->center, orientation, glm::mat3(1.f), DynamicType::Static);
+		floorComponent->colliders.push_back(floor);
+		std::unique_ptr<Entity> floorEntity = std::make_unique<Entity>(1);
+		floorEntity->AddComponent(std::move(floorComponent));
+		floorEntity->AddComponent(std::make_unique<TransformComponent>(floor->center, orientation));
+
+		std::unique_ptr<PhysicsComponent> boxComponent = std::make_unique<PhysicsComponent>(1.f, box->center, orientation, glm::mat3(1.f), DynamicType::WithPhysics);
+		boxComponent->velocity = glm::vec3(10.f, 0.f, 0.f);
+		boxComponent->isBullet = isBullet == 1;
+		boxComponent->colliders.push_back(box);
+		std::unique_ptr<Entity> boxEntity = std::make_unique<Entity>(2);
+		boxEntity->AddComponent(std::move(boxComponent));
+		boxEntity->AddComponent(std::make_unique<TransformComponent>(box->center, orientation));
+
+		std::vector<std::shared_ptr<Collider>> colliders{floor, box};
+		physicsSystem.Insert(colliders);
+		std::vector<std::unique_ptr<Entity>> entities;
+		entities.push_back(std::move(floorEntity));
+		entities.push_back(std::move(boxEntity));
+		std::vector<Message> messages;
+		std::vector<Message> globalQueue;
+
+		PhysicsComponent* component = entities[1]->GetComponent<PhysicsComponent>(ComponentType::Physics);
+		float startX = component->position.x;
+		for (int step = 0; step < 10; step++)
+			physicsSystem.Update(dt, entities, messages, globalQueue);
+		// 10 units whether the box is swept or not
+		REQUIRE(std::abs(component->position.x - startX - 10.f) < 0.05f);
+	}
+}
+
+TEST_CASE("PhysicsSystem Test - bullets fired into a touching plate")
+{
+	// thin static plate at y = 1, a small box resting on it and fired down fast enough to skip it in one step
+	std::vector<glm::vec3> platePoints;
+	std::vector<glm::vec3> bulletPoints;
+	for (int i = 0; i < 8; i++)
+	{
+		platePoints.push_back(glm::vec3(i & 1 ? 14.f : 6.f, i & 2 ? 1.05f : 0.95f, i & 4 ? 14.f : 6.f));
+		bulletPoints.push_back(glm::vec3(i & 1 ? 10.2f : 9.8f, i & 2 ? 1.45f : 1.05f, i & 4 ? 10.2f : 9.8f));
+	}
+
+	glm::quat orientation(1.f, 0.f, 0.f, 0.f);
+	PhysicsSystem physicsSystem(200.f, 10.f);
+	std::shared_ptr<Collider> plate = ColliderBuilder::Build(1, DynamicType::Static, platePoints);
+	std::shared_ptr<Collider> bullet = ColliderBuilder::Build(2, DynamicType::Dynamic, bulletPoints);
+
+	std::unique_ptr<PhysicsComponent> plateComponent = std::make_unique<PhysicsComponent>(1000.f, plate->center, orientation, glm::mat3(1.f), DynamicType::Static);
+	plateComponent->colliders.push_back(plate);
+	std::unique_ptr<Entity> plateEntity = std::make_unique<Entity>(1);
+	plateEntity->AddComponent(std::move(plateComponent));
+	plateEntity->AddComponent(std::make_unique<TransformComponent>(plate->center, orientation));
+
+	std::unique_ptr<PhysicsComponent> bulletComponent = std::make_unique<PhysicsComponent>(1.f, bullet->center, orientation, glm::mat3(1.f), DynamicType::WithPhysics);
+	bulletComponent->isBullet = true;
+	bulletComponent->colliders.push_back(bullet);
+	std::unique_ptr<Entity> bulletEntity = std::make_unique<Entity>(2);
+	bulletEntity->AddComponent(std::move(bulletComponent));
+	bulletEntity->AddComponent(std::make_unique<TransformComponent>(bullet->center, orientation));
+
+	std::vector<std::shared_ptr<Collider>> colliders{plate, bullet};
+	physicsSystem.Insert(colliders);
+	std::vector<std::unique_ptr<Entity>> entities;
+	entities.push_back(std::move(plateEntity));
+	entities.push_back(std::move(bulletEntity));
+	std::vector<Message> messages;
+	std::vector<Message> globalQueue;
+
+	PhysicsComponent* component = entities[1]->GetComponent<PhysicsComponent>(ComponentType::Physics);
+	// resting first, then fired into the plate - 8 units in one step
+	physicsSystem.Update(0.1f, entities, messages, globalQueue);
+	component->velocity = glm::vec3(0.f, -80.f, 0.f);
+	physicsSystem.Update(0.1f, entities, messages, globalQueue);
+	// stopped on the plate instead of going through it
+	REQUIRE(component->position.y > 0.95f);
+	REQUIRE(component->velocity.y > 0.f);
+}
+
+TEST_CASE("PhysicsSystem Test - bodies added between steps")
+{
+	glm::quat orientation(1.f, 0.f, 0.f, 0.f);
+	PhysicsSystem physicsSystem(200.f, 10.f);
+	std::vector<std::unique_ptr<Entity>> entities;
+	std::vector<Message> messages;
+	std::vector<Message> globalQueue;
+	for (int id = 1; id <= 2; id++)
+	{
+		std::unique_ptr<PhysicsComponent> component = std::make_unique<PhysicsComponent>(1.f, glm::vec3(10.f * id, 10.f, 10.f), orientation, glm::mat3(1.f), DynamicType::Dynamic);
+		component->velocity = glm::vec3(0.f, 0.f, 1.f * id);
+		std::unique_ptr<Entity> entity = std::make_unique<Entity>(id);
+		entity->AddComponent(std::move(component));
+		entity->AddComponent(std::make_unique<TransformComponent>(glm::vec3(10.f * id, 10.f, 10.f), orientation));
+		entities.push_back(std::move(entity));
+		physicsSystem.Update(0.5f, entities, messages, globalQueue);
+	}
+
+	// the first body moved in both steps, the second one only since it was added
+	PhysicsComponent* first = entities[0]->GetComponent<PhysicsComponent>(ComponentType::Physics);
+	PhysicsComponent* second = entities[1]->GetComponent<PhysicsComponent>(ComponentType::Physics);
+	REQUIRE(first->position.z == Approx(11.f));
+	REQUIRE(second->position.z == Approx(11.f));
+	REQUIRE(entities[1]->GetComponent<TransformComponent>(ComponentType::Transform)->position.z == Approx(11.f));
+
+	// gameplay changes are picked up by the next step
+	first->velocity = glm::vec3(0.f, 0.f, 0.f);
+	second->position = glm::vec3(0.f, 0.f, 0.f);
+	physicsSystem.Update(0.5f, entities, messages, globalQueue);
+	REQUIRE(first->position.z == Approx(11.f));
+	REQUIRE(second->position.z == Approx(1.f));
+}
+
+TEST_CASE("PhysicsSystem Test - sensors send overlap messages")
+{
+	// static trigger volume around x = 10, a small box flying through it
+	std::vector<glm::vec3> triggerPoints;
+	std::vector<glm::vec3> bodyPoints;
+	for (int i = 0; i < 8; i++)
+	{
+		triggerPoints.push_back(glm::vec3(i & 1 ? 11.f : 9.f, i & 2 ? 4.f : 0.f, i & 4 ? 14.f : 6.f));
+		bodyPoints.push_back(glm::vec3(i & 1 ? 5.2f : 4.8f, i & 2 ? 2.2f : 1.8f, i & 4 ? 10.2f : 9.8f));
+	}
+
+	glm::quat orientation(1.f, 0.f, 0.f, 0.f);
+	PhysicsSystem physicsSystem(200.f, 10.f);
+	std::shared_ptr<Collider> trigger = ColliderBuilder::Build(1, DynamicType::Static, triggerPoints);
+	trigger->isSensor = true;
+	std::shared_ptr<Collider> body = ColliderBuilder::Build(2, DynamicType::Dynamic, bodyPoints);
+
+	std::unique_ptr<PhysicsComponent> triggerComponent = std::make_unique<PhysicsComponent>(1000.f, trigger->center, orientation, glm::mat3(1.f), DynamicType::Static);
+	triggerComponent->colliders.push_back(trigger);
+	std::unique_ptr<Entity> triggerEntity = std::make_unique<Entity>(1);
+	triggerEntity->AddComponent(std::move(triggerComponent));
+	triggerEntity->AddComponent(std::make_unique<TransformComponent>(trigger->center, orientation));
+
+	std::unique_ptr<PhysicsComponent> bodyComponent = std::make_unique<PhysicsComponent>(1.f, body->center, orientation, glm::mat3(1.f), DynamicType::WithPhysics);
+	bodyComponent->velocity = glm::vec3(20.f, 0.f, 0.f);
+	bodyComponent->colliders.push_back(body);
+	std::unique_ptr<Entity> bodyEntity = std::make_unique<Entity>(2);
+	bodyEntity->AddComponent(std::move(bodyComponent));
+	bodyEntity->AddComponent(std::make_unique<TransformComponent>(body->center, orientation));
+
+	std::vector<std::shared_ptr<Collider>> colliders{trigger, body};
+	physicsSystem.Insert(colliders);
+	std::vector<std::unique_ptr<Entity>> entities;
+	entities.push_back(std::move(triggerEntity));
+	entities.push_back(std::move(bodyEntity));
+	std::vector<Message> messages;
+
+	PhysicsComponent* component = entities[1]->GetComponent<PhysicsComponent>(ComponentType::Physics);
+	std::vector<MessageType> events;
+	std::vector<float> eventPositions;
+	for (int step = 0; step < 6; step++)
+	{
+		std::vector<Message> globalQueue;
+		physicsSystem.Update(0.1f, entities, messages, globalQueue);
+		for (int i = 0; i < globalQueue.size(); i++)
+		{
+			REQUIRE(globalQueue[i].senderID == 1);
+			REQUIRE(globalQueue[i].receiverID == 2);
+			events.push_back(globalQueue[i].type);
+			eventPositions.push_back(component->position.x);
+		}
+	}
+	// one begin while inside the volume, one end once out, and the body was never pushed back
+	REQUIRE(events.size() == 2);
+	REQUIRE(events[0] == MessageType::OverlapBegin);
+	REQUIRE(std::abs(eventPositions[0] - 9.f) < 0.01f);
+	REQUIRE(events[1] == MessageType::OverlapEnd);
+	REQUIRE(std::abs(eventPositions[1] - 13.f) < 0.01f);
+	REQUIRE(component->velocity.x == 20.f);
+	REQUIRE(physicsSystem.GetCollisionStats().pairsSensor > 0);
+	REQUIRE(physicsSystem.GetCollisionStats().pairsFullSAT == 0);
+}
+
+TEST_CASE("PhysicsSystem Test - overlapping sensors both get the messages")
+{
+	// static trigger volume around x = 10, a moving sensor flying through it
+	std::vector<glm::vec3> triggerPoints;
+	std::vector<glm::vec3> probePoints;
+	for (int i = 0; i < 8; i++)
+	{
+		triggerPoints.push_back(glm::vec3(i & 1 ? 11.f : 9.f, i & 2 ? 4.f : 0.f, i & 4 ? 14.f : 6.f));
+		probePoints.push_back(glm::vec3(i & 1 ? 5.2f : 4.8f, i & 2 ? 2.2f : 1.8f, i & 4 ? 10.2f : 9.8f));
+	}
+
+	glm::quat orientation(1.f, 0.f, 0.f, 0.f);
+	PhysicsSystem physicsSystem(200.f, 10.f);
+	std::shared_ptr<Collider> trigger = ColliderBuilder::Build(1, DynamicType::Static, triggerPoints);
+	trigger->isSensor = true;
+	std::shared_ptr<Collider> probe = ColliderBuilder::Build(2, DynamicType::Dynamic, probePoints);
+	probe->isSensor = true;
+
+	std::unique_ptr<PhysicsComponent> triggerComponent = std::make_unique<PhysicsComponent>(1000.f, trigger->center, orientation, glm::mat3(1.f), DynamicType::Static);
+	triggerComponent->colliders.push_back(trigger);
+	std::unique_ptr<Entity> triggerEntity = std::make_unique<Entity>(1);
+	triggerEntity->AddComponent(std::move(triggerComponent));
+	triggerEntity->AddComponent(std::make_unique<TransformComponent>(trigger->center, orientation));
+
+	std::unique_ptr<PhysicsComponent> probeComponent = std::make_unique<PhysicsComponent>(1.f, probe->center, orientation, glm::mat3(1.f), DynamicType::WithPhysics);
+	probeComponent->velocity = glm::vec3(20.f, 0.f, 0.f);
+	probeComponent->colliders.push_back(probe);
+	std::unique_ptr<Entity> probeEntity = std::make_unique<Entity>(2);
+	probeEntity->AddComponent(std::move(probeComponent));
+	probeEntity->AddComponent(std::make_unique<TransformComponent>(probe->center, orientation));
+
+	std::vector<std::shared_ptr<Collider>> colliders{trigger, probe};
+	physicsSystem.Insert(colliders);
+	std::vector<std::unique_ptr<Entity>> entities;
+	entities.push_back(std::move(triggerEntity));
+	entities.push_back(std::move(probeEntity));
+	std::vector<Message> messages;
+
+	int begins[3] = {0, 0, 0};
+	int ends[3] = {0, 0, 0};
+	for (int step = 0; step < 6; step++)
+	{
+		std::vector<Message> globalQueue;
+		physicsSystem.Update(0.1f, entities, messages, globalQueue);
+		for (int i = 0; i < globalQueue.size(); i++)
+		{
+			std::shared_ptr<OverlapData> data = std::static_pointer_cast<OverlapData>(globalQueue[i].data);
+			REQUIRE(data->sensorID == globalQueue[i].senderID);
+			REQUIRE(data->otherID == globalQueue[i].receiverID);
+			REQUIRE(globalQueue[i].senderID != globalQueue[i].receiverID);
+			if (globalQueue[i].type == MessageType::OverlapBegin)
+				begins[globalQueue[i].senderID]++;
+			else if (globalQueue[i].type == MessageType::OverlapEnd)
+				ends[globalQueue[i].senderID]++;
+		}
+	}
+	// one begin and one end sent by each sensor
+	REQUIRE(begins[1] == 1);
+	REQUIRE(begins[2] == 1);
+	REQUIRE(ends[1] == 1);
+	REQUIRE(ends[2] == 1);
+}
@@ -0,0 +1,75 @@
+#include "catch.hpp"
+#include "../src/Systems/Physics/PhysicsWorld.hpp"
+#include "../src/Systems/Physics/ColliderBuilder.hpp"
+
+TEST_CASE("Physics world")
+{
+	PhysicsWorld world(100.f, 10.f);
+	int ground = world.AddBody(ColliderBuilder::BuildBox(0, DynamicType::Static, glm::vec3(10.f, 0.f, 10.f), glm::vec3(30.f, 1.f, 30.f)), 1.f, glm::mat3(1.f), DynamicType::Static);
+	int box = world.AddBody(ColliderBuilder::BuildBox(0, DynamicType::Dynamic, glm::vec3(19.5f, 1.1f, 19.5f), glm::vec3(20.5f, 2.1f, 20.5f)), 1.f, glm::mat3(1.f), DynamicType::WithPhysics);
+	world.GetBody(box)->velocity = glm::vec3(0.f, -3.f, 0.f);
+
+	SECTION("Bodies")
+	{
+		REQUIRE(ground != box);
+		REQUIRE(world.GetBodyCount() == 2);
+		REQUIRE(world.GetBody(box)->colliders[0]->entityID == box);
+		REQUIRE(world.GetBody(ground)->inverseMass == 0.f);
+		REQUIRE(world.GetBody(box + 1) == nullptr);
+	}
+
+	SECTION("Step")
+	{
+		for (int i = 0; i < 10; i++)
+			world.Step(1.f / 60.f);
+		// the box landed and bounced, the ground did not move
+		REQUIRE(world.GetBody(box)->velocity.y > 0.f);
+		REQUIRE(world.GetBody(box)->position.y > 1.f);
+		REQUIRE(world.GetBody(ground)->position == glm::vec3(20.f, 0.5f, 20.f));
+		REQUIRE(world.GetSystem().GetCollisionStats().pairsTested > 0);
+	}
+
+	SECTION("Debug draw callback")
+	{
+		int lines = 0;
+		int points = 0;
+		world.Step(1.f / 60.f);
+		REQUIRE(lines == 0);
+
+		PhysicsDebugDraw debugDraw;
+		debugDraw.line = [&lines](glm::vec3 from, glm::vec3 to, glm::vec3 color) { lines++; };
+		world.SetDebugDraw(debugDraw);
+		world.Step(1.f / 60.f);
+		// 12 edges for each box
+		REQUIRE(lines >= 24);
+
+		debugDraw.point = [&points](glm::vec3 point, glm::vec3 color) { points++; };
+		world.SetDebugDraw(debugDraw);
+		for (int i = 0; i < 10; i++)
+			world.Step(1.f / 60.f);
+		REQUIRE(points > 0);
+
+		world.SetDebugDraw(PhysicsDebugDraw());
+		lines = 0;
+		world.Step(1.f / 60.f);
+		REQUIRE(lines == 0);
+	}
+}
+
+TEST_CASE("Physics world terrain")
+{
+	PhysicsWorld world(100.f, 10.f);
+	std::vector<float> heights(25, 0.f);
+	int terrain = world.AddHeightfield(std::make_shared<Heightfield>(0, glm::vec3(50.f, 0.f, 50.f), 5, 5, 1.f, heights));
+	int box = world.AddBody(ColliderBuilder::BuildBox(0, DynamicType::Dynamic, glm::vec3(51.5f, 0.1f, 51.5f), glm::vec3(52.5f, 1.1f, 52.5f)), 1.f, glm::mat3(1.f), DynamicType::WithPhysics);
+	world.GetBody(box)->velocity = glm::vec3(0.f, -3.f, 0.f);
+
+	for (int i = 0; i < 10; i++)
+		world.Step(1.f / 60.f);
+	REQUIRE(world.GetBody(terrain) != nullptr);
+	REQUIRE(world.GetBody(terrain)->dynamicType == DynamicType::Static);
+	// the terrain stopped the box
+	REQUIRE(world.GetBody(box)->velocity.y > -0.1f);
+	REQUIRE(world.GetBody(box)->position.y > 0.45f);
+	REQUIRE(world.GetSystem().GetCollisionStats().pairsHeightfield > 0);
+}
@@ -0,0 +1,86 @@
+#include "catch.hpp"
+#include "../src/Systems/Physics/PhysicsWorldBatch.hpp"
+#include "../src/Systems/Physics/ColliderBuilder.hpp"
+#include "../src/Systems/Messaging/MoveData.hpp"
+
+static void FillBatch(PhysicsWorldBatch& batch, std::shared_ptr<const Hull> ground, std::shared_ptr<const Hull> box)
+{
+	for (int w = 0; w < batch.GetWorldCount(); w++)
+	{
+		PhysicsWorld& world = batch.GetWorld(w);
+		glm::quat orientation = glm::angleAxis(0.1f * w, glm::vec3(0.f, 1.f, 0.f));
+		world.AddBody(ground, 1.f, glm::mat3(1.f), DynamicType::Static, glm::vec3(20.f, 0.5f, 20.f), glm::quat(1.f, 0.f, 0.f, 0.f));
+		int id = world.AddBody(box, 1.f, glm::mat3(1.f), DynamicType::WithPhysics, glm::vec3(20.f, 1.6f + 0.01f * w, 20.f), orientation);
+		world.GetBody(id)->velocity = glm::vec3(0.1f * (w % 5), -3.f, 0.f);
+		// every third world gets a second box
+		if (w % 3 == 0)
+			world.AddBody(box, 1.f, glm::mat3(1.f), DynamicType::WithPhysics, glm::vec3(23.f, 1.6f, 20.f), orientation);
+	}
+}
+
+TEST_CASE("Physics world batch")
+{
+	std::shared_ptr<const Hull> ground = ColliderBuilder::BuildBox(0, DynamicType::Static, glm::vec3(10.f, 0.f, 10.f), glm::vec3(30.f, 1.f, 30.f))->GetHull();
+	std::shared_ptr<const Hull> box = ColliderBuilder::BuildBox(0, DynamicType::Dynamic, glm::vec3(0.f), glm::vec3(1.f))->GetHull();
+
+	PhysicsWorldBatch batch(40, 100.f, 10.f, 4);
+	PhysicsWorldBatch serial(40, 100.f, 10.f, 1);
+	FillBatch(batch, ground, box);
+	FillBatch(serial, ground, box);
+	// the hulls are shared, not copied per world
+	REQUIRE(box.use_count() > 80);
+
+	batch.Step(1.f / 60.f, 20);
+	for (int i = 0; i < 20; i++)
+		serial.Step(1.f / 60.f);
+
+	const PhysicsSnapshot& snapshot = batch.GetSnapshot();
+	REQUIRE(snapshot.worldOffsets.size() == 41);
+	REQUIRE(snapshot.worldOffsets[1] == 3);
+	REQUIRE(snapshot.worldOffsets[2] == 5);
+	REQUIRE(snapshot.worldOffsets[40] == 94);
+	REQUIRE(snapshot.ids.size() == 94);
+
+	SECTION("Matches serial stepping")
+	{
+		const PhysicsSnapshot& reference = serial.GetSnapshot();
+		REQUIRE(reference.ids == snapshot.ids);
+		for (int field = 0; field < PhysicsSnapshot::FieldCount; field++)
+			REQUIRE(reference.fields[field] == snapshot.fields[field]);
+	}
+
+	SECTION("Snapshot holds the body state")
+	{
+		for (int w = 0; w < batch.GetWorldCount(); w++)
+		{
+			PhysicsComponent* component = batch.GetWorld(w).GetBody(2);
+			int slot = snapshot.worldOffsets[w] + 1;
+			REQUIRE(snapshot.ids[slot] == 2);
+			REQUIRE(snapshot.fields[PhysicsSnapshot::PositionY][slot] == component->position.y);
+			REQUIRE(snapshot.fields[PhysicsSnapshot::VelocityX][slot] == component->velocity.x);
+			REQUIRE(snapshot.fields[PhysicsSnapshot::OrientationW][slot] == component->orientation.w);
+			// every box landed on its ground
+			REQUIRE(component->position.y > 1.f);
+		}
+	}
+
+	SECTION("Messages go to their world only")
+	{
+		std::vector<std::vector<Message>> messages(batch.GetWorldCount());
+		Message message(2, 0, MessageType::Move);
+		message.data = std::make_shared<MoveData>(true, false, false, false);
+		messages[3].push_back(message);
+		batch.Step(1.f / 60.f, messages);
+		serial.Step(1.f / 60.f);
+
+		const PhysicsSnapshot& reference = serial.GetSnapshot();
+		for (int w = 0; w < batch.GetWorldCount(); w++)
+		{
+			int slot = snapshot.worldOffsets[w] + 1;
+			if (w == 3)
+				REQUIRE(reference.fields[PhysicsSnapshot::VelocityZ][slot] != snapshot.fields[PhysicsSnapshot::VelocityZ][slot]);
+			else
+				REQUIRE(reference.fields[PhysicsSnapshot::VelocityZ][slot] == snapshot.fields[PhysicsSnapshot::VelocityZ][slot]);
+		}
+	}
+}
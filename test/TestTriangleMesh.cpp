@@ -0,0 +1,278 @@
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "catch.hpp"
+#include "../src/Systems/Physics/Grid.hpp"
+#include "../src/Systems/Physics/TriangleMesh.hpp"
+#include "../src/Systems/Physics/ColliderBuilder.hpp"
+#include "../src/Systems/Physics/CollisionDetector.hpp"
+
+namespace
+{
+	float RandomFloat(unsigned int& seed)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		return (seed >> 8) / 16777216.f;
+	}
+
+	// plane intersection + inside test, independent of the BVH code
+	float IntersectTriangle(glm::vec3 origin, glm::vec3 direction, glm::vec3 a, glm::vec3 b, glm::vec3 c)
+	{
+		glm::vec3 normal = glm::cross(b - a, c - a);
+		float denominator = glm::dot(normal, direction);
+		if (std::abs(denominator) < 1e-8f)
+			return -1.f;
+		float t = glm::dot(normal, a - origin) / denominator;
+		glm::vec3 p = origin + direction * t;
+		if (glm::dot(glm::cross(b - a, p - a), normal) < 0.f ||
+			glm::dot(glm::cross(c - b, p - b), normal) < 0.f ||
+			glm::dot(glm::cross(a - c, p - c), normal) < 0.f)
+			return -1.f;
+		return t;
+	}
+}
+
+TEST_CASE("TriangleMesh Test - BVH")
+{
+	// soup of small random triangles in a 50 unit cube
+	unsigned int seed = 7;
+	std::vector<glm::vec3> vertices;
+	std::vector<int> indices;
+	for (int i = 0; i < 500; i++)
+	{
+		glm::vec3 center(50.f * RandomFloat(seed), 50.f * RandomFloat(seed), 50.f * RandomFloat(seed));
+		for (int k = 0; k < 3; k++)
+		{
+			vertices.push_back(center + glm::vec3(RandomFloat(seed), RandomFloat(seed), RandomFloat(seed)) * 3.f);
+			indices.push_back(vertices.size() - 1);
+		}
+	}
+	TriangleMesh mesh(1, vertices, indices);
+	REQUIRE(mesh.GetTriangleCount() == 500);
+
+	const std::vector<BVHNode>& nodes = mesh.GetNodes();
+	REQUIRE(nodes.size() > 1);
+	int leafTriangles = 0;
+	for (int i = 0; i < nodes.size(); i++)
+	{
+		REQUIRE(nodes[i].count <= TriangleMesh::maxLeafSize);
+		leafTriangles += nodes[i].count;
+	}
+	REQUIRE(leafTriangles == 500);
+
+	SECTION("bounds queries match brute force")
+	{
+		for (int query = 0; query < 50; query++)
+		{
+			glm::vec3 min(50.f * RandomFloat(seed), 50.f * RandomFloat(seed), 50.f * RandomFloat(seed));
+			glm::vec3 max = min + glm::vec3(8.f * RandomFloat(seed), 8.f * RandomFloat(seed), 8.f * RandomFloat(seed));
+			std::vector<int> triangles;
+			mesh.Query(min, max, triangles);
+			std::sort(triangles.begin(), triangles.end());
+
+			std::vector<int> expected;
+			for (int i = 0; i < mesh.GetTriangleCount(); i++)
+			{
+				glm::vec3 a, b, c;
+				mesh.GetTriangle(i, a, b, c);
+				if (glm::all(glm::lessThanEqual(min, glm::max(a, glm::max(b, c)))) && glm::all(glm::lessThanEqual(glm::min(a, glm::min(b, c)), max)))
+					expected.push_back(i);
+			}
+			REQUIRE(triangles == expected);
+		}
+	}
+
+	SECTION("raycasts match brute force")
+	{
+		for (int ray = 0; ray < 100; ray++)
+		{
+			glm::vec3 origin(50.f * RandomFloat(seed), 50.f * RandomFloat(seed), -10.f);
+			glm::vec3 direction = glm::normalize(glm::vec3(RandomFloat(seed) - 0.5f, RandomFloat(seed) - 0.5f, 1.f));
+			float expected = 100.f;
+			for (int i = 0; i < mesh.GetTriangleCount(); i++)
+			{
+				glm::vec3 a, b, c;
+				mesh.GetTriangle(i, a, b, c);
+				float t = IntersectTriangle(origin, direction, a, b, c);
+				if (t >= 0.f && t < expected)
+					expected = t;
+			}
+			float distance;
+			glm::vec3 normal;
+			bool isHit = mesh.Raycast(origin, direction, 100.f, distance, normal);
+			REQUIRE(isHit == (expected < 100.f));
+			if (isHit)
+			{
+				REQUIRE(std::abs(distance - expected) < 0.001f);
+				REQUIRE(glm::dot(normal, direction) <= 0.f);
+			}
+		}
+	}
+}
+
+TEST_CASE("TriangleMesh Test - deep BVH")
+{
+	// squares of x halving at every triangle, binned SAH peels them off one level at a time
+	std::vector<glm::vec3> vertices;
+	std::vector<int> indices;
+	for (int i = 0; i < 100; i++)
+	{
+		float x = std::ldexp(1.f, -i);
+		vertices.push_back(glm::vec3(x, 0.f, 0.f));
+		vertices.push_back(glm::vec3(x, 1.f, 0.f));
+		vertices.push_back(glm::vec3(x, 0.f, 1.f));
+		for (int k = 3; k > 0; k--)
+			indices.push_back(vertices.size() - k);
+	}
+	TriangleMesh mesh(1, vertices, indices);
+
+	// left child right after its parent, right child at offset
+	const std::vector<BVHNode>& nodes = mesh.GetNodes();
+	std::vector<std::pair<int, int>> stack{std::make_pair(0, 0)};
+	int depth = 0;
+	int leafTriangles = 0;
+	while (!stack.empty())
+	{
+		std::pair<int, int> node = stack.back();
+		stack.pop_back();
+		depth = std::max(depth, node.second);
+		leafTriangles += nodes[node.first].count;
+		if (nodes[node.first].count > 0)
+			continue;
+		stack.push_back(std::make_pair(node.first + 1, node.second + 1));
+		stack.push_back(std::make_pair(nodes[node.first].offset, node.second + 1));
+	}
+	REQUIRE(depth == TriangleMesh::maxDepth);
+	REQUIRE(leafTriangles == 100);
+
+	// the smallest square sits in the capped leaf
+	float smallest = std::ldexp(1.f, -99);
+	std::vector<int> triangles;
+	mesh.Query(glm::vec3(0.f, 0.f, 0.f), glm::vec3(1.5f * smallest, 1.f, 1.f), triangles);
+	int hits = 0;
+	for (int i = 0; i < triangles.size(); i++)
+	{
+		glm::vec3 a, b, c;
+		mesh.GetTriangle(triangles[i], a, b, c);
+		hits += a.x == smallest;
+	}
+	REQUIRE(hits == 1);
+
+	float distance;
+	glm::vec3 normal;
+	REQUIRE(mesh.Raycast(glm::vec3(-1.f, 0.25f, 0.25f), glm::vec3(1.f, 0.f, 0.f), 10.f, distance, normal));
+	REQUIRE(distance == Approx(1.f));
+	REQUIRE(normal.x < 0.f);
+}
+
+TEST_CASE("TriangleMesh Test - collisions")
+{
+	// V shaped valley along z, the walls rise at 45 degrees from the line x = 0, y = 0
+	std::vector<float> vertices{	-10.f, 10.f, -10.f,		-10.f, 10.f, 10.f,
+									0.f, 0.f, -10.f,		0.f, 0.f, 10.f,
+									10.f, 10.f, -10.f,		10.f, 10.f, 10.f};
+	// vertex / normal pairs like a Geometry with stride 2
+	std::vector<int> indices{	0, 0, 2, 0, 1, 0,		1, 0, 2, 0, 3, 0,
+								2, 0, 4, 0, 3, 0,		3, 0, 4, 0, 5, 0};
+	std::shared_ptr<TriangleMesh> mesh = ColliderBuilder::BuildTriangleMesh(4, vertices, indices, 2);
+	REQUIRE(mesh != nullptr);
+	REQUIRE(mesh->GetTriangleCount() == 4);
+	REQUIRE(mesh->GetCollider()->entityID == 4);
+
+	SECTION("box wedged in the valley touches both walls")
+	{
+		std::vector<glm::vec3> boxPoints;
+		for (int i = 0; i < 8; i++)
+			boxPoints.push_back(glm::vec3(i & 1 ? 1.f : -1.f, i & 2 ? 2.5f : 0.5f, i & 4 ? 1.f : -1.f));
+		std::shared_ptr<Collider> box = ColliderBuilder::Build(1, DynamicType::Dynamic, boxPoints);
+
+		CollisionDetector detector;
+		ContactArena arena;
+		const Collision* collision = detector.CollideMesh(box, *mesh, arena);
+		REQUIRE(collision != nullptr);
+		REQUIRE(collision->second == 4);
+		bool isLeftWall = false;
+		bool isRightWall = false;
+		for (int i = 0; i < collision->contactCount; i++)
+		{
+			glm::vec3 normal = arena.GetContacts(*collision)[i].contactNormal;
+			REQUIRE(normal.y > 0.f);
+			REQUIRE(arena.GetContacts(*collision)[i].penetration > 0.f);
+			isLeftWall = isLeftWall || normal.x > 0.5f;
+			isRightWall = isRightWall || normal.x < -0.5f;
+		}
+		REQUIRE(isLeftWall);
+		REQUIRE(isRightWall);
+		REQUIRE(detector.GetStats().pairsMesh == 1);
+
+		// lifted out of the valley
+		box->Update(box->center + glm::vec3(0.f, 2.f, 0.f), glm::quat(1.f, 0.f, 0.f, 0.f));
+		REQUIRE(detector.CollideMesh(box, *mesh, arena) == nullptr);
+	}
+
+	SECTION("box resting on a flat floor gets the whole face")
+	{
+		// square of two triangles, the diagonal runs under the box
+		std::vector<float> floorVertices{	-5.f, 0.f, -5.f,	5.f, 0.f, -5.f,		-5.f, 0.f, 5.f,		5.f, 0.f, 5.f};
+		std::vector<int> floorIndices{	0, 0, 2, 0, 1, 0,		1, 0, 2, 0, 3, 0};
+		std::shared_ptr<TriangleMesh> floor = ColliderBuilder::BuildTriangleMesh(5, floorVertices, floorIndices, 2);
+		std::shared_ptr<Collider> box = ColliderBuilder::BuildBox(1, DynamicType::Dynamic, glm::vec3(-1.f, -0.1f, -1.f), glm::vec3(1.f, 1.9f, 1.f));
+
+		CollisionDetector detector;
+		ContactArena arena;
+		const Collision* collision = detector.CollideMesh(box, *floor, arena);
+		REQUIRE(collision != nullptr);
+		REQUIRE(collision->contactCount >= 4);
+		glm::vec3 minPoint(10.f);
+		glm::vec3 maxPoint(-10.f);
+		for (int i = 0; i < collision->contactCount; i++)
+		{
+			const Contact& contact = arena.GetContacts(*collision)[i];
+			REQUIRE(glm::all(glm::epsilonEqual(contact.contactNormal, glm::vec3(0.f, 1.f, 0.f), 0.001f)));
+			REQUIRE(contact.penetration == Approx(0.1f));
+			minPoint = glm::min(minPoint, contact.contactPoint);
+			maxPoint = glm::max(maxPoint, contact.contactPoint);
+		}
+		// the contacts span the bottom face, so the box cannot rock about a single point
+		REQUIRE(glm::all(glm::epsilonEqual(minPoint, glm::vec3(-1.f, -0.1f, -1.f), 0.001f)));
+		REQUIRE(glm::all(glm::epsilonEqual(maxPoint, glm::vec3(1.f, -0.1f, 1.f), 0.001f)));
+	}
+
+	SECTION("grid collisions and raycasts")
+	{
+		Grid grid(200.f, 5.f);
+		// the grid starts at the origin, move the valley inside it
+		std::vector<float> shifted = vertices;
+		for (int i = 0; i < shifted.size(); i += 3)
+		{
+			shifted[i] += 50.f;
+			shifted[i + 2] += 50.f;
+		}
+		std::shared_ptr<TriangleMesh> placed = ColliderBuilder::BuildTriangleMesh(4, shifted, indices, 2);
+		grid.Insert(placed);
+
+		std::vector<glm::vec3> boxPoints;
+		for (int i = 0; i < 8; i++)
+			boxPoints.push_back(glm::vec3(i & 1 ? 51.f : 49.f, i & 2 ? 2.5f : 0.5f, i & 4 ? 51.f : 49.f));
+		std::shared_ptr<Collider> box = ColliderBuilder::Build(1, DynamicType::Dynamic, boxPoints);
+		grid.Insert(box);
+		REQUIRE(grid.CheckCollisions().size() == 1);
+
+		// straight down onto the right wall at x = 53, the surface is at y = 3
+		std::vector<QueryHit> hits;
+		REQUIRE(grid.Raycast(glm::vec3(53.f, 20.f, 45.f), glm::vec3(0.f, -1.f, 0.f), 50.f, hits) == 1);
+		REQUIRE(hits[0].entityID == 4);
+		REQUIRE(std::abs(hits[0].distance - 17.f) < 0.001f);
+		REQUIRE(glm::all(glm::epsilonEqual(glm::normalize(glm::vec3(-1.f, 1.f, 0.f)), hits[0].normal, 0.001f)));
+
+		// a small box dropped through the right wall in one step, its lower corner at x = 53.25 meets
+		// the wall at y = 3.25 once the center is down at 3.5, 16.5 units out of 30
+		glm::quat identity(1.f, 0.f, 0.f, 0.f);
+		std::shared_ptr<Collider> bullet = ColliderBuilder::BuildBox(2, DynamicType::Dynamic, glm::vec3(52.75f, 19.75f, 44.75f), glm::vec3(53.25f, 20.25f, 45.25f));
+		bullet->Attach(bullet->center, identity);
+		float toi = grid.Sweep(bullet, glm::vec3(53.f, 20.f, 45.f), identity, glm::vec3(53.f, -10.f, 45.f), identity);
+		REQUIRE(std::abs(toi - 0.55f) < 0.01f);
+		// along the valley above the walls
+		REQUIRE(grid.Sweep(bullet, glm::vec3(50.f, 15.f, 42.f), identity, glm::vec3(50.f, 15.f, 58.f), identity) == 1.f);
+	}
+}
@@ -0,0 +1,342 @@
+#include <new>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "../src/Systems/Physics/PhysicsSystem.hpp"
+#include "../src/Systems/Physics/ColliderBuilder.hpp"
+#include "../src/Components/TransformComponent.hpp"
+
+/*
+Physics benchmarks on generated scenes. Every stage is timed on its own and reported as time per operation,
+operations per second and heap allocations per frame.
+
+    benchmark [--frames N] [--scale S] [--scene name]
+
+Scenes: stack (a box tower), pile (random overlapping boxes), crowd (every box in a single grid cell),
+sparse (boxes scattered over a large world, few contacts).
+*/
+
+// every heap allocation of the process is counted
+static std::atomic<std::uint64_t> allocations(0);
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* pointer = std::malloc(size ? size : 1);
+    if (pointer == nullptr)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+struct Scene
+{
+    std::string                             name;
+    std::unique_ptr<PhysicsSystem>          physicsSystem;
+    std::vector<std::unique_ptr<Entity>>    entities;
+    // the points every collider was built from, used to time the builder
+    std::vector<std::vector<glm::vec3>>     sources;
+};
+
+struct Stage
+{
+    const char*     name;
+    const char*     unit;
+    double          seconds = 0.0;
+    std::uint64_t   operations = 0;
+    std::uint64_t   allocations = 0;
+};
+
+static std::vector<glm::vec3> BoxPoints(glm::vec3 center, glm::vec3 halfExtents, glm::quat orientation)
+{
+    std::vector<glm::vec3> points;
+    for (int i = 0; i < 8; i++)
+    {
+        glm::vec3 corner(i & 1 ? halfExtents.x : -halfExtents.x, i & 2 ? halfExtents.y : -halfExtents.y, i & 4 ? halfExtents.z : -halfExtents.z);
+        points.push_back(center + orientation * corner);
+    }
+    return points;
+}
+
+static void AddBox(Scene& scene, std::vector<glm::vec3> points, DynamicType type, glm::vec3 velocity)
+{
+    int id = scene.entities.size() + 1;
+    glm::quat orientation(1.f, 0.f, 0.f, 0.f);
+    std::shared_ptr<Collider> collider = ColliderBuilder::Build(id, type == DynamicType::Static ? DynamicType::Static : DynamicType::Dynamic, points);
+    std::unique_ptr<PhysicsComponent> component = std::make_unique<PhysicsComponent>(1.f, collider->center, orientation, glm::mat3(1.f), type);
+    component->velocity = velocity;
+    component->colliders.push_back(collider);
+    collider->Attach(collider->center, orientation);
+    scene.physicsSystem->Insert(component->colliders);
+
+    std::unique_ptr<Entity> entity = std::make_unique<Entity>(id);
+    entity->AddComponent(std::move(component));
+    entity->AddComponent(std::make_unique<TransformComponent>(collider->center, orientation));
+    scene.entities.push_back(std::move(entity));
+    scene.sources.push_back(points);
+}
+
+static glm::quat RandomOrientation(std::mt19937& random)
+{
+    std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+    glm::quat orientation = glm::angleAxis(angle(random), glm::vec3(0.f, 1.f, 0.f));
+    return orientation * glm::angleAxis(angle(random) * 0.1f, glm::vec3(1.f, 0.f, 0.f));
+}
+
+/** a tower of unit boxes, each one sinking slightly into the one below */
+static Scene GenerateStack(int count)
+{
+    Scene scene;
+    scene.name = "stack";
+    scene.physicsSystem = std::make_unique<PhysicsSystem>(200.f, 10.f);
+    AddBox(scene, BoxPoints(glm::vec3(100.f, 0.5f, 100.f), glm::vec3(20.f, 0.5f, 20.f), glm::quat(1.f, 0.f, 0.f, 0.f)), DynamicType::Static, glm::vec3(0.f));
+    for (int i = 0; i < count; i++)
+        AddBox(scene, BoxPoints(glm::vec3(100.f, 1.49f + i * 0.99f, 100.f), glm::vec3(0.5f), glm::quat(1.f, 0.f, 0.f, 0.f)), DynamicType::WithPhysics, glm::vec3(0.f, -0.1f, 0.f));
+    return scene;
+}
+
+/** random boxes thrown together over a 30 x 30 area */
+static Scene GeneratePile(int count, std::mt19937& random)
+{
+    Scene scene;
+    scene.name = "pile";
+    scene.physicsSystem = std::make_unique<PhysicsSystem>(200.f, 10.f);
+    std::uniform_real_distribution<float> position(85.f, 115.f);
+    std::uniform_real_distribution<float> height(1.f, 8.f);
+    std::uniform_real_distribution<float> size(0.25f, 0.75f);
+    std::uniform_real_distribution<float> speed(-1.f, 1.f);
+    AddBox(scene, BoxPoints(glm::vec3(100.f, 0.5f, 100.f), glm::vec3(20.f, 0.5f, 20.f), glm::quat(1.f, 0.f, 0.f, 0.f)), DynamicType::Static, glm::vec3(0.f));
+    for (int i = 0; i < count; i++)
+    {
+        glm::vec3 center(position(random), height(random), position(random));
+        glm::vec3 halfExtents(size(random), size(random), size(random));
+        AddBox(scene, BoxPoints(center, halfExtents, RandomOrientation(random)), DynamicType::WithPhysics, glm::vec3(speed(random), -1.f, speed(random)));
+    }
+    return scene;
+}
+
+/** every box inside one grid cell, the worst case of the uniform grid */
+static Scene GenerateCrowd(int count, std::mt19937& random)
+{
+    Scene scene;
+    scene.name = "crowd";
+    scene.physicsSystem = std::make_unique<PhysicsSystem>(200.f, 10.f);
+    // cell (5, 5) spans [100, 120] on x and z
+    std::uniform_real_distribution<float> position(101.f, 119.f);
+    std::uniform_real_distribution<float> height(0.5f, 4.f);
+    std::uniform_real_distribution<float> speed(-1.f, 1.f);
+    for (int i = 0; i < count; i++)
+    {
+        glm::vec3 center(position(random), height(random), position(random));
+        AddBox(scene, BoxPoints(center, glm::vec3(0.4f), RandomOrientation(random)), DynamicType::WithPhysics, glm::vec3(speed(random), 0.f, speed(random)));
+    }
+    return scene;
+}
+
+/** boxes scattered over a 2 km world, most cells hold one box or none */
+static Scene GenerateSparse(int count, std::mt19937& random)
+{
+    Scene scene;
+    scene.name = "sparse";
+    scene.physicsSystem = std::make_unique<PhysicsSystem>(2000.f, 10.f);
+    std::uniform_real_distribution<float> position(5.f, 1995.f);
+    std::uniform_real_distribution<float> speed(-2.f, 2.f);
+    for (int i = 0; i < count; i++)
+    {
+        glm::vec3 center(position(random), 1.f, position(random));
+        DynamicType type = i % 4 == 0 ? DynamicType::Static : DynamicType::WithPhysics;
+        glm::vec3 velocity = type == DynamicType::Static ? glm::vec3(0.f) : glm::vec3(speed(random), 0.f, speed(random));
+        AddBox(scene, BoxPoints(center, glm::vec3(0.5f), RandomOrientation(random)), type, velocity);
+    }
+    return scene;
+}
+
+static double Seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void Report(const Scene& scene, int frames, const std::vector<Stage>& stages, const CollisionStats& narrowphase)
+{
+    std::printf("%s - %d bodies, %d frames\n", scene.name.c_str(), (int)scene.entities.size(), frames);
+    std::printf("  %-16s %12s %14s %12s %14s\n", "stage", "ns/op", "ops/s", "ops/frame", "allocs/frame");
+    for (int i = 0; i < stages.size(); i++)
+    {
+        const Stage& stage = stages[i];
+        double perOperation = stage.operations > 0 ? stage.seconds * 1e9 / stage.operations : 0.0;
+        double perSecond = stage.seconds > 0.0 ? stage.operations / stage.seconds : 0.0;
+        std::printf("  %-16s %12.1f %14.0f %12.1f %14.1f   (op = %s)\n",
+                    stage.name,
+                    perOperation,
+                    perSecond,
+                    (double)stage.operations / frames,
+                    (double)stage.allocations / frames,
+                    stage.unit);
+    }
+    // which path the Collide stage took, every pair goes through exactly one of them
+    std::printf("  narrowphase per frame - box %.1f, full SAT %.1f, GJK %.1f, rejected early %.1f\n",
+                (double)narrowphase.pairsBox / frames,
+                (double)narrowphase.pairsFullSAT / frames,
+                (double)narrowphase.pairsGJK / frames,
+                (double)narrowphase.pairsRejectedEarly / frames);
+    std::printf("\n");
+}
+
+static void Run(Scene& scene, int frames)
+{
+    std::vector<Stage> stages(5);
+    stages[0].name = "Build";           stages[0].unit = "hull";
+    stages[1].name = "Collide";         stages[1].unit = "pair with overlapping bounds";
+    stages[2].name = "CheckCollisions"; stages[2].unit = "pair tested";
+    stages[3].name = "Solve";           stages[3].unit = "collision";
+    stages[4].name = "Update";          stages[4].unit = "body";
+
+    // builder, the whole scene once per frame
+    for (int frame = 0; frame < frames; frame++)
+    {
+        std::uint64_t allocationsBefore = allocations.load();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < scene.sources.size(); i++)
+            ColliderBuilder::Build(0, DynamicType::Dynamic, scene.sources[i]);
+        stages[0].seconds += Seconds(start);
+        stages[0].operations += scene.sources.size();
+        stages[0].allocations += allocations.load() - allocationsBefore;
+    }
+
+    std::vector<std::shared_ptr<Collider>> colliders;
+    std::unordered_map<int, int> idToIndexMap;
+    for (int i = 0; i < scene.entities.size(); i++)
+    {
+        PhysicsComponent* component = scene.entities[i]->GetComponent<PhysicsComponent>(ComponentType::Physics);
+        colliders.insert(colliders.end(), component->colliders.begin(), component->colliders.end());
+        idToIndexMap[scene.entities[i]->id] = i;
+    }
+
+    Grid& grid = scene.physicsSystem->GetGrid();
+    CollisionDetector detector;
+    ContactArena arena;
+    std::vector<Message> messages;
+    std::vector<Message> globalQueue;
+    std::vector<std::pair<int, int>> pairs;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        // narrowphase alone, on the pairs a perfect broadphase would return
+        pairs.clear();
+        for (int i = 0; i < colliders.size(); i++)
+        {
+            for (int j = i + 1; j < colliders.size(); j++)
+            {
+                if (colliders[i]->dynamicType == DynamicType::Static && colliders[j]->dynamicType == DynamicType::Static)
+                    continue;
+                if (glm::all(glm::lessThanEqual(colliders[i]->aabbMin, colliders[j]->aabbMax)) &&
+                    glm::all(glm::lessThanEqual(colliders[j]->aabbMin, colliders[i]->aabbMax)))
+                    pairs.push_back(std::make_pair(i, j));
+            }
+        }
+        std::uint64_t allocationsBefore = allocations.load();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        arena.Clear();
+        for (int i = 0; i < pairs.size(); i++)
+            detector.Collide(colliders[pairs[i].first], colliders[pairs[i].second], arena);
+        stages[1].seconds += Seconds(start);
+        stages[1].operations += pairs.size();
+        stages[1].allocations += allocations.load() - allocationsBefore;
+
+        // broadphase + narrowphase
+        std::uint64_t pairsBefore = grid.GetCollisionStats().pairsTested;
+        allocationsBefore = allocations.load();
+        start = std::chrono::steady_clock::now();
+        const std::vector<Collision>& collisions = grid.CheckCollisions();
+        stages[2].seconds += Seconds(start);
+        stages[2].operations += grid.GetCollisionStats().pairsTested - pairsBefore;
+        stages[2].allocations += allocations.load() - allocationsBefore;
+
+        allocationsBefore = allocations.load();
+        start = std::chrono::steady_clock::now();
+        scene.physicsSystem->Solve(scene.entities, grid.GetContactArena(), idToIndexMap);
+        stages[3].seconds += Seconds(start);
+        stages[3].operations += collisions.size();
+        stages[3].allocations += allocations.load() - allocationsBefore;
+
+        // the full step, moves the scene on for the next frame
+        allocationsBefore = allocations.load();
+        start = std::chrono::steady_clock::now();
+        scene.physicsSystem->Update(1.f / 60.f, scene.entities, messages, globalQueue);
+        stages[4].seconds += Seconds(start);
+        stages[4].operations += scene.entities.size();
+        stages[4].allocations += allocations.load() - allocationsBefore;
+        globalQueue.clear();
+    }
+    Report(scene, frames, stages, detector.GetStats());
+}
+
+int main(int argc, char *argv[])
+{
+    int frames = 20;
+    float scale = 1.f;
+    std::string only;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--frames") == 0)
+            frames = std::max(1, std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--scale") == 0)
+            scale = std::max(0.01f, (float)std::atof(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--scene") == 0)
+            only = argv[i + 1];
+    }
+
+    std::mt19937 random(1234);
+    if (only.empty() || only == "stack")
+    {
+        Scene scene = GenerateStack((int)(50 * scale));
+        Run(scene, frames);
+    }
+    if (only.empty() || only == "pile")
+    {
+        Scene scene = GeneratePile((int)(1000 * scale), random);
+        Run(scene, frames);
+    }
+    if (only.empty() || only == "crowd")
+    {
+        Scene scene = GenerateCrowd((int)(300 * scale), random);
+        Run(scene, frames);
+    }
+    if (only.empty() || only == "sparse")
+    {
+        Scene scene = GenerateSparse((int)(5000 * scale), random);
+        Run(scene, frames);
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#include "../src/Systems/Physics/PhysicsRecording.hpp"
+
+/*
+Headless physics replay. Steps a recording made with `game --record <file>` and reports the time spent in
+every PhysicsSystem::Update and the state hashes. Exits with 1 if the states differ from the recording.
+
+    replay <recording> [--ticks]
+*/
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "usage: %s <recording> [--ticks]\n", argv[0]);
+        return 2;
+    }
+    bool printTicks = argc > 2 && std::strcmp(argv[2], "--ticks") == 0;
+
+    PhysicsReplay replay;
+    if (!replay.Load(argv[1]))
+    {
+        std::fprintf(stderr, "cannot load recording %s\n", argv[1]);
+        return 2;
+    }
+
+    std::vector<double> times;
+    std::vector<std::uint64_t> hashes;
+    int firstMismatch = replay.Run(times, hashes);
+    if (times.empty())
+    {
+        std::printf("no ticks recorded\n");
+        return 0;
+    }
+
+    if (printTicks)
+    {
+        std::printf("tick,ms,hash\n");
+        for (int i = 0; i < times.size(); i++)
+            std::printf("%d,%.4f,%016llx\n", i, times[i] * 1000.0, (unsigned long long)hashes[i]);
+    }
+
+    std::vector<double> sorted = times;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (int i = 0; i < sorted.size(); i++)
+        total += sorted[i];
+    std::printf("ticks      %d\n", (int)times.size());
+    std::printf("total ms   %.3f\n", total * 1000.0);
+    std::printf("mean ms    %.4f\n", total * 1000.0 / times.size());
+    std::printf("median ms  %.4f\n", sorted[sorted.size() / 2] * 1000.0);
+    std::printf("p95 ms     %.4f\n", sorted[std::min(sorted.size() - 1, sorted.size() * 95 / 100)] * 1000.0);
+    std::printf("max ms     %.4f\n", sorted.back() * 1000.0);
+    std::printf("final hash %016llx\n", (unsigned long long)hashes.back());
+    if (firstMismatch >= 0)
+    {
+        std::printf("state differs from the recording from tick %d\n", firstMismatch);
+        return 1;
+    }
+    std::printf("states match the recording\n");
+    return 0;
+}